@@ -10,12 +10,247 @@
 
 #include "AdsrData.h"
 
+namespace
+{
+    // How close the exponential segments get to their level before they end: the curve
+    // aims this far past it, so it arrives in the set time instead of never
+    constexpr float overshoot { 0.0001f };
+    
+    constexpr int holdSamples { std::numeric_limits<int>::max() };
+}
+
+void AdsrData::prepare (const double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    updateSegments();
+    reset();
+}
+
 void AdsrData::update (const float attack, const float decay, const float sustain, const float release)
 {
-    adsrParams.attack = attack;
-    adsrParams.decay = decay;
-    adsrParams.sustain = sustain;
-    adsrParams.release = release;
+    // Called every block, so only changes pay for new coefficients
+    if (attack == attackTime && decay == decayTime && sustain == sustainLevel && release == releaseTime)
+        return;
+    
+    attackTime = attack;
+    decayTime = decay;
+    sustainLevel = sustain;
+    releaseTime = release;
+    updateSegments();
+    
+    // A segment in progress carries on from where it is, at the new rate
+    enterStage (stage);
+}
+
+void AdsrData::noteOn()
+{
+    enterStage (Stage::attack);
+}
+
+void AdsrData::noteOff()
+{
+    if (stage != Stage::idle)
+        enterStage (Stage::release);
+}
+
+void AdsrData::reset()
+{
+    enterStage (Stage::idle);
+}
+
+void AdsrData::process (float* dest, int numSamples)
+{
+    while (numSamples > 0)
+    {
+        const auto* segment = getSegment();
+        
+        if (segment == nullptr)
+        {
+            juce::FloatVectorOperations::fill (dest, value, numSamples);
+            return;
+        }
+        
+        const auto count = juce::jmin (numSamples, stageSamplesRemaining);
+        segment->render (value, dest, count);
+        dest += count;
+        numSamples -= count;
+        stageSamplesRemaining -= count;
+        
+        if (stageSamplesRemaining == 0)
+        {
+            dest[-1] = segment->end;
+            finishStage();
+        }
+    }
+}
+
+float AdsrData::advance (int numSamples)
+{
+    while (numSamples > 0)
+    {
+        const auto* segment = getSegment();
+        
+        if (segment == nullptr)
+            break;
+        
+        const auto count = juce::jmin (numSamples, stageSamplesRemaining);
+        value = segment->skip (value, count);
+        numSamples -= count;
+        stageSamplesRemaining -= count;
+        
+        if (stageSamplesRemaining == 0)
+            finishStage();
+    }
+    
+    return value;
+}
+
+void AdsrData::updateSegments()
+{
+    const auto toSamples = [this] (const float seconds) { return (double) seconds * sampleRate; };
+    
+    // Exponential approach to a target just past the level, reaching it after numSamples
+    const auto setExponential = [] (Segment& segment, const double numSamples, const float level, const float target)
+    {
+        if (numSamples < 1.0)
+        {
+            segment.set (0.0f, level, level);
+            return;
+        }
+        
+        const auto coefficient = std::exp (-std::log ((1.0 + overshoot) / overshoot) / numSamples);
+        segment.set ((float) coefficient, (float) (target * (1.0 - coefficient)), level);
+    };
+    
+    // Linear attack, as juce::ADSR had, so existing patches keep their onsets
+    const auto attackSamples = toSamples (attackTime);
+    
+    if (attackSamples < 1.0)
+        attackSegment.set (0.0f, 1.0f, 1.0f);
+    else
+        attackSegment.set (1.0f, (float) (1.0 / attackSamples), 1.0f);
+    
+    setExponential (decaySegment, toSamples (decayTime), sustainLevel, sustainLevel - overshoot * (1.0f - sustainLevel));
+    setExponential (releaseSegment, toSamples (releaseTime), 0.0f, -overshoot);
+}
+
+void AdsrData::enterStage (const Stage newStage)
+{
+    stage = newStage;
+    
+    if (stage == Stage::idle)
+        value = 0.0f;
+    else if (stage == Stage::sustain)
+        value = sustainLevel;
+    
+    const auto* segment = getSegment();
+    stageSamplesRemaining = segment != nullptr ? segment->getSamplesToEnd (value) : holdSamples;
+    
+    if (stageSamplesRemaining == 0)
+        finishStage();
+}
+
+void AdsrData::finishStage()
+{
+    if (const auto* segment = getSegment())
+        value = segment->end;
+    
+    switch (stage)
+    {
+        case Stage::attack:     enterStage (Stage::decay); break;
+        case Stage::decay:      enterStage (Stage::sustain); break;
+        case Stage::release:    enterStage (Stage::idle); break;
+        case Stage::sustain:
+        case Stage::idle:       break;
+    }
+}
+
+const AdsrData::Segment* AdsrData::getSegment() const
+{
+    switch (stage)
+    {
+        case Stage::attack:     return &attackSegment;
+        case Stage::decay:      return &decaySegment;
+        case Stage::release:    return &releaseSegment;
+        case Stage::sustain:
+        case Stage::idle:       break;
+    }
+    
+    return nullptr;
+}
+
+//==============================================================================
+void AdsrData::Segment::set (const float newCoefficient, const float newOffset, const float newEnd)
+{
+    coefficient = newCoefficient;
+    offset = newOffset;
+    end = newEnd;
+    
+    auto gain = 1.0f;
+    auto accumulated = 0.0f;
+    
+    for (int k = 0; k < chunkSize; ++k)
+    {
+        accumulated += offset * gain;
+        gain *= coefficient;
+        chunkGains[(size_t) k] = gain;
+        chunkOffsets[(size_t) k] = accumulated;
+    }
+}
+
+void AdsrData::Segment::render (float& value, float* dest, const int numSamples) const
+{
+    auto y = value;
+    int n = 0;
+    
+    // Each chunk only depends on the value before it, so its samples compute independently
+    for (; n + chunkSize <= numSamples; n += chunkSize)
+    {
+        for (int k = 0; k < chunkSize; ++k)
+            dest[n + k] = chunkGains[(size_t) k] * y + chunkOffsets[(size_t) k];
+        
+        y = dest[n + chunkSize - 1];
+    }
+    
+    for (; n < numSamples; ++n)
+    {
+        y = coefficient * y + offset;
+        dest[n] = y;
+    }
+    
+    value = y;
+}
+
+float AdsrData::Segment::skip (const float value, const int numSamples) const
+{
+    if (coefficient == 1.0f)
+        return value + offset * (float) numSamples;
+    
+    if (coefficient <= 0.0f)
+        return end;
+    
+    const auto target = offset / (1.0f - coefficient);
+    return target + (value - target) * std::pow (coefficient, (float) numSamples);
+}
+
+int AdsrData::Segment::getSamplesToEnd (const float value) const
+{
+    if (coefficient <= 0.0f)
+        return 0;
+    
+    if (coefficient == 1.0f)
+    {
+        const auto samples = (end - value) / offset;
+        return samples > 0.0f ? (int) std::ceil (samples) : 0;
+    }
+    
+    // The end lies between the value and the target, or the value is already past it
+    const auto target = offset / (1.0f - coefficient);
+    const auto from = value - target;
+    const auto to = end - target;
+    
+    if (from * to <= 0.0f || std::abs (to) >= std::abs (from))
+        return 0;
     
-    setParameters (adsrParams);
+    return juce::jmax (1, (int) std::ceil (std::log (to / from) / std::log (coefficient)));
 }
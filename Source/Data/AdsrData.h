@@ -12,11 +12,69 @@
 
 #include <JuceHeader.h>
 
-class AdsrData : public juce::ADSR
+// ADSR envelope computed a segment at a time rather than a sample at a time.
+//
+// Every segment is the recurrence y[n + 1] = coefficient * y[n] + offset: a
+// linear ramp for the attack, and exponential curves for decay and release.
+// The coefficients, and their closed forms over a whole SIMD-width chunk, are
+// worked out when the parameters change, so rendering is a branch-free
+// multiply-add over each run of samples between segment boundaries.
+class AdsrData
 {
 public:
+    void prepare (const double sampleRate);
     void update (const float attack, const float decay, const float sustain, const float release);
     
+    void noteOn();
+    void noteOff();
+    void reset();
+    bool isActive() const { return stage != Stage::idle; }
+    bool isReleasing() const { return stage == Stage::release; }
+    float getCurrentValue() const { return value; }
+    
+    // The next numSamples values of the envelope
+    void process (float* dest, const int numSamples);
+    
+    // Control rate: skips ahead numSamples in closed form and returns the value reached
+    float advance (const int numSamples);
+    
 private:
-    juce::ADSR::Parameters adsrParams;
+    enum class Stage { idle, attack, decay, sustain, release };
+    
+    static constexpr int chunkSize { 8 };
+    
+    struct Segment
+    {
+        void set (const float coefficient, const float offset, const float end);
+        void render (float& value, float* dest, const int numSamples) const;
+        float skip (const float value, const int numSamples) const;
+        int getSamplesToEnd (const float value) const;
+        
+        float coefficient { 1.0f };
+        float offset { 0.0f };
+        float end { 0.0f };
+        
+        // chunkGains[k] * y + chunkOffsets[k] is y advanced by k + 1 samples
+        std::array<float, chunkSize> chunkGains {};
+        std::array<float, chunkSize> chunkOffsets {};
+    };
+    
+    void updateSegments();
+    void enterStage (const Stage newStage);
+    void finishStage();
+    const Segment* getSegment() const;
+    
+    double sampleRate { 44100.0 };
+    float attackTime { 0.1f };
+    float decayTime { 0.1f };
+    float sustainLevel { 1.0f };
+    float releaseTime { 0.1f };
+    
+    Segment attackSegment;
+    Segment decaySegment;
+    Segment releaseSegment;
+    
+    Stage stage { Stage::idle };
+    float value { 0.0f };
+    int stageSamplesRemaining { 0 };
 };
@@ -0,0 +1,209 @@
+/*
+  ==============================================================================
+
+    AudioFeatures.cpp
+    Created: 18 Oct 2026 9:40:26pm
+
+  ==============================================================================
+*/
+
+#include "AudioFeatures.h"
+
+namespace
+{
+    float hzToMel (const float hz) { return 2595.0f * std::log10 (1.0f + hz / 700.0f); }
+    float melToHz (const float mel) { return 700.0f * (std::pow (10.0f, mel / 2595.0f) - 1.0f); }
+    
+    float sum (const float* data, const int num)
+    {
+        return std::accumulate (data, data + num, 0.0f);
+    }
+    
+    void meanAndStd (const std::vector<float>& values, float& mean, float& stdDev)
+    {
+        mean = 0.0f;
+        stdDev = 0.0f;
+        
+        if (values.empty())
+            return;
+        
+        mean = sum (values.data(), (int) values.size()) / (float) values.size();
+        
+        for (const auto v : values)
+            stdDev += (v - mean) * (v - mean);
+        
+        stdDev = std::sqrt (stdDev / (float) values.size());
+    }
+}
+
+AudioFeatureExtractor::AudioFeatureExtractor (const double sr)
+: sampleRate (sr)
+, tables (SharedResourceCache<Tables>::get ("AudioFeatureExtractor " + juce::String (sr), [sr] { return std::make_shared<const Tables> (sr); }))
+{
+    constexpr auto numBins = fftSize / 2 + 1;
+    
+    frame.resize ((size_t) fftSize * 2);
+    spectrum.resize (numBins);
+    previousSpectrum.resize (numBins);
+    weighted.resize (numBins);
+}
+
+AudioFeatureExtractor::Tables::Tables (const double sampleRate)
+{
+    constexpr auto numBins = fftSize / 2 + 1;
+    
+    window.resize (fftSize);
+    juce::dsp::WindowingFunction<float>::fillWindowingTables (window.data(), (size_t) fftSize,
+                                                              juce::dsp::WindowingFunction<float>::hann, false);
+    
+    binFrequencies.resize (numBins);
+    
+    for (int bin = 0; bin < numBins; ++bin)
+        binFrequencies[(size_t) bin] = (float) (bin * sampleRate / fftSize);
+    
+    // Triangular mel filters between 20 Hz and Nyquist
+    melWeights.assign ((size_t) (numMelBands * numBins), 0.0f);
+    const auto minMel = hzToMel (20.0f);
+    const auto maxMel = hzToMel ((float) sampleRate * 0.5f);
+    
+    for (int band = 0; band < numMelBands; ++band)
+    {
+        const auto lower = melToHz (minMel + (maxMel - minMel) * (float) band / (numMelBands + 1));
+        const auto centre = melToHz (minMel + (maxMel - minMel) * (float) (band + 1) / (numMelBands + 1));
+        const auto upper = melToHz (minMel + (maxMel - minMel) * (float) (band + 2) / (numMelBands + 1));
+        
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            const auto f = binFrequencies[(size_t) bin];
+            auto& weight = melWeights[(size_t) (band * numBins + bin)];
+            
+            if (f > lower && f <= centre)
+                weight = (f - lower) / (centre - lower);
+            else if (f > centre && f < upper)
+                weight = (upper - f) / (upper - centre);
+        }
+    }
+    
+    // DCT-II, orthonormal
+    dct.resize ((size_t) (numMfccs * numMelBands));
+    
+    for (int k = 0; k < numMfccs; ++k)
+    {
+        const auto scale = std::sqrt ((k == 0 ? 1.0f : 2.0f) / numMelBands);
+        
+        for (int n = 0; n < numMelBands; ++n)
+            dct[(size_t) (k * numMelBands + n)] = scale * std::cos (juce::MathConstants<float>::pi / numMelBands * ((float) n + 0.5f) * (float) k);
+    }
+}
+
+AudioFeatureExtractor::Vector AudioFeatureExtractor::process (const juce::AudioBuffer<float>& audio)
+{
+    constexpr auto numBins = fftSize / 2 + 1;
+    Vector features {};
+    
+    mixToMono (audio);
+    const auto numSamples = (int) mono.size();
+    
+    if (numSamples == 0)
+        return features;
+    
+    std::vector<float> centroids, fluxes, frameRms;
+    std::array<std::vector<float>, numMfccs> mfccs;
+    std::fill (previousSpectrum.begin(), previousSpectrum.end(), 0.0f);
+    
+    for (int start = 0; start < numSamples; start += hopSize)
+    {
+        const auto numInFrame = juce::jmin (fftSize, numSamples - start);
+        
+        juce::FloatVectorOperations::clear (frame.data(), (int) frame.size());
+        juce::FloatVectorOperations::multiply (frame.data(), mono.data() + start, tables->window.data(), numInFrame);
+        
+        const auto* input = mono.data() + start;
+        frameRms.push_back (std::sqrt (std::inner_product (input, input + numInFrame, input, 0.0f) / (float) numInFrame));
+        
+        fft.performFrequencyOnlyForwardTransform (frame.data(), true);
+        juce::FloatVectorOperations::copy (spectrum.data(), frame.data(), numBins);
+        
+        // Centroid as a fraction of Nyquist, so it doesn't depend on the sample rate
+        const auto magnitude = sum (spectrum.data(), numBins);
+        juce::FloatVectorOperations::multiply (weighted.data(), spectrum.data(), tables->binFrequencies.data(), numBins);
+        centroids.push_back (magnitude > 1.0e-9f ? sum (weighted.data(), numBins) / magnitude / (float) (sampleRate * 0.5) : 0.0f);
+        
+        // Flux: positive spectral change only, normalised by frame energy
+        juce::FloatVectorOperations::subtract (weighted.data(), spectrum.data(), previousSpectrum.data(), numBins);
+        juce::FloatVectorOperations::clip (weighted.data(), weighted.data(), 0.0f, std::numeric_limits<float>::max(), numBins);
+        fluxes.push_back (magnitude > 1.0e-9f ? sum (weighted.data(), numBins) / magnitude : 0.0f);
+        std::swap (spectrum, previousSpectrum);
+        
+        // previousSpectrum now holds this frame
+        for (int band = 0; band < numMelBands; ++band)
+        {
+            juce::FloatVectorOperations::multiply (weighted.data(), previousSpectrum.data(), tables->melWeights.data() + band * numBins, numBins);
+            melEnergies[(size_t) band] = std::log (sum (weighted.data(), numBins) + 1.0e-6f);
+        }
+        
+        for (int k = 0; k < numMfccs; ++k)
+            mfccs[(size_t) k].push_back (std::inner_product (melEnergies.begin(), melEnergies.end(), tables->dct.begin() + k * numMelBands, 0.0f));
+    }
+    
+    meanAndStd (centroids, features[centroidMean], features[centroidStd]);
+    meanAndStd (fluxes, features[fluxMean], features[fluxStd]);
+    
+    for (int k = 0; k < numMfccs; ++k)
+        meanAndStd (mfccs[(size_t) k], features[(size_t) (mfccMean + k)], features[(size_t) (mfccStd + k)]);
+    
+    // Envelope descriptors from the frame RMS: times in seconds, levels relative to the peak
+    const auto peakFrame = (int) std::distance (frameRms.begin(), std::max_element (frameRms.begin(), frameRms.end()));
+    const auto peak = frameRms[(size_t) peakFrame];
+    const auto secondsPerFrame = (float) (hopSize / sampleRate);
+    
+    if (peak > 1.0e-6f)
+    {
+        int attackEnd = 0;
+        
+        while (attackEnd < peakFrame && frameRms[(size_t) attackEnd] < peak * 0.9f)
+            ++attackEnd;
+        
+        int decayEnd = peakFrame;
+        
+        while (decayEnd < (int) frameRms.size() - 1 && frameRms[(size_t) decayEnd] > peak * 0.5f)
+            ++decayEnd;
+        
+        features[attackTime] = (float) attackEnd * secondsPerFrame;
+        features[decayTime] = (float) (decayEnd - peakFrame) * secondsPerFrame;
+        features[sustainLevel] = frameRms[frameRms.size() / 2] / peak;
+        features[releaseLevel] = frameRms.back() / peak;
+    }
+    
+    return features;
+}
+
+juce::StringArray AudioFeatureExtractor::getFeatureNames()
+{
+    juce::StringArray names { "centroidMean", "centroidStd", "fluxMean", "fluxStd" };
+    
+    for (int k = 0; k < numMfccs; ++k)
+        names.add ("mfccMean" + juce::String (k));
+    
+    for (int k = 0; k < numMfccs; ++k)
+        names.add ("mfccStd" + juce::String (k));
+    
+    names.addArray ({ "attackTime", "decayTime", "sustainLevel", "releaseLevel" });
+    return names;
+}
+
+void AudioFeatureExtractor::mixToMono (const juce::AudioBuffer<float>& audio)
+{
+    const auto numChannels = audio.getNumChannels();
+    mono.resize ((size_t) audio.getNumSamples());
+    
+    if (numChannels == 0)
+        return;
+    
+    juce::FloatVectorOperations::copy (mono.data(), audio.getReadPointer (0), audio.getNumSamples());
+    
+    for (int ch = 1; ch < numChannels; ++ch)
+        juce::FloatVectorOperations::add (mono.data(), audio.getReadPointer (ch), audio.getNumSamples());
+    
+    juce::FloatVectorOperations::multiply (mono.data(), 1.0f / (float) numChannels, audio.getNumSamples());
+}
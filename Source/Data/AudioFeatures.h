@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    AudioFeatures.h
+    Created: 18 Oct 2026 9:40:26pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SharedResourceCache.h"
+
+// Timbre and envelope descriptors of a short rendered probe.
+//
+// The signal is cut into Hann-windowed frames and run through juce::dsp::FFT
+// (vDSP, IPP or FFTW where available). Per frame we take the spectral centroid,
+// spectral flux and MFCCs from a mel filterbank and a precomputed DCT; per
+// clip, an RMS envelope gives attack, decay, sustain and release descriptors.
+// Frame statistics are summarised as mean and standard deviation, so every clip
+// maps to the same fixed-length vector whatever its length.
+//
+// The window, filterbank and DCT only depend on the sample rate, and every
+// extractor in the process at the same rate shares one copy of them. The FFT
+// keeps working buffers of its own, so each extractor has its own.
+class AudioFeatureExtractor
+{
+public:
+    static constexpr int fftOrder { 10 };
+    static constexpr int fftSize { 1 << fftOrder };
+    static constexpr int hopSize { fftSize / 2 };
+    static constexpr int numMelBands { 26 };
+    static constexpr int numMfccs { 13 };
+
+    enum Feature
+    {
+        centroidMean, centroidStd,
+        fluxMean, fluxStd,
+        mfccMean,
+        mfccStd = mfccMean + numMfccs,
+        attackTime = mfccStd + numMfccs,
+        decayTime,
+        sustainLevel,
+        releaseLevel,
+        numFeatures
+    };
+
+    using Vector = std::array<float, numFeatures>;
+
+    explicit AudioFeatureExtractor (const double sampleRate);
+
+    // Not thread-safe: keep one extractor per thread
+    Vector process (const juce::AudioBuffer<float>& audio);
+
+    static juce::StringArray getFeatureNames();
+
+private:
+    struct Tables
+    {
+        explicit Tables (const double sampleRate);
+
+        std::vector<float> window;
+        std::vector<float> melWeights;      // numMelBands x (fftSize / 2 + 1)
+        std::vector<float> dct;             // numMfccs x numMelBands
+        std::vector<float> binFrequencies;
+    };
+
+    void mixToMono (const juce::AudioBuffer<float>& audio);
+
+    double sampleRate;
+    SharedResourceCache<Tables>::Ptr tables;
+    juce::dsp::FFT fft { fftOrder };
+
+    std::vector<float> mono;
+    std::vector<float> frame;           // 2 * fftSize, as the FFT wants
+    std::vector<float> spectrum;
+    std::vector<float> previousSpectrum;
+    std::vector<float> weighted;
+    std::array<float, numMelBands> melEnergies;
+};
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    AuditionPhrase.cpp
+    Created: 18 Oct 2026 8:31:44pm
+
+  ==============================================================================
+*/
+
+#include "AuditionPhrase.h"
+
+void AuditionPhrase::addEvents (juce::MidiBuffer& midi, const int blockStart, const int numSamples, const double sampleRate) const
+{
+    for (const auto& note : notes)
+    {
+        const auto noteOn = (int) (note.start * sampleRate) - blockStart;
+        const auto noteOff = (int) ((note.start + note.length) * sampleRate) - blockStart;
+        
+        if (juce::isPositiveAndBelow (noteOn, numSamples))
+            midi.addEvent (juce::MidiMessage::noteOn (1, note.noteNumber, note.velocity), noteOn);
+        
+        if (juce::isPositiveAndBelow (noteOff, numSamples))
+            midi.addEvent (juce::MidiMessage::noteOff (1, note.noteNumber), noteOff);
+    }
+}
+
+bool AuditionPhrase::render (juce::AudioProcessor& instance, juce::AudioBuffer<float>& clip, const double sampleRate,
+                             const int blockSize, const std::function<bool()>& shouldExit) const
+{
+    const auto numChannels = juce::jmax (1, instance.getTotalNumOutputChannels());
+    const auto totalSamples = getNumSamples (sampleRate);
+    
+    instance.setNonRealtime (true);
+    instance.setRateAndBufferSizeDetails (sampleRate, blockSize);
+    instance.prepareToPlay (sampleRate, blockSize);
+    
+    clip.setSize (numChannels, totalSamples, false, false, true);
+    juce::AudioBuffer<float> block (numChannels, blockSize);
+    juce::MidiBuffer midi;
+    
+    for (int start = 0; start < totalSamples; start += blockSize)
+    {
+        if (shouldExit != nullptr && shouldExit())
+        {
+            instance.releaseResources();
+            return false;
+        }
+        
+        const auto numSamples = juce::jmin (blockSize, totalSamples - start);
+        block.setSize (numChannels, numSamples, false, false, true);
+        block.clear();
+        midi.clear();
+        addEvents (midi, start, numSamples, sampleRate);
+        
+        instance.processBlock (block, midi);
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+            clip.copyFrom (ch, start, block, ch, 0, numSamples);
+    }
+    
+    instance.releaseResources();
+    return true;
+}
@@ -0,0 +1,39 @@
+/*
+  ==============================================================================
+
+    AuditionPhrase.h
+    Created: 18 Oct 2026 8:31:44pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// A short fixed MIDI phrase, and the loop that renders it through a processor
+// in host-sized blocks. Whatever auditions patches owns the phrases it plays;
+// this only plays them, the same way for everyone.
+class AuditionPhrase
+{
+public:
+    struct Note
+    {
+        int noteNumber;
+        float velocity;
+        double start;
+        double length;
+    };
+
+    juce::String name;
+    double lengthSeconds { 0.0 };
+    std::vector<Note> notes;
+
+    void addEvents (juce::MidiBuffer& midi, const int blockStart, const int numSamples, const double sampleRate) const;
+
+    // Prepares the instance, renders the phrase into clip and releases it again; false if cancelled
+    bool render (juce::AudioProcessor& instance, juce::AudioBuffer<float>& clip, const double sampleRate,
+                 const int blockSize, const std::function<bool()>& shouldExit = {}) const;
+
+    int getNumSamples (const double sampleRate) const { return (int) (lengthSeconds * sampleRate); }
+};
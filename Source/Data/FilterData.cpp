@@ -15,17 +15,28 @@ FilterData::FilterData()
     setType (juce::dsp::StateVariableTPTFilterType::lowpass);
 }
 
-void FilterData::setParams (const int filterType, const float filterCutoff, const float filterResonance)
+void FilterData::setParams (const int filterType, const float filterCutoff, const float filterResonance, const int fadeSamples)
 {
+    const auto previousType = getType();
     selectFilterType (filterType);
+    
+    if (getType() != previousType)
+    {
+        // Start the old response from the current state, so both outputs line up
+        fadeFilter = *this;
+        fadeFilter.setType (previousType);
+        fadeLength = juce::jmax (1, fadeSamples);
+        fadeSamplesRemaining = fadeLength;
+    }
+    
     setCutoffFrequency (filterCutoff);
     setResonance (filterResonance);
-}
-
-void FilterData::setLfoParams (const float freq, const float depth)
-{
-//    lfoGain = juce::Decibels::gainToDecibels (depth);
-//    lfo.setFrequency (freq);
+    
+    if (fadeSamplesRemaining > 0)
+    {
+        fadeFilter.setCutoffFrequency (filterCutoff);
+        fadeFilter.setResonance (filterResonance);
+    }
 }
 
 void FilterData::prepareToPlay (double sampleRate, int samplesPerBlock, int outputChannels)
@@ -36,6 +47,8 @@ void FilterData::prepareToPlay (double sampleRate, int samplesPerBlock, int outp
     spec.sampleRate = sampleRate;
     spec.numChannels = outputChannels;
     prepare (spec);
+    fadeFilter.prepare (spec);
+    fadeSamplesRemaining = 0;
 }
 
 
@@ -69,11 +82,19 @@ void FilterData::processNextBlock(juce::AudioBuffer<float>& buffer)
 
 float FilterData::processNextSample (int channel, float inputValue)
 {
-    return processSample (channel, inputValue);
+    const auto output = processSample (channel, inputValue);
+    
+    if (fadeSamplesRemaining <= 0)
+        return output;
+    
+    const auto fade = (float) fadeSamplesRemaining / (float) fadeLength;
+    const auto previous = fadeFilter.processSample (channel, inputValue);
+    --fadeSamplesRemaining;
+    
+    return output + (previous - output) * fade;
 }
 
 void FilterData::resetAll()
 {
     reset();
-    lfo.reset();
 }
@@ -19,13 +19,19 @@ class FilterData : public juce::dsp::StateVariableTPTFilter<float>
 public:
     FilterData();
     void prepareToPlay (double sampleRate, int samplesPerBlock, int outputChannels);
-    void setParams (const int filterType, const float filterCutoff, const float filterResonance);
-    void setLfoParams (const float freq, const float depth);
+    void setParams (const int filterType, const float filterCutoff, const float filterResonance, const int fadeSamples);
     void processNextBlock (juce::AudioBuffer<float>& buffer);
     float processNextSample (int channel, float inputValue);
     void resetAll();
     
+    // Drops the fade from a previous filter type
+    void settle() { fadeSamplesRemaining = 0; }
+    
 private:
     void selectFilterType (const int type);
-    juce::dsp::Oscillator<float> lfo { [](float x) { return std::sin (x); }};
+    
+    // A copy of the filter keeps the old type running after a type change, and is faded out
+    juce::dsp::StateVariableTPTFilter<float> fadeFilter;
+    int fadeLength { 0 };
+    int fadeSamplesRemaining { 0 };
 };
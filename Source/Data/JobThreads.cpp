@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    JobThreads.cpp
+    Created: 19 Oct 2026 7:48:20am
+
+  ==============================================================================
+*/
+
+#include "JobThreads.h"
+
+JobThreads::JobThreads (const juce::String& threadName, Job jobToRun)
+: name (threadName), job (std::move (jobToRun))
+{
+}
+
+JobThreads::~JobThreads()
+{
+    stop();
+}
+
+void JobThreads::start (const int numWorkers)
+{
+    while ((int) workers.size() < numWorkers)
+    {
+        workers.push_back (std::make_unique<Worker> (*this, name));
+        workers.back()->startThread (juce::Thread::Priority::high);
+    }
+}
+
+void JobThreads::stop()
+{
+    for (auto& worker : workers)
+    {
+        worker->signalThreadShouldExit();
+        worker->notify();
+    }
+    
+    for (auto& worker : workers)
+        worker->stopThread (2000);
+    
+    workers.clear();
+}
+
+void JobThreads::run (const int newNumJobs)
+{
+    if (newNumJobs <= 0)
+        return;
+    
+    numJobs = newNumJobs;
+    nextJob.store (0);
+    
+    const auto numHelpers = juce::jmin ((int) workers.size(), numJobs - 1);
+    numBusyWorkers.store (numHelpers);
+    
+    for (int i = 0; i < numHelpers; ++i)
+        workers[(size_t) i]->notify();
+    
+    runJobs();
+    
+    if (numHelpers > 0)
+        jobsFinished.wait();
+}
+
+void JobThreads::runJobs()
+{
+    juce::ScopedNoDenormals noDenormals;
+    
+    for (auto i = nextJob.fetch_add (1); i < numJobs; i = nextJob.fetch_add (1))
+        job (i);
+}
+
+void JobThreads::Worker::run()
+{
+    while (! threadShouldExit())
+    {
+        wait (-1);
+        
+        if (threadShouldExit())
+            return;
+        
+        owner.runJobs();
+        
+        // The last worker out wakes the calling thread
+        if (owner.numBusyWorkers.fetch_sub (1) == 1)
+            owner.jobsFinished.signal();
+    }
+}
@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    JobThreads.h
+    Created: 19 Oct 2026 7:48:20am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// A few parked threads that help the calling thread through a list of jobs.
+//
+// run() hands out job indices from a shared counter: the calling thread and
+// every woken worker take the next one until none are left, then the caller
+// waits for the last worker to finish. Nothing is allocated or locked per run,
+// so it can be driven from an audio thread; workers sleep in between.
+class JobThreads
+{
+public:
+    using Job = std::function<void (int)>;
+    
+    JobThreads (const juce::String& threadName, Job jobToRun);
+    ~JobThreads();
+    
+    // Starts workers until there are numWorkers, leaving any already running
+    void start (const int numWorkers);
+    
+    // Stops the workers
+    void stop();
+    
+    int getNumWorkers() const { return (int) workers.size(); }
+    
+    // Calls the job once for every index below numJobs, spread over the calling thread and
+    // as many workers as there are jobs for, and returns once all of them are done
+    void run (const int numJobs);
+    
+private:
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker (JobThreads& j, const juce::String& name) : juce::Thread (name), owner (j) {}
+        void run() override;
+        
+    private:
+        JobThreads& owner;
+    };
+    
+    void runJobs();
+    
+    const juce::String name;
+    const Job job;
+    std::vector<std::unique_ptr<Worker>> workers;
+    int numJobs { 0 };
+    std::atomic<int> nextJob { 0 };
+    std::atomic<int> numBusyWorkers { 0 };
+    juce::WaitableEvent jobsFinished;
+};
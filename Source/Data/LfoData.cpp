@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    LfoData.cpp
+    Created: 18 Oct 2026 11:20:48pm
+
+  ==============================================================================
+*/
+
+#include "LfoData.h"
+
+void LfoData::prepare (const double newSampleRate, const int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+    
+    const auto maxSteps = (size_t) (juce::jmax (1, maximumBlockSize) + stepSize - 1) / stepSize;
+    globalValues.assign (maxSteps, 0.0f);
+    voiceValues.assign (maxSteps, {});
+    
+    // Free-running voices start spread over the cycle, so a chord doesn't move in lockstep
+    globalPhase = 0.0f;
+    
+    for (int v = 0; v < maxVoices; ++v)
+        voicePhases[(size_t) v] = (float) v / (float) maxVoices;
+    
+    numSteps = 0;
+}
+
+void LfoData::setParams (const float frequency, const int newMode)
+{
+    phaseIncrement = (float) (frequency / sampleRate);
+    mode = (Mode) juce::jlimit (0, numModes - 1, newMode);
+}
+
+void LfoData::process (const int startSample, const int numSamples)
+{
+    spanStart = startSample;
+    spanLength = numSamples;
+    numSteps = (numSamples + stepSize - 1) / stepSize;
+    
+    // A span longer than prepared for still works, the table just grows once
+    if ((size_t) numSteps > globalValues.size())
+    {
+        globalValues.resize ((size_t) numSteps);
+        voiceValues.resize ((size_t) numSteps);
+    }
+    
+    const auto stepIncrement = phaseIncrement * (float) stepSize;
+    
+    if (mode == global)
+    {
+        for (int step = 0; step < numSteps; ++step)
+            globalValues[(size_t) step] = sine (globalPhase + stepIncrement * (float) step);
+    }
+    else
+    {
+        for (int step = 0; step < numSteps; ++step)
+        {
+            auto& values = voiceValues[(size_t) step];
+            const auto offset = stepIncrement * (float) step;
+            
+            for (int v = 0; v < maxVoices; ++v)
+                values[(size_t) v] = sine (voicePhases[(size_t) v] + offset);
+        }
+    }
+    
+    // Every phase keeps running whatever the mode, so switching modes doesn't jump back to zero
+    const auto spanIncrement = phaseIncrement * (float) numSamples;
+    globalPhase = globalPhase + spanIncrement - std::floor (globalPhase + spanIncrement);
+    
+    for (auto& phase : voicePhases)
+        phase = phase + spanIncrement - std::floor (phase + spanIncrement);
+}
+
+void LfoData::noteOn (const int voice, const int startSample)
+{
+    if (mode != keySync || ! juce::isPositiveAndBelow (voice, maxVoices))
+        return;
+    
+    // Only the rest of this span changes: the cycle starts again at the note
+    const auto offset = juce::jlimit (0, spanLength, startSample - spanStart);
+    
+    for (int step = getStep (startSample); step < numSteps; ++step)
+        voiceValues[(size_t) step][(size_t) voice] = sine (phaseIncrement * (float) juce::jmax (0, step * stepSize - offset));
+    
+    const auto phase = phaseIncrement * (float) (spanLength - offset);
+    voicePhases[(size_t) voice] = phase - std::floor (phase);
+}
+
+float LfoData::getValue (const int voice, const int startSample) const
+{
+    if (numSteps == 0)
+        return 0.0f;
+    
+    const auto step = getStep (startSample);
+    
+    if (mode == global || ! juce::isPositiveAndBelow (voice, maxVoices))
+        return globalValues[(size_t) step];
+    
+    return voiceValues[(size_t) step][(size_t) voice];
+}
+
+float LfoData::sine (const float phase)
+{
+    // FastMathApproximations::sin is only accurate in -pi..pi, so wrap first; sin (x - pi) = -sin (x)
+    const auto wrapped = phase - std::floor (phase);
+    return -juce::dsp::FastMathApproximations::sin (juce::MathConstants<float>::twoPi * wrapped - juce::MathConstants<float>::pi);
+}
+
+int LfoData::getStep (const int startSample) const
+{
+    return juce::jlimit (0, juce::jmax (0, numSteps - 1), (startSample - spanStart) / stepSize);
+}
@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    LfoData.h
+    Created: 18 Oct 2026 11:20:48pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// The synth's LFO, evaluated at control rate for every voice at once.
+//
+// Before each render the processor asks for the span it's about to render, and
+// the bank fills a table with one value per control step: a single row for the
+// global LFO, shared by all voices, or one lane per voice for the free-running
+// and key-synced modes. Voice lanes are laid out side by side so a step of all
+// voices is one branch-free loop. Voices then just read their value for the
+// step they are rendering.
+class LfoData
+{
+public:
+    enum Mode
+    {
+        global,
+        freeRunning,
+        keySync,
+        numModes
+    };
+    
+    static constexpr int stepSize { 32 };
+    static constexpr int maxVoices { 8 };
+    
+    void prepare (const double sampleRate, const int maximumBlockSize);
+    void setParams (const float frequency, const int mode);
+    
+    // Fills the table for the numSamples starting at startSample of the block being rendered
+    void process (const int startSample, const int numSamples);
+    
+    // Restarts a voice's cycle at a position inside the current span, in key-sync mode
+    void noteOn (const int voice, const int startSample);
+    
+    // -1 to 1, for the control step holding startSample
+    float getValue (const int voice, const int startSample) const;
+    
+private:
+    static float sine (const float phase);
+    int getStep (const int startSample) const;
+    
+    double sampleRate { 44100.0 };
+    float phaseIncrement { 0.0f };
+    Mode mode { global };
+    
+    float globalPhase { 0.0f };
+    std::array<float, maxVoices> voicePhases {};
+    
+    int spanStart { 0 };
+    int spanLength { 0 };
+    int numSteps { 0 };
+    std::vector<float> globalValues;                        // numSteps
+    std::vector<std::array<float, maxVoices>> voiceValues;  // numSteps x maxVoices
+};
@@ -0,0 +1,44 @@
+/*
+  ==============================================================================
+
+    MorphData.cpp
+    Created: 18 Oct 2026 2:40:08pm
+
+  ==============================================================================
+*/
+
+#include "MorphData.h"
+
+void MorphData::start (const PatchData& current, const PatchData& target, const int numSamples)
+{
+    from = current;
+    to = target;
+    
+    for (int i = 0; i < PatchData::numParameters; ++i)
+    {
+        if (PatchData::isDiscrete (i))
+            from.setValue (i, to.getValue (i));
+    }
+    
+    // Discrete entries end up with a zero delta, so they drop out of the lerp
+    juce::FloatVectorOperations::subtract (delta.getValues().data(), to.getValues().data(), from.getValues().data(), PatchData::numParameters);
+    
+    totalSamples = juce::jmax (0, numSamples);
+    remainingSamples = totalSamples;
+}
+
+void MorphData::process (const int numSamples, PatchData& patch)
+{
+    remainingSamples = juce::jmax (0, remainingSamples - numSamples);
+    
+    if (remainingSamples == 0)
+    {
+        patch = to;
+        return;
+    }
+    
+    const auto position = 1.0f - (float) remainingSamples / (float) totalSamples;
+    
+    juce::FloatVectorOperations::copy (patch.getValues().data(), from.getValues().data(), PatchData::numParameters);
+    juce::FloatVectorOperations::addWithMultiply (patch.getValues().data(), delta.getValues().data(), position, PatchData::numParameters);
+}
@@ -0,0 +1,35 @@
+/*
+  ==============================================================================
+
+    MorphData.h
+    Created: 18 Oct 2026 2:40:08pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PatchData.h"
+
+// Interpolates between two full patches over a number of samples.
+//
+// Continuous parameters are a single vectorised lerp over the whole snapshot.
+// Discrete ones (waveforms, filter type) jump to the target at the start; the
+// voices crossfade their output over the morph time instead of stepping.
+class MorphData
+{
+public:
+    void start (const PatchData& current, const PatchData& target, const int numSamples);
+    void process (const int numSamples, PatchData& patch);
+    
+    bool isMorphing() const { return remainingSamples > 0; }
+    int getRemainingSamples() const { return remainingSamples; }
+
+private:
+    PatchData from;
+    PatchData to;
+    PatchData delta;
+    int totalSamples { 0 };
+    int remainingSamples { 0 };
+};
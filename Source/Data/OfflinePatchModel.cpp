@@ -0,0 +1,269 @@
+/*
+  ==============================================================================
+
+    OfflinePatchModel.cpp
+    Created: 18 Oct 2026 6:58:22pm
+
+  ==============================================================================
+*/
+
+#include "OfflinePatchModel.h"
+
+namespace
+{
+    using Hyperplanes = std::array<std::array<PromptEmbedding::Vector, OfflinePatchModel::numBits>, OfflinePatchModel::numTables>;
+    
+    const Hyperplanes& getHyperplanes()
+    {
+        static const Hyperplanes hyperplanes = []
+        {
+            // A fixed seed keeps bucket assignment identical between runs
+            juce::Random random (0x74617053);
+            Hyperplanes planes;
+            
+            for (auto& table : planes)
+                for (auto& plane : table)
+                    for (auto& v : plane)
+                        v = random.nextFloat() * 2.0f - 1.0f;
+            
+            return planes;
+        }();
+        
+        return hyperplanes;
+    }
+}
+
+void OfflinePatchModel::rebuild (const PresetBank& bank, const PatchData& defaults)
+{
+    auto newIndex = SharedResourceCache<Index>::get (getContentKey (bank, defaults), [&] { return build (bank, defaults); });
+    
+    const juce::ScopedLock sl (lock);
+    index = std::move (newIndex);
+}
+
+juce::String OfflinePatchModel::getContentKey (const PresetBank& bank, const PatchData& defaults)
+{
+    // Adding a preset replaces the file and renaming one rewrites it in place, so either moves
+    // its modification time. The defaults are a few hundred bytes, cheap enough to hash whole
+    const auto file = bank.getFile();
+    const juce::MD5 defaultsHash (defaults.getValues().data(), sizeof (float) * PatchData::numParameters);
+    
+    return "OfflinePatchModel " + file.getFullPathName()
+         + " " + juce::String (file.getSize())
+         + " " + juce::String (file.getLastModificationTime().toMilliseconds())
+         + " " + juce::String (bank.getNumPresets())
+         + " " + defaultsHash.toHexString();
+}
+
+std::shared_ptr<const OfflinePatchModel::Index> OfflinePatchModel::build (const PresetBank& bank, const PatchData& defaults)
+{
+    auto newIndex = std::make_shared<Index>();
+    auto& newEntries = newIndex->entries;
+    addArchetypes (defaults, newEntries);
+    
+    for (int i = 0; i < bank.getNumPresets(); ++i)
+    {
+        Entry entry;
+        
+        if (! PromptEmbedding::embed (bank.getName (i) + " " + bank.getTags (i), entry.embedding))
+            continue;
+        
+        // Presets only store the parameters they know about, the rest stay at their defaults
+        entry.patch = defaults;
+        
+        if (bank.getPatch (i, entry.patch))
+            newEntries.push_back (entry);
+    }
+    
+    for (int table = 0; table < numTables; ++table)
+        for (int i = 0; i < (int) newEntries.size(); ++i)
+            newIndex->buckets[(size_t) table][getSignature (table, newEntries[(size_t) i].embedding)].push_back (i);
+    
+    return newIndex;
+}
+
+std::shared_ptr<const OfflinePatchModel::Index> OfflinePatchModel::getIndex() const
+{
+    const juce::ScopedLock sl (lock);
+    return index;
+}
+
+bool OfflinePatchModel::infer (const juce::String& prompt, juce::var& params) const
+{
+    PromptEmbedding::Vector query;
+    
+    if (! PromptEmbedding::embed (prompt, query))
+        return false;
+    
+    const auto current = getIndex();
+    
+    if (current == nullptr)
+        return false;
+    
+    const auto& entries = current->entries;
+    std::vector<Match> matches;
+    findNeighbours (*current, query, matches);
+    
+    if (matches.empty() || matches.front().similarity <= 0.0f)
+        return false;
+    
+    // Softmax over similarity: a clear winner dominates, near ties are mixed
+    std::array<float, PatchData::numParameters> blended {};
+    float totalWeight = 0.0f;
+    
+    for (const auto& match : matches)
+    {
+        if (match.similarity <= 0.0f)
+            break;
+        
+        const auto weight = std::exp ((match.similarity - matches.front().similarity) / blendTemperature);
+        const auto& values = entries[(size_t) match.entry].patch.getValues();
+        
+        juce::FloatVectorOperations::addWithMultiply (blended.data(), values.data(), weight, PatchData::numParameters);
+        totalWeight += weight;
+    }
+    
+    juce::FloatVectorOperations::multiply (blended.data(), 1.0f / totalWeight, PatchData::numParameters);
+    
+    auto* obj = new juce::DynamicObject();
+    params = juce::var (obj);
+    
+    const auto& best = entries[(size_t) matches.front().entry].patch;
+    
+    for (int i = 0; i < PatchData::numParameters; ++i)
+    {
+        // Choices can't be averaged, they come from the closest entry
+        const auto value = PatchData::isDiscrete (i) ? best.getValue (i) : blended[(size_t) i];
+        obj->setProperty (PatchData::parameterIds[(size_t) i], value);
+    }
+    
+    return true;
+}
+
+int OfflinePatchModel::getNumEntries() const
+{
+    const auto current = getIndex();
+    return current != nullptr ? (int) current->entries.size() : 0;
+}
+
+juce::uint32 OfflinePatchModel::getSignature (const int table, const PromptEmbedding::Vector& v)
+{
+    const auto& hyperplanes = getHyperplanes();
+    juce::uint32 signature = 0;
+    
+    for (int bit = 0; bit < numBits; ++bit)
+        if (PromptEmbedding::similarity (hyperplanes[(size_t) table][(size_t) bit], v) >= 0.0f)
+            signature |= 1u << bit;
+    
+    return signature;
+}
+
+void OfflinePatchModel::findNeighbours (const Index& index, const PromptEmbedding::Vector& query, std::vector<Match>& matches)
+{
+    const auto& entries = index.entries;
+    std::vector<int> candidates;
+    
+    // Probe the query's own bucket and every bucket one bit away in each table
+    for (int table = 0; table < numTables; ++table)
+    {
+        const auto signature = getSignature (table, query);
+        const auto& tableBuckets = index.buckets[(size_t) table];
+        
+        for (int flip = -1; flip < numBits; ++flip)
+        {
+            const auto probe = flip < 0 ? signature : signature ^ (1u << flip);
+            const auto found = tableBuckets.find (probe);
+            
+            if (found != tableBuckets.end())
+                candidates.insert (candidates.end(), found->second.begin(), found->second.end());
+        }
+    }
+    
+    std::sort (candidates.begin(), candidates.end());
+    candidates.erase (std::unique (candidates.begin(), candidates.end()), candidates.end());
+    
+    // Too few hits to rank means the probes missed; the corpus is small enough to scan
+    if ((int) candidates.size() < numNeighbours)
+    {
+        candidates.resize (entries.size());
+        std::iota (candidates.begin(), candidates.end(), 0);
+    }
+    
+    for (const auto i : candidates)
+        matches.push_back ({ i, PromptEmbedding::similarity (query, entries[(size_t) i].embedding) });
+    
+    const auto numToKeep = juce::jmin (numNeighbours, (int) matches.size());
+    std::partial_sort (matches.begin(), matches.begin() + numToKeep, matches.end(),
+                       [] (const Match& a, const Match& b) { return a.similarity > b.similarity; });
+    matches.resize ((size_t) numToKeep);
+}
+
+void OfflinePatchModel::addArchetypes (const PatchData& defaults, std::vector<Entry>& entries)
+{
+    struct Archetype
+    {
+        const char* tags;
+        std::vector<std::pair<PatchData::Parameter, float>> values;
+    };
+    
+    using P = PatchData;
+    
+    static const std::vector<Archetype> archetypes
+    {
+        { "sub bass deep clean", { { P::osc1Choice, 0 }, { P::osc2Choice, 0 }, { P::osc2Pitch, -12 }, { P::osc2Gain, -6 },
+                                   { P::filterCutoff, 300 }, { P::filterAdsrDepth, 0 }, { P::attack, 0.1f }, { P::decay, 0.3f },
+                                   { P::sustain, 0.9f }, { P::release, 0.2f }, { P::reverbWet, 0.0f } } },
+        { "heavy gritty bass", { { P::osc1Choice, 1 }, { P::osc2Choice, 2 }, { P::osc2Pitch, -12 }, { P::filterCutoff, 500 },
+                                 { P::filterResonance, 0.9f }, { P::filterAdsrDepth, 2500 }, { P::filterDecay, 0.3f },
+                                 { P::filterSustain, 0.2f }, { P::decay, 0.4f }, { P::sustain, 0.7f }, { P::release, 0.2f } } },
+        { "wobble dubstep bass", { { P::osc1Choice, 1 }, { P::osc2Choice, 1 }, { P::osc2Pitch, -12 }, { P::filterCutoff, 600 },
+                                   { P::filterResonance, 1.5f }, { P::lfo1Freq, 4 }, { P::lfo1Depth, 3000 }, { P::filterAdsrDepth, 0 },
+                                   { P::sustain, 1.0f }, { P::release, 0.2f } } },
+        { "warm lush ambient pad", { { P::osc1Choice, 1 }, { P::osc2Choice, 1 }, { P::osc2Pitch, 12 }, { P::osc2Gain, -10 },
+                                     { P::filterCutoff, 1200 }, { P::filterAdsrDepth, 800 }, { P::filterAttack, 0.8f },
+                                     { P::attack, 0.9f }, { P::decay, 0.8f }, { P::sustain, 0.8f }, { P::release, 2.5f },
+                                     { P::reverbSize, 0.9f }, { P::reverbWet, 0.5f }, { P::reverbDry, 0.7f } } },
+        { "dark evolving drone", { { P::osc1Choice, 1 }, { P::osc2Choice, 2 }, { P::osc2Pitch, -5 }, { P::filterCutoff, 400 },
+                                   { P::filterResonance, 1.2f }, { P::lfo1Freq, 0.2f }, { P::lfo1Depth, 600 }, { P::filterAdsrDepth, 0 },
+                                   { P::attack, 1.0f }, { P::sustain, 1.0f }, { P::release, 3.0f }, { P::reverbSize, 0.8f },
+                                   { P::reverbWet, 0.4f } } },
+        { "bright pluck short", { { P::osc1Choice, 1 }, { P::osc2Choice, 2 }, { P::filterCutoff, 800 }, { P::filterAdsrDepth, 6000 },
+                                  { P::filterAttack, 0.0f }, { P::filterDecay, 0.2f }, { P::filterSustain, 0.0f }, { P::filterRelease, 0.2f },
+                                  { P::attack, 0.1f }, { P::decay, 0.3f }, { P::sustain, 0.1f }, { P::release, 0.3f },
+                                  { P::reverbSize, 0.4f }, { P::reverbWet, 0.2f } } },
+        { "aggressive bright lead", { { P::osc1Choice, 1 }, { P::osc2Choice, 2 }, { P::osc2Pitch, 7 }, { P::osc2Gain, -8 },
+                                      { P::filterCutoff, 5000 }, { P::filterResonance, 1.0f }, { P::filterAdsrDepth, 3000 },
+                                      { P::attack, 0.1f }, { P::sustain, 0.9f }, { P::release, 0.3f }, { P::reverbWet, 0.15f } } },
+        { "soft sine flute lead", { { P::osc1Choice, 0 }, { P::osc2Choice, 0 }, { P::osc2Pitch, 12 }, { P::osc2Gain, -18 },
+                                    { P::lfo1Freq, 5 }, { P::lfo1Depth, 50 }, { P::attack, 0.3f }, { P::sustain, 0.9f },
+                                    { P::release, 0.5f }, { P::reverbSize, 0.5f }, { P::reverbWet, 0.25f } } },
+        { "metallic glass bell", { { P::osc1Choice, 0 }, { P::osc2Choice, 0 }, { P::osc1FmFreq, 700 }, { P::osc1FmDepth, 60 },
+                                   { P::osc2Pitch, 19 }, { P::osc2Gain, -12 }, { P::attack, 0.1f }, { P::decay, 1.0f },
+                                   { P::sustain, 0.1f }, { P::release, 2.0f }, { P::reverbSize, 0.7f }, { P::reverbWet, 0.35f } } },
+        { "organ keys clean", { { P::osc1Choice, 0 }, { P::osc2Choice, 2 }, { P::osc2Pitch, 12 }, { P::osc2Gain, -14 },
+                                { P::filterCutoff, 4000 }, { P::filterAdsrDepth, 0 }, { P::attack, 0.1f }, { P::sustain, 1.0f },
+                                { P::release, 0.2f }, { P::reverbWet, 0.15f } } },
+        { "retro chiptune square dry", { { P::osc1Choice, 2 }, { P::osc2Choice, 2 }, { P::osc2Pitch, 12 }, { P::osc2Gain, -12 },
+                                         { P::filterAdsrDepth, 0 }, { P::attack, 0.1f }, { P::decay, 0.2f }, { P::sustain, 0.6f },
+                                         { P::release, 0.1f }, { P::reverbWet, 0.0f } } },
+        { "slow strings swell", { { P::osc1Choice, 1 }, { P::osc2Choice, 1 }, { P::osc2Pitch, 0 }, { P::osc2FmFreq, 5 },
+                                  { P::osc2FmDepth, 2 }, { P::filterCutoff, 2500 }, { P::filterAdsrDepth, 1500 },
+                                  { P::filterAttack, 0.7f }, { P::attack, 0.8f }, { P::sustain, 0.9f }, { P::release, 1.5f },
+                                  { P::reverbSize, 0.8f }, { P::reverbWet, 0.4f } } },
+    };
+    
+    for (const auto& archetype : archetypes)
+    {
+        Entry entry;
+        
+        if (! PromptEmbedding::embed (archetype.tags, entry.embedding))
+            continue;
+        
+        entry.patch = defaults;
+        
+        for (const auto& value : archetype.values)
+            entry.patch.setValue (value.first, value.second);
+        
+        entries.push_back (entry);
+    }
+}
@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    OfflinePatchModel.h
+    Created: 18 Oct 2026 6:58:22pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PatchData.h"
+#include "PresetBank.h"
+#include "PromptEmbedding.h"
+#include "SharedResourceCache.h"
+
+// Turns a prompt into a patch without the network.
+//
+// Every tagged preset in the bank, plus a few built-in archetypes so an empty
+// bank still answers, is embedded by its name and tags. Prompts are embedded the
+// same way, the nearest entries are found through a random-hyperplane LSH index,
+// and their parameters are blended by similarity. A query costs well under a
+// millisecond; rebuilding happens on the message thread whenever the bank changes.
+//
+// The index only depends on what is in the bank, so instances with the same bank
+// share a single copy of it, built by whichever of them got there first. Banks are
+// told apart by their file's path, size and modification time, never by reading
+// them through.
+class OfflinePatchModel
+{
+public:
+    void rebuild (const PresetBank& bank, const PatchData& defaults);
+
+    // Fills params with a complete patch as "PARAM": value pairs; false if nothing matched
+    bool infer (const juce::String& prompt, juce::var& params) const;
+
+    int getNumEntries() const;
+
+    static constexpr int numNeighbours { 3 };
+    static constexpr int numTables { 4 };
+    static constexpr int numBits { 5 };
+    static constexpr float blendTemperature { 0.08f };
+
+private:
+    struct Entry
+    {
+        PromptEmbedding::Vector embedding;
+        PatchData patch;
+    };
+
+    struct Match
+    {
+        int entry;
+        float similarity;
+    };
+
+    using Buckets = std::unordered_map<juce::uint32, std::vector<int>>;
+
+    struct Index
+    {
+        std::vector<Entry> entries;
+        std::array<Buckets, numTables> buckets;
+    };
+
+    static juce::String getContentKey (const PresetBank& bank, const PatchData& defaults);
+    static std::shared_ptr<const Index> build (const PresetBank& bank, const PatchData& defaults);
+    static juce::uint32 getSignature (const int table, const PromptEmbedding::Vector& v);
+    static void findNeighbours (const Index& index, const PromptEmbedding::Vector& query, std::vector<Match>& matches);
+    static void addArchetypes (const PatchData& defaults, std::vector<Entry>& entries);
+
+    std::shared_ptr<const Index> getIndex() const;
+
+    juce::CriticalSection lock;
+    std::shared_ptr<const Index> index;
+};
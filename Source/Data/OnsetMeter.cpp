@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    OnsetMeter.cpp
+    Created: 19 Oct 2026 4:41:06am
+
+  ==============================================================================
+*/
+
+#include "OnsetMeter.h"
+
+int OnsetMeter::Histogram::getPercentile (const double fraction) const
+{
+    const auto target = (juce::uint32) juce::jmax (1, (int) std::ceil (fraction * numOnsets));
+    juce::uint32 total = 0;
+    
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        total += counts[(size_t) bin];
+        
+        if (total >= target)
+            return bin;
+    }
+    
+    return maximum;
+}
+
+void OnsetMeter::prepare (const double newSampleRate)
+{
+    sampleRate.store (newSampleRate, std::memory_order_relaxed);
+    expirySamples = (juce::int64) (newSampleRate * expiryTime);
+    numWaiting = 0;
+    numMissed.store (0, std::memory_order_relaxed);
+    
+    for (auto& band : bands)
+    {
+        band.numOnsets.store (0, std::memory_order_relaxed);
+        
+        for (auto& count : band.counts)
+            count.store (0, std::memory_order_relaxed);
+        
+        band.minimum.store (0, std::memory_order_relaxed);
+        band.maximum.store (0, std::memory_order_relaxed);
+        band.sum.store (0, std::memory_order_relaxed);
+        band.sumOfSquares.store (0, std::memory_order_relaxed);
+    }
+}
+
+int OnsetMeter::getBandForBlockSize (const int blockSize)
+{
+    int band = 0;
+    
+    for (int limit = 32; blockSize > limit && band < numBlockSizeBands - 1; limit *= 2)
+        ++band;
+    
+    return band;
+}
+
+void OnsetMeter::noteOn (const int noteNumber, const juce::int64 position, const int blockSize)
+{
+    // Still waiting after a second means no voice ever sounded it. A full list gives up its oldest
+    int numExpired = 0;
+    
+    while (numExpired < numWaiting && position - waiting[(size_t) numExpired].position > expirySamples)
+        ++numExpired;
+    
+    if (numWaiting == maxWaiting && numExpired == 0)
+        numExpired = 1;
+    
+    if (numExpired > 0)
+    {
+        std::copy (waiting.begin() + numExpired, waiting.begin() + numWaiting, waiting.begin());
+        numWaiting -= numExpired;
+        
+        for (int i = 0; i < numExpired; ++i)
+            miss();
+    }
+    
+    waiting[(size_t) numWaiting++] = { noteNumber, getBandForBlockSize (blockSize), position };
+}
+
+void OnsetMeter::noteSounded (const int noteNumber, const juce::int64 position)
+{
+    for (int i = 0; i < numWaiting; ++i)
+    {
+        const auto note = waiting[(size_t) i];
+        
+        if (note.noteNumber != noteNumber)
+            continue;
+        
+        std::copy (waiting.begin() + i + 1, waiting.begin() + numWaiting, waiting.begin() + i);
+        --numWaiting;
+        
+        add (note.band, (int) juce::jlimit<juce::int64> (std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), position - note.position));
+        return;
+    }
+}
+
+void OnsetMeter::miss()
+{
+    numMissed.store (numMissed.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void OnsetMeter::add (const int bandIndex, const int latency)
+{
+    auto& band = bands[(size_t) bandIndex];
+    auto& count = band.counts[(size_t) juce::jlimit (0, numBins - 1, latency)];
+    count.store (count.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    
+    const auto numOnsets = band.numOnsets.load (std::memory_order_relaxed);
+    band.minimum.store (numOnsets == 0 ? latency : juce::jmin (latency, band.minimum.load (std::memory_order_relaxed)), std::memory_order_relaxed);
+    band.maximum.store (numOnsets == 0 ? latency : juce::jmax (latency, band.maximum.load (std::memory_order_relaxed)), std::memory_order_relaxed);
+    band.sum.store (band.sum.load (std::memory_order_relaxed) + latency, std::memory_order_relaxed);
+    band.sumOfSquares.store (band.sumOfSquares.load (std::memory_order_relaxed) + (juce::int64) latency * latency, std::memory_order_relaxed);
+    band.numOnsets.store (numOnsets + 1, std::memory_order_relaxed);
+}
+
+bool OnsetMeter::getHistogram (const int bandIndex, Histogram& histogram) const
+{
+    const auto& band = bands[(size_t) bandIndex];
+    histogram.numOnsets = band.numOnsets.load (std::memory_order_relaxed);
+    histogram.maximumBlockSize = bandIndex < numBlockSizeBands - 1 ? 32 << bandIndex : 0;
+    
+    if (histogram.numOnsets == 0)
+        return false;
+    
+    for (int bin = 0; bin < numBins; ++bin)
+        histogram.counts[(size_t) bin] = band.counts[(size_t) bin].load (std::memory_order_relaxed);
+    
+    histogram.minimum = band.minimum.load (std::memory_order_relaxed);
+    histogram.maximum = band.maximum.load (std::memory_order_relaxed);
+    
+    const auto sum = (double) band.sum.load (std::memory_order_relaxed);
+    const auto sumOfSquares = (double) band.sumOfSquares.load (std::memory_order_relaxed);
+    histogram.mean = sum / histogram.numOnsets;
+    histogram.deviation = std::sqrt (juce::jmax (0.0, sumOfSquares / histogram.numOnsets - histogram.mean * histogram.mean));
+    return true;
+}
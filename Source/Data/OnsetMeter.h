@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    OnsetMeter.h
+    Created: 19 Oct 2026 4:41:06am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// How long after its note-on a note is first heard, and how much that wanders.
+//
+// processBlock stamps each note-on with its sample in the host's timeline as
+// it arrives, and the size of the block it came in. Voices report the sample
+// their output first rises above silence at; the processor moves that into
+// the host's timeline and the meter pairs it with the oldest note-on still
+// waiting for the same note. The gap between them, in samples, goes into a
+// histogram for the block size the note-on came in, sizes being grouped by
+// powers of two so hosts that split their blocks unevenly stay comparable.
+//
+// Only the audio thread writes, so the counts are plain relaxed stores; a
+// reader may see a histogram part way through an update but never holds the
+// audio thread up.
+class OnsetMeter
+{
+public:
+    // Block sizes up to 32, up to 64, ... up to 8192, then everything larger
+    static constexpr int numBlockSizeBands { 10 };
+    
+    // One sample per bin; the last also holds everything later
+    static constexpr int numBins { 256 };
+    
+    // -120 dB; a voice's first sample above this is where its note was heard
+    static constexpr float silenceThreshold { 1.0e-6f };
+    
+    // A copy of one band's histogram
+    struct Histogram
+    {
+        int maximumBlockSize { 0 };     // 0 for the last band, which has no upper limit
+        std::array<juce::uint32, numBins> counts {};
+        int numOnsets { 0 };
+        int minimum { 0 };
+        int maximum { 0 };
+        double mean { 0.0 };
+        double deviation { 0.0 };       // the jitter: standard deviation of the latency
+        
+        // Latency in samples that fraction of the onsets came at or before
+        int getPercentile (const double fraction) const;
+    };
+    
+    // Audio thread, or serialised with it as prepareToPlay is. Starts the histograms over
+    void prepare (const double newSampleRate);
+    void noteOn (const int noteNumber, const juce::int64 position, const int blockSize);
+    void noteSounded (const int noteNumber, const juce::int64 position);
+    
+    // Any thread
+    double getSampleRate() const { return sampleRate.load (std::memory_order_relaxed); }
+    bool getHistogram (const int band, Histogram& histogram) const;
+    
+    // Note-ons that never sounded within a second, or were pushed out by newer ones
+    int getNumMissed() const { return numMissed.load (std::memory_order_relaxed); }
+    
+    static int getBandForBlockSize (const int blockSize);
+    
+private:
+    static constexpr int maxWaiting { 64 };
+    static constexpr double expiryTime { 1.0 };
+    
+    struct Waiting
+    {
+        int noteNumber;
+        int band;
+        juce::int64 position;
+    };
+    
+    struct Band
+    {
+        std::array<std::atomic<juce::uint32>, numBins> counts {};
+        std::atomic<int> numOnsets { 0 };
+        std::atomic<int> minimum { 0 };
+        std::atomic<int> maximum { 0 };
+        std::atomic<juce::int64> sum { 0 };
+        std::atomic<juce::int64> sumOfSquares { 0 };
+    };
+    
+    void miss();
+    void add (const int band, const int latency);
+    
+    // Audio thread, oldest first
+    std::array<Waiting, maxWaiting> waiting {};
+    int numWaiting { 0 };
+    juce::int64 expirySamples { 44100 };
+    
+    std::array<Band, numBlockSizeBands> bands;
+    std::atomic<double> sampleRate { 44100.0 };
+    std::atomic<int> numMissed { 0 };
+};
@@ -10,6 +10,11 @@
 
 #include "OscData.h"
 
+OscData::OscData()
+{
+    initialise ([this] (float x) { return generate (x); });
+}
+
 void OscData::prepareToPlay (double sampleRate, int samplesPerBlock, int outputChannels)
 {
     resetAll();
@@ -21,38 +26,31 @@ void OscData::prepareToPlay (double sampleRate, int samplesPerBlock, int outputC
     
     prepare (spec);
     fmOsc.prepare (spec);
-    gain.prepare (spec);    
+    gain.reset (rampLength);
+    fmDepth.reset (rampLength);
 }
 
-void OscData::setType (const int oscSelection)
+void OscData::setType (const int oscSelection, const int fadeSamples)
 {
-    switch (oscSelection)
+    if (oscSelection == waveType)
+        return;
+    
+    if (! juce::isPositiveAndBelow (oscSelection, 3))
     {
-        // Sine
-        case 0:
-            initialise ([](float x) { return std::sin (x); });
-            break;
-            
-        // Saw
-        case 1:
-            initialise ([] (float x) { return x / juce::MathConstants<float>::pi; });
-            break;
-          
-        // Square
-        case 2:
-            initialise ([] (float x) { return x < 0.0f ? -1.0f : 1.0f; });
-            break;
-            
-        default:
-            // You shouldn't be here!
-            jassertfalse;
-            break;
+        // You shouldn't be here!
+        jassertfalse;
+        return;
     }
+    
+    previousWaveType = waveType;
+    waveType = oscSelection;
+    fadeLength = juce::jmax (1, fadeSamples);
+    fadeSamplesRemaining = fadeLength;
 }
 
 void OscData::setGain (const float levelInDecibels)
 {
-    gain.setGainDecibels (levelInDecibels);
+    gain.setTargetValue (juce::Decibels::decibelsToGain (levelInDecibels));
 }
 
 void OscData::setOscPitch (const int pitch)
@@ -70,27 +68,25 @@ void OscData::setFreq (const int midiNoteNumber)
 
 void OscData::setFmOsc (const float freq, const float depth)
 {
-    fmDepth = depth;
+    fmDepth.setTargetValue (depth);
     fmOsc.setFrequency (freq);
     setFrequency (juce::MidiMessage::getMidiNoteInHertz ((lastMidiNote + lastPitch) + fmModulator));
 }
 
-void OscData::renderNextBlock (juce::dsp::AudioBlock<float>& audioBlock)
-{
-    jassert (audioBlock.getNumSamples() > 0);
-    process (juce::dsp::ProcessContextReplacing<float> (audioBlock));
-    gain.process (juce::dsp::ProcessContextReplacing<float> (audioBlock));
-}
-
 float OscData::processNextSample (float input)
 {
-    fmModulator = fmOsc.processSample (input) * fmDepth;
-    return gain.processSample (processSample (input));
+    fmModulator = fmOsc.processSample (input) * fmDepth.getNextValue();
+    const auto output = processSample (input);
+    
+    if (fadeSamplesRemaining > 0)
+        --fadeSamplesRemaining;
+    
+    return output;
 }
 
-void OscData::setParams (const int oscChoice, const float oscGain, const int oscPitch, const float fmFreq, const float fmDepth)
+void OscData::setParams (const int oscChoice, const float oscGain, const int oscPitch, const float fmFreq, const float fmDepth, const int fadeSamples)
 {
-    setType (oscChoice);
+    setType (oscChoice, fadeSamples);
     setGain (oscGain);
     setOscPitch (oscPitch);
     setFmOsc (fmFreq, fmDepth);
@@ -100,5 +96,44 @@ void OscData::resetAll()
 {
     reset();
     fmOsc.reset();
-    gain.reset();
+    fadeSamplesRemaining = 0;
+}
+
+void OscData::settle()
+{
+    fadeSamplesRemaining = 0;
+    gain.setCurrentAndTargetValue (gain.getTargetValue());
+    fmDepth.setCurrentAndTargetValue (fmDepth.getTargetValue());
+}
+
+float OscData::generate (float x)
+{
+    const auto current = getWaveform (waveType, x);
+    
+    if (fadeSamplesRemaining <= 0)
+        return current;
+    
+    const auto fade = (float) fadeSamplesRemaining / (float) fadeLength;
+    return current + (getWaveform (previousWaveType, x) - current) * fade;
+}
+
+float OscData::getWaveform (const int type, float x) const
+{
+    switch (type)
+    {
+        // Sine
+        case 0:
+            return sine (x);
+            
+        // Saw
+        case 1:
+            return x / juce::MathConstants<float>::pi;
+          
+        // Square
+        case 2:
+            return x < 0.0f ? -1.0f : 1.0f;
+            
+        default:
+            return 0.0f;
+    }
 }
@@ -15,24 +15,49 @@
 class OscData : public juce::dsp::Oscillator<float>
 {
 public:
+    OscData();
     void prepareToPlay (double sampleRate, int samplesPerBlock, int outputChannels);
-    void setType (const int oscSelection);
+    void setType (const int oscSelection, const int fadeSamples);
     void setGain (const float levelInDecibels);
     void setOscPitch (const int pitch);
     void setFreq (const int midiNoteNumber);
     void setFmOsc (const float freq, const float depth);
-    void renderNextBlock (juce::dsp::AudioBlock<float>& audioBlock);
     float processNextSample (float input);
-    void setParams (const int oscChoice, const float oscGain, const int oscPitch, const float fmFreq, const float fmDepth);
+    void setParams (const int oscChoice, const float oscGain, const int oscPitch, const float fmFreq, const float fmDepth, const int fadeSamples);
+    
+    // A polynomial sine instead of std::sin, for when CPU is short
+    void setFastSine (const bool shouldUseFastSine) { fastSine = shouldUseFastSine; }
+    
+    // Never applied here: the voice folds it into its mix, a sample at a time
+    float getNextGain() { return gain.getNextValue(); }
     void resetAll();
+    
+    // Jumps to the waveform, gain and FM depth last set, with no fade or ramp still to come
+    void settle();
+    
+    // Parameters arrive once per control-rate step; gain and FM depth ramp to each new
+    // value over one, so they move smoothly instead of stepping. Pitch needs nothing
+    // extra: the oscillators already glide their frequency
+    static constexpr int rampLength { 32 };
 
 private:
-    juce::dsp::Oscillator<float> fmOsc { [](float x) { return std::sin (x); }};
-    juce::dsp::Gain<float> gain;
+    float generate (float x);
+    float getWaveform (const int type, float x) const;
+    float sine (float x) const { return fastSine ? juce::dsp::FastMathApproximations::sin (x) : std::sin (x); }
+    
+    juce::dsp::Oscillator<float> fmOsc { [this] (float x) { return sine (x); }};
+    bool fastSine { false };
+    juce::SmoothedValue<float> gain { 1.0f };
     int lastPitch { 0 };
     int lastMidiNote { 0 };
-    float fmDepth { 0.0f };
+    juce::SmoothedValue<float> fmDepth { 0.0f };
     float fmModulator { 0.0f };
+    
+    // Waveform changes fade from the previous shape at the same phase, so they never click
+    int waveType { 0 };
+    int previousWaveType { 0 };
+    int fadeLength { 0 };
+    int fadeSamplesRemaining { 0 };
 };
 
 // return std::sin (x); //Sine Wave
@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    ParallelVoiceRenderer.cpp
+    Created: 18 Oct 2026 11:58:06pm
+
+  ==============================================================================
+*/
+
+#include "ParallelVoiceRenderer.h"
+#include "TraceRecorder.h"
+
+ParallelVoiceRenderer::ParallelVoiceRenderer()
+: threads ("Voice renderer", [this] (const int index) { renderJob (index); })
+{
+}
+
+void ParallelVoiceRenderer::prepare (const int maxVoices, const int numChannels, const int maximumBlockSize)
+{
+    voiceBuffers.resize ((size_t) maxVoices);
+    
+    for (auto& voiceBuffer : voiceBuffers)
+        voiceBuffer.setSize (numChannels, maximumBlockSize);
+    
+    jobs.reserve ((size_t) maxVoices);
+    
+    // The calling thread takes a share of the voices too
+    threads.start (juce::jmin (maxVoices, juce::SystemStats::getNumCpus()) - 1);
+}
+
+void ParallelVoiceRenderer::release()
+{
+    threads.stop();
+}
+
+void ParallelVoiceRenderer::render (juce::SynthesiserVoice* const* voices, const int numVoices,
+                                    juce::AudioBuffer<float>& buffer, const int startSample, const int numSamples)
+{
+    jassert (numVoices <= (int) voiceBuffers.size());
+    jassert (voiceBuffers.empty() || startSample + numSamples <= voiceBuffers.front().getNumSamples());
+    
+    jobs.clear();
+    
+    for (int i = 0; i < numVoices; ++i)
+        if (voices[i]->isVoiceActive())
+            jobs.push_back (voices[i]);
+    
+    if (jobs.empty())
+        return;
+    
+    jobStart = startSample;
+    jobSamples = numSamples;
+    threads.run ((int) jobs.size());
+    
+    const auto numChannels = juce::jmin (buffer.getNumChannels(), voiceBuffers.front().getNumChannels());
+    
+    for (size_t i = 0; i < jobs.size(); ++i)
+        for (int ch = 0; ch < numChannels; ++ch)
+            buffer.addFrom (ch, startSample, voiceBuffers[i], ch, startSample, numSamples);
+}
+
+void ParallelVoiceRenderer::renderJob (const int index)
+{
+    TAPSYNTH_TRACE_SCOPE ("Voice job");
+    auto& voiceBuffer = voiceBuffers[(size_t) index];
+    voiceBuffer.clear (jobStart, jobSamples);
+    jobs[(size_t) index]->renderNextBlock (voiceBuffer, jobStart, jobSamples);
+}
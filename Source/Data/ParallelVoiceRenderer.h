@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    ParallelVoiceRenderer.h
+    Created: 18 Oct 2026 11:58:06pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "JobThreads.h"
+
+// Renders a synth's active voices side by side on several threads, for offline bounces.
+//
+// Each active voice is a job: the calling thread and a few parked workers take
+// jobs until none are left, every voice rendering into a buffer of its own at
+// the same position it has in the output, so the LFO steps and onset samples
+// it reads and reports line up with the span being rendered.
+// The calling thread then mixes those buffers into the output in voice order,
+// so the result doesn't depend on which thread rendered what.
+//
+// Workers sleep between renders, so they can be started ahead of a bounce. Only
+// render through them non-realtime: the audio thread blocks until the slowest
+// voice is done.
+class ParallelVoiceRenderer
+{
+public:
+    ParallelVoiceRenderer();
+    
+    // Starts the workers, if they aren't running yet, and sizes the voice buffers to hold
+    // as much as the buffers rendered into
+    void prepare (const int maxVoices, const int numChannels, const int maximumBlockSize);
+    
+    // Stops the workers
+    void release();
+    
+    // Adds the next numSamples of every active voice into buffer, as juce::Synthesiser would
+    void render (juce::SynthesiserVoice* const* voices, const int numVoices,
+                 juce::AudioBuffer<float>& buffer, const int startSample, const int numSamples);
+    
+private:
+    void renderJob (const int index);
+    
+    std::vector<juce::AudioBuffer<float>> voiceBuffers;
+    std::vector<juce::SynthesiserVoice*> jobs;
+    int jobStart { 0 };
+    int jobSamples { 0 };
+    JobThreads threads;
+};
@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    PatchData.cpp
+    Created: 18 Oct 2026 10:04:12am
+
+  ==============================================================================
+*/
+
+#include "PatchData.h"
+
+// Order matters: snapshots index into this list through PatchData::Parameter.
+// Append new parameters at the end of both.
+const std::array<const char*, PatchData::numParameters> PatchData::parameterIds
+{
+    "OSC1", "OSC2",
+    "OSC1GAIN", "OSC2GAIN",
+    "OSC1PITCH", "OSC2PITCH",
+    "OSC1FMFREQ", "OSC2FMFREQ",
+    "OSC1FMDEPTH", "OSC2FMDEPTH",
+    "LFO1FREQ", "LFO1DEPTH",
+    "FILTERTYPE", "FILTERCUTOFF", "FILTERRESONANCE",
+    "ATTACK", "DECAY", "SUSTAIN", "RELEASE",
+    "FILTERADSRDEPTH", "FILTERATTACK", "FILTERDECAY", "FILTERSUSTAIN", "FILTERRELEASE",
+    "REVERBSIZE", "REVERBWIDTH", "REVERBDAMPING", "REVERBDRY", "REVERBWET", "REVERBFREEZE",
+    "LFO1MODE"
+};
+
+int PatchData::getParameterIndex (const juce::String& paramId)
+{
+    for (int i = 0; i < numParameters; ++i)
+    {
+        if (paramId == parameterIds[(size_t) i])
+            return i;
+    }
+    
+    return -1;
+}
+
+juce::uint32 PatchData::getParameterHash (const int index)
+{
+    // FNV-1a over the parameter id, so stored data survives reordering of the list
+    juce::uint32 hash = 2166136261u;
+    
+    for (auto* c = parameterIds[(size_t) index]; *c != 0; ++c)
+    {
+        hash ^= (juce::uint8) *c;
+        hash *= 16777619u;
+    }
+    
+    return hash;
+}
+
+int PatchData::getParameterIndexForHash (const juce::uint32 hash)
+{
+    for (int i = 0; i < numParameters; ++i)
+    {
+        if (getParameterHash (i) == hash)
+            return i;
+    }
+    
+    return -1;
+}
+
+bool PatchData::isDiscrete (const int index)
+{
+    // Choices can't be interpolated; anything switching them crossfades the audio instead
+    return index == osc1Choice || index == osc2Choice || index == filterType || index == lfo1Mode;
+}
+
+void PatchData::setToDefaults (juce::AudioProcessorValueTreeState& apvts)
+{
+    for (int i = 0; i < numParameters; ++i)
+    {
+        if (auto* param = apvts.getParameter (parameterIds[(size_t) i]))
+            values[(size_t) i] = param->convertFrom0to1 (param->getDefaultValue());
+    }
+}
+
+void PatchData::captureFrom (juce::AudioProcessorValueTreeState& apvts)
+{
+    for (int i = 0; i < numParameters; ++i)
+    {
+        if (auto* value = apvts.getRawParameterValue (parameterIds[(size_t) i]))
+            values[(size_t) i] = value->load();
+    }
+}
+
+void PatchData::applyTo (juce::AudioProcessorValueTreeState& apvts) const
+{
+    for (int i = 0; i < numParameters; ++i)
+    {
+        if (auto* param = apvts.getParameter (parameterIds[(size_t) i]))
+        {
+            const auto normalised = param->convertTo0to1 (values[(size_t) i]);
+            
+            // Skipping unchanged values keeps listeners and the host quiet
+            if (param->getValue() != normalised)
+                param->setValueNotifyingHost (normalised);
+        }
+    }
+}
+
+juce::var PatchData::toJson() const
+{
+    auto* obj = new juce::DynamicObject();
+    juce::var json (obj);
+    
+    for (int i = 0; i < numParameters; ++i)
+        obj->setProperty (parameterIds[(size_t) i], values[(size_t) i]);
+    
+    return json;
+}
@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    PatchData.h
+    Created: 18 Oct 2026 10:04:12am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// A flat snapshot of every apvts parameter, stored as real (denormalised) values
+// in a fixed order so it can be copied, compared and serialised without lookups.
+class PatchData
+{
+public:
+    // Indices into the snapshot, in the same order as parameterIds
+    enum Parameter
+    {
+        osc1Choice, osc2Choice,
+        osc1Gain, osc2Gain,
+        osc1Pitch, osc2Pitch,
+        osc1FmFreq, osc2FmFreq,
+        osc1FmDepth, osc2FmDepth,
+        lfo1Freq, lfo1Depth,
+        filterType, filterCutoff, filterResonance,
+        attack, decay, sustain, release,
+        filterAdsrDepth, filterAttack, filterDecay, filterSustain, filterRelease,
+        reverbSize, reverbWidth, reverbDamping, reverbDry, reverbWet, reverbFreeze,
+        lfo1Mode,
+        numParameters
+    };
+
+    static const std::array<const char*, numParameters> parameterIds;
+
+    static int getParameterIndex (const juce::String& paramId);
+    static juce::uint32 getParameterHash (const int index);
+    static int getParameterIndexForHash (const juce::uint32 hash);
+    static bool isDiscrete (const int index);
+
+    void setToDefaults (juce::AudioProcessorValueTreeState& apvts);
+    void captureFrom (juce::AudioProcessorValueTreeState& apvts);
+    void applyTo (juce::AudioProcessorValueTreeState& apvts) const;
+
+    // Every parameter as "PARAM": value, as applyParametersFromJson accepts
+    juce::var toJson() const;
+
+    float getValue (const int index) const { return values[(size_t) index]; }
+    void setValue (const int index, const float value) { values[(size_t) index] = value; }
+    std::array<float, numParameters>& getValues() { return values; }
+    const std::array<float, numParameters>& getValues() const { return values; }
+
+    bool operator== (const PatchData& other) const { return values == other.values; }
+    bool operator!= (const PatchData& other) const { return values != other.values; }
+
+private:
+    std::array<float, numParameters> values {};
+};
@@ -0,0 +1,30 @@
+/*
+  ==============================================================================
+
+    PatchQueue.cpp
+    Created: 18 Oct 2026 1:16:55pm
+
+  ==============================================================================
+*/
+
+#include "PatchQueue.h"
+
+void PatchQueue::push (const PatchData& patch, const float morphSeconds)
+{
+    const juce::ScopedLock sl (writerLock);
+    
+    slots[(size_t) back] = patch;
+    morphTimes[(size_t) back] = morphSeconds;
+    back = middle.exchange (back | freshBit, std::memory_order_acq_rel) & indexMask;
+}
+
+bool PatchQueue::pull (PatchData& patch, float& morphSeconds)
+{
+    if ((middle.load (std::memory_order_acquire) & freshBit) == 0)
+        return false;
+    
+    front = middle.exchange (front, std::memory_order_acq_rel) & indexMask;
+    patch = slots[(size_t) front];
+    morphSeconds = morphTimes[(size_t) front];
+    return true;
+}
@@ -0,0 +1,40 @@
+/*
+  ==============================================================================
+
+    PatchQueue.h
+    Created: 18 Oct 2026 1:16:55pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PatchData.h"
+
+// Lock-free triple buffer handing whole patches to the audio thread.
+//
+// Writers fill the back slot and swap it with the middle one; the audio thread
+// swaps the middle slot into the front only when a new patch is waiting. The
+// reader never blocks and always sees a complete patch, never a mix of two.
+// Each patch carries the time it should morph in over, so the two can't mix either.
+class PatchQueue
+{
+public:
+    // Any non-audio thread; writers are serialised against each other
+    void push (const PatchData& patch, const float morphSeconds);
+    
+    // Audio thread only; returns false if nothing new was pushed since the last pull
+    bool pull (PatchData& patch, float& morphSeconds);
+
+private:
+    static constexpr int indexMask { 0x3 };
+    static constexpr int freshBit { 0x4 };
+
+    std::array<PatchData, 3> slots;
+    std::array<float, 3> morphTimes {};
+    std::atomic<int> middle { 1 };
+    int back { 0 };
+    int front { 2 };
+    juce::CriticalSection writerLock;
+};
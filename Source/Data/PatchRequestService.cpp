@@ -0,0 +1,659 @@
+/*
+  ==============================================================================
+
+    PatchRequestService.cpp
+    Created: 18 Oct 2026 4:47:13pm
+
+  ==============================================================================
+*/
+
+#include "PatchRequestService.h"
+#include "TraceRecorder.h"
+
+PatchRequestService::PatchRequestService (PromptCache& cache, const OfflinePatchModel& model, ApplyCallback onApply, CaptureCallback onCapture)
+: juce::Thread ("Patch requests")
+, promptCache (cache)
+, offlineModel (model)
+, applyParams (std::move (onApply))
+, captureParams (std::move (onCapture))
+{
+}
+
+PatchRequestService::~PatchRequestService()
+{
+    cancelAll();
+    signalThreadShouldExit();
+    notify();
+    stopThread (2000);
+    cancelPendingUpdate();
+}
+
+int PatchRequestService::submit (const juce::String& prompt, const int numVariations)
+{
+    int id = 0;
+    
+    {
+        const juce::ScopedLock sl (queueLock);
+        id = nextRequestId++;
+        
+        // A new prompt supersedes everything before it, queued or in flight
+        cancelledUpTo.store (id - 1);
+        queue.clear();
+        queue.push_back ({ id, prompt, juce::jmax (0, numVariations) });
+    }
+    
+    {
+        const juce::ScopedLock sl (streamLock);
+        
+        if (activeStream != nullptr)
+            activeStream->cancel();
+    }
+    
+    if (! isThreadRunning())
+        startThread();
+    
+    notify();
+    return id;
+}
+
+void PatchRequestService::cancelAll()
+{
+    {
+        const juce::ScopedLock sl (queueLock);
+        cancelledUpTo.store (nextRequestId - 1);
+        queue.clear();
+    }
+    
+    {
+        const juce::ScopedLock sl (streamLock);
+        
+        if (activeStream != nullptr)
+            activeStream->cancel();
+    }
+    
+    notify();
+}
+
+juce::var PatchRequestService::sanitiseParams (const juce::var& params)
+{
+    auto* obj = params.getDynamicObject();
+    
+    if (obj == nullptr)
+        return {};
+    
+    auto* clean = new juce::DynamicObject();
+    juce::var result (clean);
+    
+    for (auto& entry : obj->getProperties())
+    {
+        const auto& value = entry.value;
+        
+        if (PatchData::getParameterIndex (entry.name.toString()) < 0)
+            continue;
+        
+        if (value.isInt() || value.isInt64() || value.isDouble() || value.isBool())
+            clean->setProperty (entry.name, value);
+        else if (value.isString() && value.toString().trim().containsOnly ("0123456789.-+eE") && value.toString().trim().isNotEmpty())
+            clean->setProperty (entry.name, value.toString().trim().getDoubleValue());
+    }
+    
+    if (clean->getProperties().size() == 0)
+        return {};
+    
+    return result;
+}
+
+juce::String PatchRequestService::getModelId()
+{
+    return "gemini-flash-latest"; // HERE HERE HERE "gemini-2.5-flash" if things go bad
+}
+
+juce::String PatchRequestService::getEndpoint (const juce::String& method)
+{
+    // TAPSYNTH_API_BASE_URL points requests at a local stand-in server, such as tapSynthTools stand-in
+    const juce::String baseUrl = juce::SystemStats::getEnvironmentVariable (
+        "TAPSYNTH_API_BASE_URL", "https://generativelanguage.googleapis.com/v1beta");
+    
+    return baseUrl + "/models/" + getModelId() + ":" + method;
+}
+
+void PatchRequestService::run()
+{
+    while (! threadShouldExit())
+    {
+        Request request;
+        
+        {
+            const juce::ScopedLock sl (queueLock);
+            
+            if (! queue.empty())
+            {
+                request = queue.front();
+                queue.pop_front();
+            }
+        }
+        
+        if (request.id == 0)
+        {
+            wait (-1);
+            continue;
+        }
+        
+        post (process (request));
+    }
+}
+
+void PatchRequestService::handleAsyncUpdate()
+{
+    std::vector<Result> results;
+    
+    {
+        const juce::ScopedLock sl (resultLock);
+        results.swap (finishedResults);
+    }
+    
+    for (const auto& result : results)
+        listeners.call ([&result] (Listener& l) { l.patchRequestFinished (result); });
+}
+
+PatchRequestService::Result PatchRequestService::process (const Request& request)
+{
+    TAPSYNTH_TRACE_SCOPE ("Prompt request");
+    Result result;
+    result.requestId = request.id;
+    result.prompt = request.prompt;
+    
+    const auto modelId = getModelId();
+    const auto wantsVariations = request.numVariations > 0;
+    
+    // Repeated prompts are answered from disk, without touching the network
+    const auto cached = wantsVariations ? juce::var() : sanitiseParams (promptCache.lookup (request.prompt, modelId));
+    
+    if (cached.isObject())
+    {
+        if (! applyUnlessCancelled (request.id, cached))
+        {
+            result.status = Status::cancelled;
+            return result;
+        }
+        
+        result.status = Status::succeeded;
+        result.params = cached;
+        result.fromCache = true;
+        return result;
+    }
+    
+    // The local answer goes out first, so there's something to hear even with no network
+    juce::var localParams;
+    
+    if (offlineModel.infer (request.prompt, localParams))
+    {
+        result.fromLocalModel = true;
+        
+        if (wantsVariations)
+        {
+            result.variations.add (localParams);
+        }
+        else if (applyUnlessCancelled (request.id, localParams))
+        {
+            result.params = localParams;
+        }
+    }
+    
+    if (! networkRefinementEnabled.load())
+    {
+        result.status = result.fromLocalModel ? Status::succeeded : Status::failed;
+        
+        if (! result.fromLocalModel)
+            result.error = "The offline model doesn't know any of the words in this prompt.";
+        
+        return result;
+    }
+    
+    for (int attempt = 0; attempt < maxAttempts; ++attempt)
+    {
+        if (attempt > 0 && ! waitForBackoff (request.id, firstBackoffMs << (attempt - 1)))
+            break;
+        
+        // A streamed answer is applied pair by pair as it arrives, on top of what is about to play now
+        const auto streaming = streamingEnabled.load() && ! wantsVariations;
+        const auto paramsBefore = streaming ? captureParams() : juce::var();
+        const auto numCandidates = juce::jmax (1, request.numVariations - (result.fromLocalModel ? 1 : 0));
+        juce::String responseBody;
+        int statusCode = 0;
+        const auto connected = streaming ? fetchStreaming (request, responseBody, statusCode, result.error)
+                                         : fetch (request, numCandidates, responseBody, statusCode, result.error);
+        
+        if (isCancelled (request.id) || threadShouldExit())
+        {
+            // Pairs streamed in before the cancel are taken back too, unless a newer request has applied since
+            if (streaming && ! threadShouldExit())
+                rollBack (request.id, paramsBefore);
+            
+            break;
+        }
+        
+        if (connected && statusCode == 200 && wantsVariations)
+        {
+            juce::Array<juce::var> variations;
+            
+            if (! parseVariations (responseBody, variations, result.error))
+                break;
+            
+            // The network's candidates lead; the local answer stays on as the last one
+            variations.addArray (result.variations);
+            variations.removeRange (request.numVariations, variations.size());
+            result.variations = variations;
+            result.status = Status::succeeded;
+            result.fromLocalModel = false;
+            result.error = {};
+            return result;
+        }
+        
+        if (connected && statusCode == 200)
+        {
+            // A malformed answer is reported rather than retried. Whatever it streamed in is taken
+            // back in one step, and a valid one goes in whole, so only validated answers stay applied
+            juce::var params;
+            const auto parsed = streaming ? parseModelText (responseBody, params, result.error)
+                                          : parseResponse (responseBody, params, result.error);
+            
+            if (! parsed)
+            {
+                if (streaming)
+                    rollBack (request.id, paramsBefore);
+                
+                break;
+            }
+            
+            promptCache.store (request.prompt, modelId, params);
+            
+            if (! applyUnlessCancelled (request.id, params))
+                break;
+            
+            result.params = params;
+            result.status = Status::succeeded;
+            result.fromLocalModel = false;
+            result.error = {};
+            return result;
+        }
+        
+        // Only connection failures, rate limiting and server errors are worth another try
+        if (connected && statusCode != 429 && statusCode < 500)
+            break;
+    }
+    
+    if (isCancelled (request.id) || threadShouldExit())
+    {
+        result.status = Status::cancelled;
+        result.error = {};
+    }
+    else
+    {
+        // Without a usable network answer, the local one that's already playing stands
+        result.status = result.fromLocalModel ? Status::succeeded : Status::failed;
+    }
+    
+    return result;
+}
+
+bool PatchRequestService::fetch (const Request& request, const int numCandidates, juce::String& responseBody, int& statusCode, juce::String& error)
+{
+    TAPSYNTH_TRACE_SCOPE ("Network fetch");
+    auto stream = createStream ("generateContent", buildRequestBody (request.prompt, numCandidates));
+    const auto connected = connect (request, *stream);
+    statusCode = stream->getStatusCode();
+    
+    if (connected)
+        responseBody = stream->readEntireStreamAsString();
+    
+    disconnect();
+    
+    if (! connected)
+        error = "Could not open network stream.";
+    else if (statusCode != 200)
+        error = "HTTP " + juce::String (statusCode) + ":\n" + responseBody;
+    
+    return connected;
+}
+
+bool PatchRequestService::fetchStreaming (const Request& request, juce::String& modelText, int& statusCode, juce::String& error)
+{
+    TAPSYNTH_TRACE_SCOPE ("Network stream");
+    auto stream = createStream ("streamGenerateContent?alt=sse", buildRequestBody (request.prompt));
+    const auto connected = connect (request, *stream);
+    statusCode = stream->getStatusCode();
+    
+    if (! connected)
+    {
+        disconnect();
+        error = "Could not open network stream.";
+        return false;
+    }
+    
+    if (statusCode != 200)
+    {
+        const auto responseBody = stream->readEntireStreamAsString();
+        disconnect();
+        error = "HTTP " + juce::String (statusCode) + ":\n" + responseBody;
+        return true;
+    }
+    
+    StreamingPatchParser parser;
+    juce::DynamicObject::Ptr batch = new juce::DynamicObject();
+    
+    const auto addPair = [&batch] (const juce::String& paramId, const double value)
+    {
+        if (PatchData::getParameterIndex (paramId) >= 0 && std::isfinite (value))
+            batch->setProperty (paramId, value);
+    };
+    
+    // Each server-sent event carries a complete response object holding the next slice of text
+    const auto handleLine = [&] (const juce::MemoryOutputStream& line)
+    {
+        const auto text = juce::String::fromUTF8 (static_cast<const char*> (line.getData()), (int) line.getDataSize()).trimEnd();
+        
+        if (! text.startsWith ("data:"))
+            return;
+        
+        const auto slice = getModelText (juce::JSON::parse (text.substring (5).trim()));
+        modelText += slice;
+        parser.feed (slice, addPair);
+    };
+    
+    // Whatever completed within one network read goes out as one update
+    const auto applyBatch = [&]
+    {
+        if (batch->getProperties().isEmpty() || ! applyUnlessCancelled (request.id, juce::var (batch.get())))
+            return;
+        
+        batch = new juce::DynamicObject();
+    };
+    
+    juce::MemoryOutputStream line;
+    char buffer[512];
+    
+    while (! stream->isExhausted() && ! isCancelled (request.id) && ! threadShouldExit())
+    {
+        const auto numRead = stream->read (buffer, (int) sizeof (buffer));
+        
+        if (numRead <= 0)
+            break;
+        
+        for (int i = 0; i < numRead; ++i)
+        {
+            if (buffer[i] == '\n')
+            {
+                handleLine (line);
+                line.reset();
+            }
+            else
+            {
+                line.writeByte (buffer[i]);
+            }
+        }
+        
+        applyBatch();
+    }
+    
+    handleLine (line);
+    parser.finish (addPair);
+    applyBatch();
+    
+    disconnect();
+    return true;
+}
+
+std::unique_ptr<juce::WebInputStream> PatchRequestService::createStream (const juce::String& method, const juce::String& body) const
+{
+    const juce::String apiKey = "";
+    
+    juce::String headers;
+    headers << "Content-Type: application/json\r\n";
+    headers << "x-goog-api-key: " << apiKey << "\r\n";
+    
+    juce::URL url (getEndpoint (method));
+    auto stream = std::make_unique<juce::WebInputStream> (url.withPOSTData (body), true);
+    stream->withExtraHeaders (headers)
+           .withConnectionTimeout (connectionTimeoutMs)
+           .withNumRedirectsToFollow (2);
+    
+    return stream;
+}
+
+bool PatchRequestService::connect (const Request& request, juce::WebInputStream& stream)
+{
+    {
+        // Registered under the lock, so a cancel can never miss a stream that is about to connect
+        const juce::ScopedLock sl (streamLock);
+        
+        if (isCancelled (request.id))
+            return false;
+        
+        activeStream = &stream;
+    }
+    
+    return stream.connect (nullptr);
+}
+
+void PatchRequestService::disconnect()
+{
+    const juce::ScopedLock sl (streamLock);
+    activeStream = nullptr;
+}
+
+bool PatchRequestService::waitForBackoff (const int requestId, const int milliseconds)
+{
+    const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32) milliseconds;
+    
+    // submit() and cancelAll() notify the thread, so a cancel cuts the wait short
+    while (! isCancelled (requestId) && ! threadShouldExit())
+    {
+        const auto now = juce::Time::getMillisecondCounter();
+        
+        if (now >= deadline)
+            return true;
+        
+        wait ((int) (deadline - now));
+    }
+    
+    return false;
+}
+
+bool PatchRequestService::isCancelled (const int requestId) const
+{
+    return requestId <= cancelledUpTo.load();
+}
+
+bool PatchRequestService::applyUnlessCancelled (const int requestId, const juce::var& params)
+{
+    // submit() and cancelAll() cancel under this lock too, so once either has returned,
+    // nothing from the requests it cancelled can reach the patch any more
+    const juce::ScopedLock sl (queueLock);
+    
+    if (isCancelled (requestId))
+        return false;
+    
+    applyParams (params);
+    lastAppliedRequestId = requestId;
+    return true;
+}
+
+bool PatchRequestService::rollBack (const int requestId, const juce::var& paramsBefore)
+{
+    // Cancelled or not, as long as what this request applied is still the latest
+    const juce::ScopedLock sl (queueLock);
+    
+    if (lastAppliedRequestId != requestId)
+        return false;
+    
+    applyParams (paramsBefore);
+    return true;
+}
+
+void PatchRequestService::post (Result result)
+{
+    {
+        const juce::ScopedLock sl (resultLock);
+        finishedResults.push_back (std::move (result));
+    }
+    
+    triggerAsyncUpdate();
+}
+
+juce::String PatchRequestService::buildRequestBody (const juce::String& prompt, const int numCandidates)
+{
+    // --- Build Gemini JSON ---
+    const juce::String jsonPrompt =
+        "You are an assistant that controls a synthesizer by returning ONLY valid JSON. "
+        "Your output will be parsed by a machine. YOU MUST FOLLOW THESE RULES:\n"
+        "\n"
+        "STRICT RULES:\n"
+        "1. Output ONLY a JSON object.\n"
+        "2. No text before or after the JSON.\n"
+        "3. No explanations, no comments, no code blocks.\n"
+        "4. Use ONLY the parameter IDs listed below.\n"
+        "5. Clamp all values inside the ranges provided.\n"
+        "6. If the user gives a musical description, convert it into sensible parameter values.\n"
+        "\n"
+        "PARAMETER DEFINITIONS:\n"
+        "CHOICE PARAMETERS (INTEGER INDEX):\n"
+        "\"OSC1\": 0=Sine, 1=Saw, 2=Square\n"
+        "\"OSC2\": 0=Sine, 1=Saw, 2=Square\n"
+        "\"FILTERTYPE\": 0=Low Pass, 1=Band Pass, 2=High Pass\n"
+        "\"LFO1MODE\": 0=Global, 1=Free, 2=Key Sync\n"
+        "\n"
+        "FLOAT PARAMETERS:\n"
+        "\"OSC1GAIN\": -40.0 to 0.2\n"
+        "\"OSC2GAIN\": -40.0 to 0.2\n"
+        "\"OSC1PITCH\": -48 to 48\n"
+        "\"OSC2PITCH\": -48 to 48\n"
+        "\"OSC1FMFREQ\": 0.0 to 1000.0\n"
+        "\"OSC2FMFREQ\": 0.0 to 1000.0\n"
+        "\"OSC1FMDEPTH\": 0.0 to 100.0\n"
+        "\"OSC2FMDEPTH\": 0.0 to 100.0\n"
+        "\"LFO1FREQ\": 0.0 to 20.0\n"
+        "\"LFO1DEPTH\": 0.0 to 10000.0\n"
+        "\"FILTERCUTOFF\": 20.0 to 20000.0\n"
+        "\"FILTERRESONANCE\": 0.1 to 2.0\n"
+        "\"ATTACK\": 0.1 to 1.0\n"
+        "\"DECAY\": 0.1 to 1.0\n"
+        "\"SUSTAIN\": 0.1 to 1.0\n"
+        "\"RELEASE\": 0.1 to 3.0\n"
+        "\"FILTERADSRDEPTH\": 0.0 to 10000.0\n"
+        "\"FILTERATTACK\": 0.0 to 1.0\n"
+        "\"FILTERDECAY\": 0.0 to 1.0\n"
+        "\"FILTERSUSTAIN\": 0.0 to 1.0\n"
+        "\"FILTERRELEASE\": 0.0 to 3.0\n"
+        "\"REVERBSIZE\": 0.0 to 1.0\n"
+        "\"REVERBWIDTH\": 0.0 to 1.0\n"
+        "<<HIDDEN>> ?? The user did not include product information\n\n"
+        "\"REVERBDAMPING\": 0.0 to 1.0\n"
+        "\"REVERBDRY\": 0.0 to 1.0\n"
+        "\"REVERBWET\": 0.0 to 1.0\n"
+        "\"REVERBFREEZE\": 0.0 to 1.0\n"
+        "\n"
+        "OUTPUT FORMAT:\n"
+        "Return ONLY something like this:\n"
+        "{\n"
+        "  \"OSC1\": 1,\n"
+        "  \"OSC2\": 0,\n"
+        "  \"OSC1GAIN\": -12.5,\n"
+        "  \"OSC2GAIN\": -9.0,\n"
+        "  \"FILTERCUTOFF\": 645.0,\n"
+        "  \"ATTACK\": 0.2,\n"
+        "  \"REVERBWET\": 0.35\n"
+        "}\n"
+        "\n"
+        "USER REQUEST:\n" +
+        prompt;
+
+    juce::DynamicObject* textObj = new juce::DynamicObject();
+    textObj->setProperty("text", jsonPrompt);
+
+    juce::DynamicObject* partObj = new juce::DynamicObject();
+    partObj->setProperty("parts", juce::Array<juce::var>{ juce::var(textObj) });
+
+    juce::Array<juce::var> contentsArr;
+    contentsArr.add(juce::var(partObj));
+
+    juce::DynamicObject* rootObj = new juce::DynamicObject();
+    rootObj->setProperty("contents", contentsArr);
+
+    if (numCandidates > 1)
+    {
+        juce::DynamicObject* configObj = new juce::DynamicObject();
+        configObj->setProperty("candidateCount", numCandidates);
+        rootObj->setProperty("generationConfig", juce::var(configObj));
+    }
+
+    return juce::JSON::toString(juce::var(rootObj));
+}
+
+bool PatchRequestService::parseResponse (const juce::String& responseBody, juce::var& params, juce::String& error)
+{
+    const auto text = getModelText (juce::JSON::parse (responseBody));
+    
+    if (text.isEmpty())
+    {
+        error = "Unexpected response:\n" + responseBody;
+        return false;
+    }
+    
+    return parseModelText (text, params, error);
+}
+
+bool PatchRequestService::parseVariations (const juce::String& responseBody, juce::Array<juce::var>& variations, juce::String& error)
+{
+    const auto response = juce::JSON::parse (responseBody);
+    const auto numCandidates = response.getProperty ("candidates", {}).size();
+    
+    // Candidates that don't parse are dropped; only an answer with none at all is an error
+    for (int i = 0; i < numCandidates; ++i)
+    {
+        juce::var params;
+        
+        if (parseModelText (getModelText (response, i), params, error))
+            variations.add (params);
+    }
+    
+    if (variations.isEmpty())
+    {
+        error = "Unexpected response:\n" + responseBody;
+        return false;
+    }
+    
+    error = {};
+    return true;
+}
+
+bool PatchRequestService::parseModelText (const juce::String& text, juce::var& params, juce::String& error)
+{
+    // Models sometimes wrap the object in a code fence despite being told not to
+    const auto jsonParams = text.fromFirstOccurrenceOf ("{", true, false).upToLastOccurrenceOf ("}", true, false);
+    
+    params = sanitiseParams (juce::JSON::parse (jsonParams));
+    
+    if (! params.isObject())
+    {
+        error = "Returned text was not valid JSON:\n" + text;
+        return false;
+    }
+    
+    return true;
+}
+
+juce::String PatchRequestService::getModelText (const juce::var& response, const int candidate)
+{
+    const auto candidates = response.getProperty ("candidates", {});
+    
+    if (! candidates.isArray() || candidate >= candidates.size())
+        return {};
+    
+    const auto parts = candidates[candidate].getProperty ("content", {}).getProperty ("parts", {});
+    
+    if (! parts.isArray() || parts.getArray()->isEmpty())
+        return {};
+    
+    return parts[0].getProperty ("text", {}).toString();
+}
@@ -0,0 +1,144 @@
+/*
+  ==============================================================================
+
+    PatchRequestService.h
+    Created: 18 Oct 2026 4:47:13pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PatchData.h"
+#include "PromptCache.h"
+#include "StreamingPatchParser.h"
+#include "OfflinePatchModel.h"
+
+// Background service turning prompts into patches.
+//
+// One worker thread, owned by the processor, serves the latest prompt. A new
+// prompt supersedes everything queued or in flight before it. Network calls can
+// be cancelled, fail over with exponential backoff, and are parsed and
+// validated on the worker. Only listener callbacks run on the message thread.
+//
+// By default answers are streamed, and each parameter is applied as soon as its
+// value has arrived instead of waiting for the whole object. The whole answer is
+// still validated once it is complete: a valid one is then applied again as one
+// patch, and a malformed or truncated one takes back everything it had applied.
+// So does one cancelled halfway, unless a newer request has applied since.
+//
+// Before anything goes out, the offline model answers locally and that patch is
+// applied straight away. The network answer, when it comes, refines it; when it
+// doesn't, the local answer stands and the request still succeeds.
+//
+// A request can also ask for several variations instead. Those are only
+// collected and reported, never applied, so they can be auditioned first.
+class PatchRequestService : private juce::Thread
+                          , private juce::AsyncUpdater
+{
+public:
+    enum class Status
+    {
+        succeeded,
+        failed,
+        cancelled
+    };
+
+    struct Result
+    {
+        int requestId { 0 };
+        Status status { Status::failed };
+        juce::String prompt;
+        juce::var params;
+        juce::String error;
+        bool fromCache { false };
+        bool fromLocalModel { false };
+        juce::Array<juce::var> variations;
+    };
+
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+        virtual void patchRequestFinished (const Result& result) = 0;
+    };
+
+    using ApplyCallback = std::function<void (const juce::var& params)>;
+    using CaptureCallback = std::function<juce::var()>;
+
+    // onCapture returns every parameter of the patch about to be live, as onApply accepts them
+    PatchRequestService (PromptCache& cache, const OfflinePatchModel& model, ApplyCallback onApply, CaptureCallback onCapture);
+    ~PatchRequestService() override;
+
+    int submit (const juce::String& prompt, const int numVariations = 0);
+    void cancelAll();
+
+    void setStreamingEnabled (const bool shouldStream) { streamingEnabled.store (shouldStream); }
+    bool isStreamingEnabled() const { return streamingEnabled.load(); }
+
+    // With refinement off, prompts are answered by the offline model alone
+    void setNetworkRefinementEnabled (const bool shouldRefine) { networkRefinementEnabled.store (shouldRefine); }
+    bool isNetworkRefinementEnabled() const { return networkRefinementEnabled.load(); }
+
+    void addListener (Listener* listener) { listeners.add (listener); }
+    void removeListener (Listener* listener) { listeners.remove (listener); }
+
+    // Keeps only known, numeric parameter ids
+    static juce::var sanitiseParams (const juce::var& params);
+    static juce::String getModelId();
+    static juce::String getEndpoint (const juce::String& method);
+
+    static constexpr int maxAttempts { 3 };
+    static constexpr int connectionTimeoutMs { 15000 };
+    static constexpr int firstBackoffMs { 1000 };
+
+private:
+    struct Request
+    {
+        int id { 0 };
+        juce::String prompt;
+        int numVariations { 0 };
+    };
+
+    void run() override;
+    void handleAsyncUpdate() override;
+
+    Result process (const Request& request);
+    bool fetch (const Request& request, const int numCandidates, juce::String& responseBody, int& statusCode, juce::String& error);
+    bool fetchStreaming (const Request& request, juce::String& modelText, int& statusCode, juce::String& error);
+    std::unique_ptr<juce::WebInputStream> createStream (const juce::String& method, const juce::String& body) const;
+    bool connect (const Request& request, juce::WebInputStream& stream);
+    void disconnect();
+    bool waitForBackoff (const int requestId, const int milliseconds);
+    bool isCancelled (const int requestId) const;
+    bool applyUnlessCancelled (const int requestId, const juce::var& params);
+    bool rollBack (const int requestId, const juce::var& paramsBefore);
+    void post (Result result);
+
+    static juce::String buildRequestBody (const juce::String& prompt, const int numCandidates = 1);
+    static bool parseResponse (const juce::String& responseBody, juce::var& params, juce::String& error);
+    static bool parseVariations (const juce::String& responseBody, juce::Array<juce::var>& variations, juce::String& error);
+    static bool parseModelText (const juce::String& text, juce::var& params, juce::String& error);
+    static juce::String getModelText (const juce::var& response, const int candidate = 0);
+
+    PromptCache& promptCache;
+    const OfflinePatchModel& offlineModel;
+    ApplyCallback applyParams;
+    CaptureCallback captureParams;
+
+    juce::CriticalSection queueLock;
+    std::deque<Request> queue;
+    int nextRequestId { 1 };
+    std::atomic<int> cancelledUpTo { 0 };
+    int lastAppliedRequestId { 0 };
+    std::atomic<bool> streamingEnabled { true };
+    std::atomic<bool> networkRefinementEnabled { true };
+
+    juce::CriticalSection streamLock;
+    juce::WebInputStream* activeStream { nullptr };
+
+    juce::CriticalSection resultLock;
+    std::vector<Result> finishedResults;
+    juce::ListenerList<Listener> listeners;
+};
@@ -0,0 +1,338 @@
+/*
+  ==============================================================================
+
+    PresetBank.cpp
+    Created: 18 Oct 2026 11:52:30am
+
+  ==============================================================================
+*/
+
+#include "PresetBank.h"
+
+// Records are read straight out of the mapping, so the host must match the on-disk byte order
+#if JUCE_BIG_ENDIAN
+ #error "PresetBank maps little endian records directly"
+#endif
+
+PresetBank::~PresetBank()
+{
+    close();
+}
+
+bool PresetBank::open (const juce::File& file)
+{
+    const juce::ScopedWriteLock sl (lock);
+    return openLocked (file);
+}
+
+void PresetBank::close()
+{
+    const juce::ScopedWriteLock sl (lock);
+    closeLocked();
+}
+
+bool PresetBank::isOpen() const
+{
+    const juce::ScopedReadLock sl (lock);
+    return mappedFile != nullptr;
+}
+
+juce::File PresetBank::getFile() const
+{
+    const juce::ScopedReadLock sl (lock);
+    return bankFile;
+}
+
+int PresetBank::getNumPresets() const
+{
+    const juce::ScopedReadLock sl (lock);
+    return numPresets;
+}
+
+juce::String PresetBank::getName (const int i) const
+{
+    const juce::ScopedReadLock sl (lock);
+    
+    if (! juce::isPositiveAndBelow (i, numPresets))
+        return {};
+    
+    const auto& entry = index[i];
+    return juce::String::fromUTF8 (entry.name, (int) strnlen (entry.name, maxNameBytes));
+}
+
+juce::String PresetBank::getTags (const int i) const
+{
+    const juce::ScopedReadLock sl (lock);
+    
+    if (! juce::isPositiveAndBelow (i, numPresets))
+        return {};
+    
+    const auto& entry = index[i];
+    return juce::String::fromUTF8 (entry.tags, (int) strnlen (entry.tags, maxTagsBytes));
+}
+
+bool PresetBank::matches (const int i, const juce::String& text) const
+{
+    if (text.isEmpty())
+        return true;
+    
+    const juce::ScopedReadLock sl (lock);
+    
+    if (! juce::isPositiveAndBelow (i, numPresets))
+        return false;
+    
+    // Searches the mapped strings in place; fields without a terminator are treated as corrupt
+    const auto& entry = index[i];
+    const auto needle = text.toUTF8();
+    
+    if (std::memchr (entry.name, 0, maxNameBytes) != nullptr
+        && juce::CharacterFunctions::indexOfIgnoreCase (juce::CharPointer_UTF8 (entry.name), needle) >= 0)
+        return true;
+    
+    return std::memchr (entry.tags, 0, maxTagsBytes) != nullptr
+        && juce::CharacterFunctions::indexOfIgnoreCase (juce::CharPointer_UTF8 (entry.tags), needle) >= 0;
+}
+
+bool PresetBank::getPatch (const int i, PatchData& patch) const
+{
+    const juce::ScopedReadLock sl (lock);
+    
+    if (! juce::isPositiveAndBelow (i, numPresets))
+        return false;
+    
+    // Parameters the bank doesn't know about keep whatever the caller put in the patch
+    const auto* record = records + (size_t) i * (size_t) numSlots;
+    
+    for (int slot = 0; slot < numSlots; ++slot)
+    {
+        const auto param = slotToParameter[(size_t) slot];
+        
+        if (param >= 0 && std::isfinite (record[slot]))
+            patch.setValue (param, record[slot]);
+    }
+    
+    return true;
+}
+
+bool PresetBank::addPreset (const Preset& preset)
+{
+    const juce::ScopedWriteLock sl (lock);
+    
+    auto file = bankFile != juce::File() ? bankFile : getDefaultFile();
+    
+    std::vector<Preset> presets;
+    
+    if (! readAllLocked (presets))
+        return false;
+    
+    presets.push_back (preset);
+    
+    // The mapping has to go before the file can be replaced on every platform
+    closeLocked();
+    const auto written = writeBank (file, presets);
+    openLocked (file);
+    
+    return written;
+}
+
+bool PresetBank::renamePreset (const int i, const juce::String& newName)
+{
+    const juce::ScopedWriteLock sl (lock);
+    
+    if (! juce::isPositiveAndBelow (i, numPresets))
+        return false;
+    
+    // Index entries are fixed-size, so a rename is patched in place
+    const auto* header = static_cast<const Header*> (mappedFile->getData());
+    const auto position = (juce::int64) header->indexOffset + (juce::int64) i * (juce::int64) sizeof (IndexEntry);
+    
+    char name[maxNameBytes];
+    copyTruncated (newName, name, maxNameBytes);
+    
+    auto file = bankFile;
+    closeLocked();
+    
+    bool written = false;
+    
+    {
+        juce::FileOutputStream stream (file);
+        
+        if (stream.openedOk() && stream.setPosition (position))
+        {
+            written = stream.write (name, maxNameBytes);
+            stream.flush();
+        }
+    }
+    
+    openLocked (file);
+    return written;
+}
+
+bool PresetBank::writeBank (const juce::File& file, const std::vector<Preset>& presets)
+{
+    const auto slots = PatchData::numParameters;
+    const auto schemaOffset = (juce::uint32) sizeof (Header);
+    const auto recordsOffset = (juce::uint32) ((schemaOffset + slots * sizeof (juce::uint32) + 15) & ~15u);
+    const auto indexOffset = (juce::uint32) (recordsOffset + presets.size() * slots * sizeof (float));
+    
+    Header header {};
+    header.magic = magic;
+    header.version = (juce::uint16) version;
+    header.numSlots = (juce::uint16) slots;
+    header.numPresets = (juce::uint32) presets.size();
+    header.schemaOffset = schemaOffset;
+    header.recordsOffset = recordsOffset;
+    header.indexOffset = indexOffset;
+    
+    if (! file.getParentDirectory().createDirectory())
+        return false;
+    
+    juce::TemporaryFile temp (file);
+    
+    {
+        juce::FileOutputStream stream (temp.getFile());
+        
+        if (! stream.openedOk())
+            return false;
+        
+        stream.write (&header, sizeof (Header));
+        
+        for (int slot = 0; slot < slots; ++slot)
+            stream.writeInt ((int) PatchData::getParameterHash (slot));
+        
+        stream.writeRepeatedByte (0, recordsOffset - (schemaOffset + slots * sizeof (juce::uint32)));
+        
+        for (const auto& preset : presets)
+            stream.write (preset.patch.getValues().data(), slots * sizeof (float));
+        
+        for (const auto& preset : presets)
+        {
+            IndexEntry entry;
+            copyTruncated (preset.name, entry.name, maxNameBytes);
+            copyTruncated (preset.tags, entry.tags, maxTagsBytes);
+            stream.write (&entry, sizeof (IndexEntry));
+        }
+        
+        stream.flush();
+        
+        if (stream.getStatus().failed())
+            return false;
+    }
+    
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+juce::File PresetBank::getDefaultFile()
+{
+    auto dir = juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory);
+    
+   #if JUCE_MAC
+    dir = dir.getChildFile ("Application Support");
+   #endif
+    
+    return dir.getChildFile ("tapSynth").getChildFile ("Presets.tspb");
+}
+
+bool PresetBank::openLocked (const juce::File& file)
+{
+    closeLocked();
+    bankFile = file;
+    
+    if (! file.existsAsFile())
+        return false;
+    
+    auto mapping = std::make_unique<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readOnly);
+    const auto* data = static_cast<const char*> (mapping->getData());
+    const auto size = mapping->getSize();
+    
+    if (data == nullptr || size < sizeof (Header))
+        return false;
+    
+    const auto* header = reinterpret_cast<const Header*> (data);
+    
+    if (header->magic != magic || header->version > version || header->numSlots == 0)
+        return false;
+    
+    const auto slots = (size_t) header->numSlots;
+    const auto count = (size_t) header->numPresets;
+    
+    // Reject anything that would read past the end of the mapping
+    if (header->recordsOffset % alignof (float) != 0
+        || header->indexOffset % alignof (IndexEntry) != 0
+        || header->schemaOffset + slots * sizeof (juce::uint32) > size
+        || header->recordsOffset + count * slots * sizeof (float) > size
+        || header->indexOffset + count * sizeof (IndexEntry) > size)
+        return false;
+    
+    const auto* schema = reinterpret_cast<const juce::uint32*> (data + header->schemaOffset);
+    slotToParameter.resize (slots);
+    
+    for (size_t slot = 0; slot < slots; ++slot)
+        slotToParameter[slot] = PatchData::getParameterIndexForHash (schema[slot]);
+    
+    records = reinterpret_cast<const float*> (data + header->recordsOffset);
+    index = reinterpret_cast<const IndexEntry*> (data + header->indexOffset);
+    numSlots = (int) slots;
+    numPresets = (int) count;
+    mappedFile = std::move (mapping);
+    
+    return true;
+}
+
+void PresetBank::closeLocked()
+{
+    mappedFile.reset();
+    records = nullptr;
+    index = nullptr;
+    numPresets = 0;
+    numSlots = 0;
+}
+
+bool PresetBank::readAllLocked (std::vector<Preset>& presets) const
+{
+    presets.clear();
+    presets.reserve ((size_t) numPresets + 1);
+    
+    for (int i = 0; i < numPresets; ++i)
+    {
+        const auto& entry = index[i];
+        
+        Preset preset;
+        preset.name = juce::String::fromUTF8 (entry.name, (int) strnlen (entry.name, maxNameBytes));
+        preset.tags = juce::String::fromUTF8 (entry.tags, (int) strnlen (entry.tags, maxTagsBytes));
+        
+        // Slots this build doesn't know are dropped when the bank is rewritten
+        const auto* record = records + (size_t) i * (size_t) numSlots;
+        
+        for (int slot = 0; slot < numSlots; ++slot)
+        {
+            if (slotToParameter[(size_t) slot] >= 0)
+                preset.patch.setValue (slotToParameter[(size_t) slot], record[slot]);
+        }
+        
+        presets.push_back (std::move (preset));
+    }
+    
+    return true;
+}
+
+void PresetBank::copyTruncated (const juce::String& text, char* dest, const int maxBytes)
+{
+    std::memset (dest, 0, (size_t) maxBytes);
+    
+    // Always leave room for the terminator, and never split a multi-byte character
+    auto utf8 = text.toUTF8();
+    int numBytes = 0;
+    
+    for (auto p = utf8; ! p.isEmpty(); ++p)
+    {
+        const auto charBytes = (int) juce::CharPointer_UTF8::getBytesRequiredFor (*p);
+        
+        if (numBytes + charBytes > maxBytes - 1)
+            break;
+        
+        numBytes += charBytes;
+    }
+    
+    std::memcpy (dest, utf8.getAddress(), (size_t) numBytes);
+}
@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+    Created: 18 Oct 2026 11:52:30am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PatchData.h"
+
+// A single memory-mapped preset bank file.
+//
+// Layout (little endian):
+//   Header     64 bytes, see below
+//   Schema     numSlots x uint32 parameter id hash (PatchData::getParameterHash)
+//   Records    numPresets x numSlots x float, 16-byte aligned
+//   Index      numPresets x IndexEntry (fixed-size, null-terminated UTF-8 name and tags)
+//
+// Every lookup is a pointer offset into the mapping, so browsing and switching
+// presets costs the same with 50 or 50k entries and never parses or allocates.
+class PresetBank
+{
+public:
+    struct Preset
+    {
+        juce::String name;
+        juce::String tags;
+        PatchData patch;
+    };
+
+    PresetBank() = default;
+    ~PresetBank();
+
+    bool open (const juce::File& file);
+    void close();
+    bool isOpen() const;
+    juce::File getFile() const;
+
+    int getNumPresets() const;
+    juce::String getName (const int index) const;
+    juce::String getTags (const int index) const;
+    bool matches (const int index, const juce::String& text) const;
+    bool getPatch (const int index, PatchData& patch) const;
+
+    bool addPreset (const Preset& preset);
+    bool renamePreset (const int index, const juce::String& newName);
+
+    static bool writeBank (const juce::File& file, const std::vector<Preset>& presets);
+    static juce::File getDefaultFile();
+
+    static constexpr juce::uint32 magic { 0x42505354 }; // 'TSPB'
+    static constexpr int version { 1 };
+    static constexpr int maxNameBytes { 48 };
+    static constexpr int maxTagsBytes { 80 };
+
+private:
+    struct Header
+    {
+        juce::uint32 magic;
+        juce::uint16 version;
+        juce::uint16 numSlots;
+        juce::uint32 numPresets;
+        juce::uint32 schemaOffset;
+        juce::uint32 recordsOffset;
+        juce::uint32 indexOffset;
+        juce::uint8 reserved[40];
+    };
+
+    struct IndexEntry
+    {
+        char name[maxNameBytes];
+        char tags[maxTagsBytes];
+    };
+
+    static_assert (sizeof (Header) == 64, "Header layout is part of the file format");
+    static_assert (sizeof (IndexEntry) == 128, "IndexEntry layout is part of the file format");
+
+    bool openLocked (const juce::File& file);
+    void closeLocked();
+    bool readAllLocked (std::vector<Preset>& presets) const;
+    static void copyTruncated (const juce::String& text, char* dest, const int maxBytes);
+
+    mutable juce::ReadWriteLock lock;
+    juce::File bankFile;
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    const float* records { nullptr };
+    const IndexEntry* index { nullptr };
+    int numPresets { 0 };
+    int numSlots { 0 };
+    std::vector<int> slotToParameter;
+};
@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    PreviewPlayer.cpp
+    Created: 18 Oct 2026 7:34:50pm
+
+  ==============================================================================
+*/
+
+#include "PreviewPlayer.h"
+
+PreviewPlayer::~PreviewPlayer()
+{
+    pending.store (nullptr);
+}
+
+void PreviewPlayer::play (std::shared_ptr<const Clip> clip)
+{
+    collectGarbage();
+    retireActiveClip();
+    
+    active = std::move (clip);
+    
+    // Publish the pointer before bumping the epoch: a block that sees the new epoch also sees the new clip
+    pending.store (active.get());
+    startCount.fetch_add (1);
+    const auto epoch = requestEpoch.fetch_add (1) + 1;
+    
+    if (! retired.empty() && retired.back().first == 0)
+        retired.back().first = epoch;
+}
+
+void PreviewPlayer::stop()
+{
+    collectGarbage();
+    retireActiveClip();
+    
+    pending.store (nullptr);
+    const auto epoch = requestEpoch.fetch_add (1) + 1;
+    
+    if (! retired.empty() && retired.back().first == 0)
+        retired.back().first = epoch;
+}
+
+void PreviewPlayer::process (juce::AudioBuffer<float>& buffer)
+{
+    // The epoch is read first, so whatever clip is loaded after it is at least that recent
+    const auto epoch = requestEpoch.load();
+    const auto* clip = pending.load();
+    const auto start = startCount.load();
+    
+    if (clip != current || start != currentStart)
+    {
+        current = clip;
+        currentStart = start;
+        position = 0;
+    }
+    
+    if (current != nullptr && position < current->getNumSamples())
+    {
+        const auto numSamples = juce::jmin (buffer.getNumSamples(), current->getNumSamples() - position);
+        
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            buffer.addFrom (ch, 0, *current, ch % current->getNumChannels(), position, numSamples);
+        
+        position += numSamples;
+    }
+    
+    seenEpoch.store (epoch);
+}
+
+void PreviewPlayer::retireActiveClip()
+{
+    // Tagged with the epoch of the request that replaces it, once that's known
+    if (active != nullptr)
+        retired.emplace_back (0, std::move (active));
+}
+
+void PreviewPlayer::collectGarbage()
+{
+    const auto seen = seenEpoch.load();
+    
+    retired.erase (std::remove_if (retired.begin(), retired.end(),
+                                   [seen] (const auto& entry) { return entry.first != 0 && entry.first <= seen; }),
+                   retired.end());
+}
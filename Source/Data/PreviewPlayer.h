@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+    PreviewPlayer.h
+    Created: 18 Oct 2026 7:34:50pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Plays pre-rendered preview clips on top of the live output.
+//
+// The message thread picks the clip; the audio thread only reads an atomic
+// pointer to it and never allocates, locks or frees. Clips that have been
+// replaced are kept alive until the audio thread has provably moved past them,
+// which it acknowledges with an epoch counter at the end of every block.
+class PreviewPlayer
+{
+public:
+    using Clip = juce::AudioBuffer<float>;
+
+    PreviewPlayer() = default;
+    ~PreviewPlayer();
+
+    // Message thread
+    void play (std::shared_ptr<const Clip> clip);
+    void stop();
+    const Clip* getActiveClip() const { return active.get(); }
+
+    // Audio thread
+    void process (juce::AudioBuffer<float>& buffer);
+
+private:
+    void retireActiveClip();
+    void collectGarbage();
+
+    std::atomic<const Clip*> pending { nullptr };
+    std::atomic<juce::uint32> startCount { 0 };
+    std::atomic<juce::uint32> requestEpoch { 0 };
+    std::atomic<juce::uint32> seenEpoch { 0 };
+
+    // Audio thread only
+    const Clip* current { nullptr };
+    juce::uint32 currentStart { 0 };
+    int position { 0 };
+
+    // Message thread only
+    std::shared_ptr<const Clip> active;
+    std::vector<std::pair<juce::uint32, std::shared_ptr<const Clip>>> retired;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PreviewPlayer)
+};
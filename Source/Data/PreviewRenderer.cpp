@@ -0,0 +1,160 @@
+/*
+  ==============================================================================
+
+    PreviewRenderer.cpp
+    Created: 18 Oct 2026 7:52:16pm
+
+  ==============================================================================
+*/
+
+#include "PreviewRenderer.h"
+#include "TraceRecorder.h"
+
+class PreviewRenderer::RenderJob : public juce::ThreadPoolJob
+{
+public:
+    RenderJob (PreviewRenderer& r, const int b, const int i, const juce::var& p, const double sr)
+    : juce::ThreadPoolJob ("Preview render"), owner (r), batch (b), index (i), params (p), sampleRate (sr)
+    {
+    }
+    
+    JobStatus runJob() override
+    {
+        TAPSYNTH_TRACE_SCOPE ("Preview render");
+        std::shared_ptr<Clip> clip;
+        
+        if (owner.currentBatch.load() == batch)
+        {
+            if (auto instance = owner.createInstance (params))
+            {
+                auto rendered = std::make_shared<Clip>();
+                
+                if (getPhrase().render (*instance, *rendered, sampleRate, blockSize, [this] { return shouldExit(); }))
+                    clip = std::move (rendered);
+            }
+        }
+        
+        owner.finishRender (batch, index, std::move (clip));
+        return jobHasFinished;
+    }
+    
+private:
+    PreviewRenderer& owner;
+    const int batch;
+    const int index;
+    const juce::var params;
+    const double sampleRate;
+};
+
+PreviewRenderer::PreviewRenderer (InstanceFactory factory)
+: createInstance (std::move (factory))
+{
+}
+
+PreviewRenderer::~PreviewRenderer()
+{
+    currentBatch.fetch_add (1);
+    
+    if (pool != nullptr)
+        pool->removeAllJobs (true, 5000);
+    
+    cancelPendingUpdate();
+}
+
+const AuditionPhrase& PreviewRenderer::getPhrase()
+{
+    static const AuditionPhrase phrase
+    {
+        "preview", 3.0,
+        {
+            { 48, 0.8f, 0.0, 1.0 }, { 52, 0.8f, 0.0, 1.0 }, { 55, 0.8f, 0.0, 1.0 },
+            { 60, 0.8f, 1.2, 0.15 }, { 64, 0.8f, 1.4, 0.15 }, { 67, 0.8f, 1.6, 0.15 }, { 72, 0.8f, 1.8, 0.4 }
+        }
+    };
+    
+    return phrase;
+}
+
+void PreviewRenderer::render (const juce::Array<juce::var>& candidates, const double sampleRate)
+{
+    const auto batch = currentBatch.fetch_add (1) + 1;
+    
+    if (pool == nullptr)
+        pool = std::make_unique<juce::ThreadPool> (juce::jmax (1, juce::SystemStats::getNumCpus() - 1));
+    
+    // Stale jobs notice the new batch and bail out; the wait here is only for queued ones
+    pool->removeAllJobs (true, 0);
+    
+    {
+        const juce::ScopedLock sl (lock);
+        previews.clear();
+        
+        for (const auto& params : candidates)
+            previews.push_back ({ params, nullptr });
+        
+        numRendering = candidates.size();
+    }
+    
+    for (int i = 0; i < candidates.size(); ++i)
+        pool->addJob (new RenderJob (*this, batch, i, candidates[i], sampleRate), true);
+    
+    listeners.call ([] (Listener& l) { l.previewsChanged(); });
+}
+
+void PreviewRenderer::clear()
+{
+    currentBatch.fetch_add (1);
+    
+    if (pool != nullptr)
+        pool->removeAllJobs (true, 0);
+    
+    {
+        const juce::ScopedLock sl (lock);
+        previews.clear();
+        numRendering = 0;
+    }
+    
+    listeners.call ([] (Listener& l) { l.previewsChanged(); });
+}
+
+int PreviewRenderer::getNumPreviews() const
+{
+    const juce::ScopedLock sl (lock);
+    return (int) previews.size();
+}
+
+PreviewRenderer::Preview PreviewRenderer::getPreview (const int index) const
+{
+    const juce::ScopedLock sl (lock);
+    
+    if (! juce::isPositiveAndBelow (index, (int) previews.size()))
+        return {};
+    
+    return previews[(size_t) index];
+}
+
+bool PreviewRenderer::isRendering() const
+{
+    const juce::ScopedLock sl (lock);
+    return numRendering > 0;
+}
+
+void PreviewRenderer::finishRender (const int batch, const int index, std::shared_ptr<const Clip> audio)
+{
+    {
+        const juce::ScopedLock sl (lock);
+        
+        if (batch != currentBatch.load() || ! juce::isPositiveAndBelow (index, (int) previews.size()))
+            return;
+        
+        previews[(size_t) index].audio = std::move (audio);
+        --numRendering;
+    }
+    
+    triggerAsyncUpdate();
+}
+
+void PreviewRenderer::handleAsyncUpdate()
+{
+    listeners.call ([] (Listener& l) { l.previewsChanged(); });
+}
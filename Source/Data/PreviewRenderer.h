@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    PreviewRenderer.h
+    Created: 18 Oct 2026 7:52:16pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AuditionPhrase.h"
+
+// Renders the preview audition phrase for each candidate patch, off the audio thread.
+//
+// Every candidate gets its own headless processor instance, created by the
+// factory on a pool thread, so renders run in parallel across cores and share
+// no state with the live instance. Finished clips stay in memory until the
+// next batch replaces them.
+class PreviewRenderer : private juce::AsyncUpdater
+{
+public:
+    using Clip = juce::AudioBuffer<float>;
+    using InstanceFactory = std::function<std::unique_ptr<juce::AudioProcessor> (const juce::var& params)>;
+
+    struct Preview
+    {
+        juce::var params;
+        std::shared_ptr<const Clip> audio;
+    };
+
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+        virtual void previewsChanged() = 0;
+    };
+
+    explicit PreviewRenderer (InstanceFactory factory);
+    ~PreviewRenderer() override;
+
+    // Message thread; cancels whatever is still rendering from the previous batch
+    void render (const juce::Array<juce::var>& candidates, const double sampleRate);
+    void clear();
+
+    int getNumPreviews() const;
+    Preview getPreview (const int index) const;
+    bool isRendering() const;
+
+    void addListener (Listener* listener) { listeners.add (listener); }
+    void removeListener (Listener* listener) { listeners.remove (listener); }
+
+    static constexpr int blockSize { 512 };
+
+    // A held triad, then a rising arpeggio over it, then room for the tail
+    static const AuditionPhrase& getPhrase();
+
+private:
+    class RenderJob;
+
+    void finishRender (const int batch, const int index, std::shared_ptr<const Clip> audio);
+    void handleAsyncUpdate() override;
+
+    InstanceFactory createInstance;
+
+    // Created on first use, so headless instances never start threads of their own
+    std::unique_ptr<juce::ThreadPool> pool;
+
+    juce::CriticalSection lock;
+    std::vector<Preview> previews;
+    std::atomic<int> currentBatch { 0 };
+    int numRendering { 0 };
+
+    juce::ListenerList<Listener> listeners;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PreviewRenderer)
+};
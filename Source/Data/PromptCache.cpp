@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    PromptCache.cpp
+    Created: 18 Oct 2026 3:58:21pm
+
+  ==============================================================================
+*/
+
+#include "PromptCache.h"
+
+PromptCache::PromptCache (const juce::File& dir, const juce::int64 bytes, const int entries)
+: directory (dir)
+, maxBytes (bytes)
+, maxEntries (entries)
+{
+}
+
+juce::var PromptCache::lookup (const juce::String& prompt, const juce::String& modelId)
+{
+    const juce::ScopedLock sl (lock);
+    
+    const auto key = makeKey (prompt, modelId);
+    const auto file = getEntryFile (key);
+    
+    if (! file.existsAsFile())
+        return {};
+    
+    const auto entry = juce::JSON::parse (file);
+    
+    if (entry.getProperty ("key", {}).toString() != key)
+        return {};
+    
+    const auto params = entry.getProperty ("params", {});
+    
+    if (! params.isObject())
+        return {};
+    
+    // Touching the file moves it to the back of the eviction order
+    file.setLastModificationTime (juce::Time::getCurrentTime());
+    return params;
+}
+
+void PromptCache::store (const juce::String& prompt, const juce::String& modelId, const juce::var& params)
+{
+    if (! params.isObject())
+        return;
+    
+    const juce::ScopedLock sl (lock);
+    
+    if (! directory.createDirectory())
+        return;
+    
+    const auto key = makeKey (prompt, modelId);
+    
+    auto* entry = new juce::DynamicObject();
+    entry->setProperty ("key", key);
+    entry->setProperty ("params", params);
+    
+    if (getEntryFile (key).replaceWithText (juce::JSON::toString (juce::var (entry), true)))
+        evict();
+}
+
+juce::String PromptCache::normalise (const juce::String& prompt)
+{
+    // Case, surrounding punctuation and spacing don't change what was asked for
+    auto text = prompt.toLowerCase().trim().trimCharactersAtEnd (".!?;,").trim();
+    
+    juce::StringArray words;
+    words.addTokens (text, " \t\r\n", "");
+    words.removeEmptyStrings();
+    
+    return words.joinIntoString (" ");
+}
+
+juce::File PromptCache::getDefaultDirectory()
+{
+    auto dir = juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory);
+    
+   #if JUCE_MAC
+    dir = dir.getChildFile ("Application Support");
+   #endif
+    
+    return dir.getChildFile ("tapSynth").getChildFile ("PromptCache");
+}
+
+juce::String PromptCache::makeKey (const juce::String& prompt, const juce::String& modelId)
+{
+    return modelId + "\n" + normalise (prompt);
+}
+
+juce::File PromptCache::getEntryFile (const juce::String& key) const
+{
+    return directory.getChildFile (juce::String::toHexString (key.hashCode64()) + ".json");
+}
+
+void PromptCache::evict()
+{
+    auto files = directory.findChildFiles (juce::File::findFiles, false, "*.json");
+    
+    juce::int64 totalBytes = 0;
+    
+    for (const auto& file : files)
+        totalBytes += file.getSize();
+    
+    if (totalBytes <= maxBytes && files.size() <= maxEntries)
+        return;
+    
+    std::sort (files.begin(), files.end(), [] (const juce::File& a, const juce::File& b)
+    {
+        return a.getLastModificationTime() < b.getLastModificationTime();
+    });
+    
+    auto numFiles = files.size();
+    
+    for (const auto& file : files)
+    {
+        if (totalBytes <= maxBytes && numFiles <= maxEntries)
+            break;
+        
+        totalBytes -= file.getSize();
+        --numFiles;
+        file.deleteFile();
+    }
+}
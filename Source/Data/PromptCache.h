@@ -0,0 +1,40 @@
+/*
+  ==============================================================================
+
+    PromptCache.h
+    Created: 18 Oct 2026 3:58:21pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// On-disk cache of prompt -> parameter JSON, so repeated prompts skip the network.
+//
+// Each entry is one small JSON file named after a hash of the normalised prompt
+// and model id; the full key is stored inside to guard against collisions.
+// File modification times double as LRU order: hits touch the file, and stores
+// evict the least recently used entries once the size or count cap is exceeded.
+class PromptCache
+{
+public:
+    PromptCache (const juce::File& directory, const juce::int64 maxBytes = 4 * 1024 * 1024, const int maxEntries = 2000);
+
+    juce::var lookup (const juce::String& prompt, const juce::String& modelId);
+    void store (const juce::String& prompt, const juce::String& modelId, const juce::var& params);
+
+    static juce::String normalise (const juce::String& prompt);
+    static juce::File getDefaultDirectory();
+
+private:
+    static juce::String makeKey (const juce::String& prompt, const juce::String& modelId);
+    juce::File getEntryFile (const juce::String& key) const;
+    void evict();
+
+    juce::File directory;
+    juce::int64 maxBytes;
+    int maxEntries;
+    juce::CriticalSection lock;
+};
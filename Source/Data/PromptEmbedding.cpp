@@ -0,0 +1,190 @@
+/*
+  ==============================================================================
+
+    PromptEmbedding.cpp
+    Created: 18 Oct 2026 6:41:09pm
+
+  ==============================================================================
+*/
+
+#include "PromptEmbedding.h"
+
+namespace
+{
+    struct Word
+    {
+        const char* text;
+        PromptEmbedding::Vector vector;
+    };
+
+    //                                   bright attack length space motion  grit weight purity
+    const Word vocabulary[] =
+    {
+        { "bright",      { {  1.0f,  0.0f,  0.0f,  0.0f,  0.0f,  0.2f,  -0.3f, -0.2f } } },
+        { "brilhante",   { {  1.0f,  0.0f,  0.0f,  0.0f,  0.0f,  0.2f,  -0.3f, -0.2f } } },
+        { "airy",        { {  0.8f, -0.2f,  0.3f,  0.4f,  0.0f, -0.3f,  -0.5f,  0.3f } } },
+        { "crisp",       { {  0.8f,  0.6f, -0.2f, -0.2f,  0.0f,  0.2f,  -0.2f,  0.0f } } },
+        { "sharp",       { {  0.7f,  0.7f,  0.0f,  0.0f,  0.0f,  0.4f,   0.0f, -0.3f } } },
+        { "dark",        { { -1.0f,  0.0f,  0.0f,  0.0f,  0.0f,  0.0f,   0.4f,  0.0f } } },
+        { "escuro",      { { -1.0f,  0.0f,  0.0f,  0.0f,  0.0f,  0.0f,   0.4f,  0.0f } } },
+        { "muffled",     { { -0.9f, -0.2f,  0.0f, -0.2f,  0.0f, -0.3f,   0.2f,  0.3f } } },
+        { "warm",        { { -0.5f, -0.2f,  0.2f,  0.1f,  0.0f, -0.3f,   0.3f,  0.2f } } },
+        { "quente",      { { -0.5f, -0.2f,  0.2f,  0.1f,  0.0f, -0.3f,   0.3f,  0.2f } } },
+        { "pluck",       { {  0.4f,  1.0f, -0.8f,  0.0f,  0.0f,  0.0f,   0.0f,  0.0f } } },
+        { "percussive",  { {  0.3f,  1.0f, -0.7f, -0.2f,  0.0f,  0.2f,   0.0f,  0.0f } } },
+        { "percussivo",  { {  0.3f,  1.0f, -0.7f, -0.2f,  0.0f,  0.2f,   0.0f,  0.0f } } },
+        { "punch",       { {  0.2f,  0.9f, -0.3f, -0.3f,  0.0f,  0.4f,   0.4f,  0.0f } } },
+        { "stab",        { {  0.5f,  0.9f, -0.9f,  0.0f,  0.0f,  0.3f,   0.0f, -0.3f } } },
+        { "fast",        { {  0.0f,  0.8f, -0.4f,  0.0f,  0.2f,  0.0f,   0.0f,  0.0f } } },
+        { "rapido",      { {  0.0f,  0.8f, -0.4f,  0.0f,  0.2f,  0.0f,   0.0f,  0.0f } } },
+        { "short",       { {  0.0f,  0.5f, -1.0f, -0.2f,  0.0f,  0.0f,   0.0f,  0.0f } } },
+        { "curto",       { {  0.0f,  0.5f, -1.0f, -0.2f,  0.0f,  0.0f,   0.0f,  0.0f } } },
+        { "staccato",    { {  0.0f,  0.6f, -1.0f, -0.3f,  0.0f,  0.0f,   0.0f,  0.0f } } },
+        { "slow",        { {  0.0f, -1.0f,  0.5f,  0.2f,  0.0f,  0.0f,   0.0f,  0.0f } } },
+        { "lento",       { {  0.0f, -1.0f,  0.5f,  0.2f,  0.0f,  0.0f,   0.0f,  0.0f } } },
+        { "swell",       { {  0.0f, -1.0f,  0.6f,  0.3f,  0.2f,  0.0f,   0.0f,  0.0f } } },
+        { "soft",        { { -0.3f, -0.5f,  0.2f,  0.0f,  0.0f, -0.6f,   0.0f,  0.6f } } },
+        { "suave",       { { -0.3f, -0.5f,  0.2f,  0.0f,  0.0f, -0.6f,   0.0f,  0.6f } } },
+        { "gentle",      { { -0.3f, -0.6f,  0.2f,  0.1f,  0.0f, -0.6f,   0.0f,  0.5f } } },
+        { "long",        { {  0.0f, -0.3f,  1.0f,  0.2f,  0.0f,  0.0f,   0.0f,  0.0f } } },
+        { "longo",       { {  0.0f, -0.3f,  1.0f,  0.2f,  0.0f,  0.0f,   0.0f,  0.0f } } },
+        { "sustain",     { {  0.0f, -0.2f,  1.0f,  0.0f,  0.0f,  0.0f,   0.0f,  0.0f } } },
+        { "drone",       { { -0.2f, -0.8f,  1.0f,  0.3f,  0.4f,  0.0f,   0.3f,  0.0f } } },
+        { "pad",         { { -0.1f, -0.9f,  0.9f,  0.6f,  0.2f, -0.3f,   0.0f,  0.0f } } },
+        { "lush",        { {  0.1f, -0.6f,  0.7f,  0.8f,  0.3f, -0.3f,   0.0f, -0.2f } } },
+        { "ambient",     { {  0.0f, -0.7f,  0.8f,  1.0f,  0.3f, -0.4f,   0.0f,  0.2f } } },
+        { "ambiente",    { {  0.0f, -0.7f,  0.8f,  1.0f,  0.3f, -0.4f,   0.0f,  0.2f } } },
+        { "reverb",      { {  0.0f,  0.0f,  0.3f,  1.0f,  0.0f,  0.0f,   0.0f,  0.0f } } },
+        { "space",       { {  0.1f, -0.2f,  0.4f,  1.0f,  0.1f,  0.0f,   0.0f,  0.0f } } },
+        { "espacial",    { {  0.1f, -0.2f,  0.4f,  1.0f,  0.1f,  0.0f,   0.0f,  0.0f } } },
+        { "wide",        { {  0.1f,  0.0f,  0.2f,  0.9f,  0.0f,  0.0f,   0.0f,  0.0f } } },
+        { "hall",        { {  0.0f, -0.2f,  0.5f,  1.0f,  0.0f,  0.0f,   0.0f,  0.0f } } },
+        { "dry",         { {  0.0f,  0.2f, -0.2f, -1.0f,  0.0f,  0.0f,   0.0f,  0.0f } } },
+        { "seco",        { {  0.0f,  0.2f, -0.2f, -1.0f,  0.0f,  0.0f,   0.0f,  0.0f } } },
+        { "close",       { {  0.0f,  0.1f,  0.0f, -0.8f,  0.0f,  0.0f,   0.0f,  0.0f } } },
+        { "wobble",      { {  0.0f,  0.0f,  0.3f,  0.0f,  1.0f,  0.4f,   0.5f,  0.0f } } },
+        { "dubstep",     { {  0.0f,  0.2f,  0.3f, -0.2f,  1.0f,  0.8f,   0.8f, -0.4f } } },
+        { "evolving",    { {  0.0f, -0.5f,  0.7f,  0.4f,  1.0f,  0.0f,   0.0f,  0.0f } } },
+        { "moving",      { {  0.0f,  0.0f,  0.3f,  0.0f,  0.9f,  0.0f,   0.0f,  0.0f } } },
+        { "wah",         { {  0.2f,  0.0f,  0.2f,  0.0f,  0.9f,  0.2f,   0.0f,  0.0f } } },
+        { "static",      { {  0.0f,  0.0f,  0.0f,  0.0f, -1.0f,  0.0f,   0.0f,  0.0f } } },
+        { "aggressive",  { {  0.5f,  0.5f,  0.0f, -0.2f,  0.0f,  1.0f,   0.2f, -0.6f } } },
+        { "agressivo",   { {  0.5f,  0.5f,  0.0f, -0.2f,  0.0f,  1.0f,   0.2f, -0.6f } } },
+        { "harsh",       { {  0.7f,  0.3f,  0.0f, -0.2f,  0.0f,  1.0f,   0.0f, -0.7f } } },
+        { "gritty",      { {  0.3f,  0.2f,  0.0f, -0.2f,  0.1f,  1.0f,   0.2f, -0.5f } } },
+        { "dirty",       { {  0.2f,  0.2f,  0.0f, -0.2f,  0.1f,  1.0f,   0.3f, -0.5f } } },
+        { "sujo",        { {  0.2f,  0.2f,  0.0f, -0.2f,  0.1f,  1.0f,   0.3f, -0.5f } } },
+        { "metallic",    { {  0.8f,  0.6f,  0.2f,  0.2f,  0.0f,  0.6f,  -0.2f, -0.4f } } },
+        { "metalico",    { {  0.8f,  0.6f,  0.2f,  0.2f,  0.0f,  0.6f,  -0.2f, -0.4f } } },
+        { "bell",        { {  0.8f,  0.8f,  0.5f,  0.4f,  0.0f,  0.2f,  -0.4f,  0.2f } } },
+        { "sino",        { {  0.8f,  0.8f,  0.5f,  0.4f,  0.0f,  0.2f,  -0.4f,  0.2f } } },
+        { "glass",       { {  0.9f,  0.6f,  0.3f,  0.3f,  0.0f,  0.1f,  -0.6f,  0.4f } } },
+        { "clean",       { {  0.2f,  0.0f,  0.0f, -0.2f, -0.2f, -1.0f,   0.0f,  0.6f } } },
+        { "limpo",       { {  0.2f,  0.0f,  0.0f, -0.2f, -0.2f, -1.0f,   0.0f,  0.6f } } },
+        { "bass",        { { -0.4f,  0.3f,  0.0f, -0.6f,  0.0f,  0.2f,   1.0f,  0.0f } } },
+        { "baixo",       { { -0.4f,  0.3f,  0.0f, -0.6f,  0.0f,  0.2f,   1.0f,  0.0f } } },
+        { "grave",       { { -0.5f,  0.0f,  0.0f, -0.3f,  0.0f,  0.0f,   1.0f,  0.0f } } },
+        { "sub",         { { -0.8f,  0.2f,  0.2f, -0.8f,  0.0f, -0.3f,   1.0f,  0.8f } } },
+        { "deep",        { { -0.6f,  0.0f,  0.2f,  0.0f,  0.0f,  0.0f,   1.0f,  0.2f } } },
+        { "profundo",    { { -0.6f,  0.0f,  0.2f,  0.0f,  0.0f,  0.0f,   1.0f,  0.2f } } },
+        { "heavy",       { { -0.2f,  0.3f,  0.0f, -0.2f,  0.0f,  0.6f,   1.0f, -0.3f } } },
+        { "pesado",      { { -0.2f,  0.3f,  0.0f, -0.2f,  0.0f,  0.6f,   1.0f, -0.3f } } },
+        { "lead",        { {  0.6f,  0.5f,  0.3f,  0.0f,  0.2f,  0.5f,  -0.6f, -0.4f } } },
+        { "solo",        { {  0.6f,  0.5f,  0.3f,  0.0f,  0.2f,  0.5f,  -0.6f, -0.4f } } },
+        { "high",        { {  0.6f,  0.0f,  0.0f,  0.0f,  0.0f,  0.0f,  -1.0f,  0.0f } } },
+        { "agudo",       { {  0.6f,  0.0f,  0.0f,  0.0f,  0.0f,  0.0f,  -1.0f,  0.0f } } },
+        { "thin",        { {  0.5f,  0.0f,  0.0f,  0.0f,  0.0f,  0.0f,  -1.0f,  0.3f } } },
+        { "sine",        { { -0.2f,  0.0f,  0.0f,  0.0f,  0.0f, -0.8f,   0.0f,  1.0f } } },
+        { "pure",        { {  0.0f,  0.0f,  0.0f,  0.0f, -0.2f, -0.8f,   0.0f,  1.0f } } },
+        { "puro",        { {  0.0f,  0.0f,  0.0f,  0.0f, -0.2f, -0.8f,   0.0f,  1.0f } } },
+        { "flute",       { {  0.3f, -0.3f,  0.5f,  0.2f,  0.2f, -0.6f,  -0.4f,  1.0f } } },
+        { "flauta",      { {  0.3f, -0.3f,  0.5f,  0.2f,  0.2f, -0.6f,  -0.4f,  1.0f } } },
+        { "organ",       { {  0.2f,  0.3f,  0.8f,  0.1f,  0.0f, -0.2f,   0.0f,  0.6f } } },
+        { "orgao",       { {  0.2f,  0.3f,  0.8f,  0.1f,  0.0f, -0.2f,   0.0f,  0.6f } } },
+        { "keys",        { {  0.2f,  0.6f,  0.0f,  0.2f,  0.0f, -0.3f,   0.0f,  0.4f } } },
+        { "piano",       { {  0.2f,  0.7f,  0.2f,  0.2f,  0.0f, -0.3f,   0.0f,  0.4f } } },
+        { "saw",         { {  0.6f,  0.0f,  0.0f,  0.0f,  0.0f,  0.5f,   0.0f, -1.0f } } },
+        { "buzzy",       { {  0.5f,  0.0f,  0.0f,  0.0f,  0.0f,  0.6f,   0.0f, -1.0f } } },
+        { "square",      { {  0.4f,  0.0f,  0.0f,  0.0f,  0.0f,  0.4f,   0.0f, -0.7f } } },
+        { "hollow",      { {  0.1f,  0.0f,  0.0f,  0.1f,  0.0f,  0.0f,   0.0f, -0.5f } } },
+        { "chiptune",    { {  0.6f,  0.6f, -0.2f, -0.8f,  0.0f,  0.4f,  -0.2f, -0.7f } } },
+        { "retro",       { {  0.3f,  0.3f,  0.0f, -0.3f,  0.2f,  0.3f,   0.0f, -0.5f } } },
+        { "strings",     { {  0.2f, -0.7f,  0.8f,  0.5f,  0.3f,  0.0f,   0.0f, -0.6f } } },
+        { "cordas",      { {  0.2f, -0.7f,  0.8f,  0.5f,  0.3f,  0.0f,   0.0f, -0.6f } } },
+    };
+
+    bool isNegation (const juce::String& word)
+    {
+        return word == "not" || word == "no" || word == "without" || word == "sem" || word == "nao";
+    }
+
+    // Lower-case and fold the Portuguese accents, so "não" and "metálico" match
+    juce::String foldWord (const juce::String& word)
+    {
+        return word.toLowerCase()
+                   .replaceCharacters (juce::CharPointer_UTF8 ("\xc3\xa1\xc3\xa0\xc3\xa2\xc3\xa3\xc3\xa9\xc3\xaa\xc3\xad\xc3\xb3\xc3\xb4\xc3\xb5\xc3\xba\xc3\xa7"),
+                                       "aaaaeeiooouc");
+    }
+
+    // Exact matches first, then stems, so "plucky" and "brightness" still count
+    const Word* findWord (const juce::String& word)
+    {
+        for (const auto& entry : vocabulary)
+            if (word == entry.text)
+                return &entry;
+
+        for (const auto& entry : vocabulary)
+            if (std::strlen (entry.text) >= 4 && word.startsWith (entry.text))
+                return &entry;
+
+        return nullptr;
+    }
+}
+
+bool PromptEmbedding::embed (const juce::String& text, Vector& result)
+{
+    result.fill (0.0f);
+
+    juce::StringArray words;
+    words.addTokens (text, " \t\r\n,.;:!?()[]{}\"'-/", {});
+    words.removeEmptyStrings();
+
+    bool anyKnown = false;
+    float sign = 1.0f;
+
+    for (const auto& rawWord : words)
+    {
+        const auto word = foldWord (rawWord);
+
+        if (isNegation (word))
+        {
+            sign = -1.0f;
+            continue;
+        }
+
+        if (const auto* entry = findWord (word))
+        {
+            for (size_t i = 0; i < result.size(); ++i)
+                result[i] += sign * entry->vector[i];
+
+            anyKnown = true;
+        }
+
+        sign = 1.0f;
+    }
+
+    const auto norm = std::sqrt (std::inner_product (result.begin(), result.end(), result.begin(), 0.0f));
+
+    if (! anyKnown || norm <= 1.0e-6f)
+        return false;
+
+    for (auto& v : result)
+        v /= norm;
+
+    return true;
+}
+
+float PromptEmbedding::similarity (const Vector& a, const Vector& b)
+{
+    return std::inner_product (a.begin(), a.end(), b.begin(), 0.0f);
+}
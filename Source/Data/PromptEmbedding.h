@@ -0,0 +1,43 @@
+/*
+  ==============================================================================
+
+    PromptEmbedding.h
+    Created: 18 Oct 2026 6:41:09pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Maps free text onto a handful of timbral axes using a small built-in vocabulary.
+//
+// Each known word (English or Portuguese) carries a signed weight per axis; a
+// prompt embeds to the normalised sum of its words, so "dark slow pad" and
+// "pad escuro e lento" land in the same place. Words prefixed by a negation
+// ("not", "no", "sem", "não") count against their axes.
+class PromptEmbedding
+{
+public:
+    enum Axis
+    {
+        brightness,     // + bright, airy       - dark, muffled
+        attack,         // + plucky, percussive - slow, swelling
+        length,         // + long, sustained    - short, staccato
+        space,          // + reverberant, wide  - dry, close
+        motion,         // + wobbling, evolving - static
+        grit,           // + harsh, aggressive  - clean
+        weight,         // + bass, heavy        - thin, high
+        purity,         // + sine-like, soft    - rich, buzzy
+        numAxes
+    };
+
+    using Vector = std::array<float, numAxes>;
+
+    // Returns false if none of the words are known
+    static bool embed (const juce::String& text, Vector& result);
+
+    // Cosine similarity of two embeddings, which are unit length
+    static float similarity (const Vector& a, const Vector& b);
+};
@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    QualityGovernor.cpp
+    Created: 19 Oct 2026 12:31:40am
+
+  ==============================================================================
+*/
+
+#include "QualityGovernor.h"
+
+void QualityGovernor::reset()
+{
+    smoothedLoad = 0.0f;
+    timeSinceChange = 0.0;
+    timeBelowStepUp = 0.0;
+    windowTaken = 0.0;
+    windowLength = 0.0;
+    tier.store (full);
+    load.store (0.0f);
+}
+
+void QualityGovernor::addMeasurement (const double secondsTaken, const int numSamples, const double sampleRate)
+{
+    if (numSamples <= 0 || sampleRate <= 0.0)
+        return;
+    
+    // Tiny host blocks are measured together: one of them can pay for a whole render quantum
+    windowTaken += secondsTaken;
+    windowLength += numSamples / sampleRate;
+    
+    if (windowLength < minimumWindow)
+        return;
+    
+    const auto elapsed = windowLength;
+    const auto windowLoad = (float) (windowTaken / elapsed);
+    windowTaken = 0.0;
+    windowLength = 0.0;
+    
+    if (windowLoad > 1.0f)
+        numOverruns.fetch_add (1, std::memory_order_relaxed);
+    
+    if (windowLoad > smoothedLoad)
+        smoothedLoad = windowLoad;
+    else
+        smoothedLoad += (windowLoad - smoothedLoad) * (float) (1.0 - std::exp (-elapsed / fallTime));
+    
+    load.store (smoothedLoad, std::memory_order_relaxed);
+    timeSinceChange += elapsed;
+    
+    const auto current = tier.load (std::memory_order_relaxed);
+    
+    if (smoothedLoad > stepDownLoad)
+    {
+        timeBelowStepUp = 0.0;
+        
+        if (current < numTiers - 1 && timeSinceChange >= settleTime)
+        {
+            tier.store (current + 1, std::memory_order_relaxed);
+            timeSinceChange = 0.0;
+        }
+    }
+    else if (smoothedLoad < stepUpLoad)
+    {
+        timeBelowStepUp += elapsed;
+        
+        if (current > full && timeBelowStepUp >= recoveryTime)
+        {
+            tier.store (current - 1, std::memory_order_relaxed);
+            timeSinceChange = 0.0;
+            timeBelowStepUp = 0.0;
+        }
+    }
+    else
+    {
+        timeBelowStepUp = 0.0;
+    }
+}
@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    QualityGovernor.h
+    Created: 19 Oct 2026 12:31:40am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Trades fidelity for headroom when the live audio thread runs short of time.
+//
+// After every block the processor reports how long it took. The load, time
+// taken over time available, is measured over a few milliseconds of audio at
+// a time. It rises at once but falls slowly, so one late window is enough to
+// step down a tier while stepping back up takes a couple of seconds of
+// comfortable load. The gap between the two thresholds, and a short settling
+// time after each change, keep it from hunting between tiers.
+class QualityGovernor
+{
+public:
+    // Each tier also keeps the savings of the ones before it
+    enum Tier
+    {
+        full,
+        fewerTails,         // only the loudest release tails play out
+        fastOscillators,    // approximated sines in the oscillators
+        lightReverb,        // mono reverb
+        numTiers
+    };
+    
+    void reset();
+    
+    // Audio thread, once per block
+    void addMeasurement (const double secondsTaken, const int numSamples, const double sampleRate);
+    
+    int getTier() const { return tier.load (std::memory_order_relaxed); }
+    int getNumOverruns() const { return numOverruns.load (std::memory_order_relaxed); }
+    float getLoad() const { return load.load (std::memory_order_relaxed); }
+    
+private:
+    static constexpr float stepDownLoad { 0.75f };
+    static constexpr float stepUpLoad { 0.45f };
+    static constexpr double fallTime { 0.5 };
+    static constexpr double settleTime { 0.25 };
+    static constexpr double recoveryTime { 2.0 };
+    static constexpr double minimumWindow { 0.002 };
+    
+    float smoothedLoad { 0.0f };
+    double timeSinceChange { 0.0 };
+    double timeBelowStepUp { 0.0 };
+    double windowTaken { 0.0 };
+    double windowLength { 0.0 };
+    
+    std::atomic<int> tier { full };
+    std::atomic<int> numOverruns { 0 };
+    std::atomic<float> load { 0.0f };
+};
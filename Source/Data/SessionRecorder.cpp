@@ -0,0 +1,543 @@
+/*
+  ==============================================================================
+
+    SessionRecorder.cpp
+    Created: 19 Oct 2026 3:26:48am
+
+  ==============================================================================
+*/
+
+#include "SessionRecorder.h"
+
+// Records are copied in the host's byte order, so it must match the file's
+#if JUCE_BIG_ENDIAN
+ #error "SessionRecorder writes little endian records directly"
+#endif
+
+namespace
+{
+    template <typename Type>
+    void put (juce::uint8*& dest, const Type value)
+    {
+        std::memcpy (dest, &value, sizeof (Type));
+        dest += sizeof (Type);
+    }
+    
+    template <typename Type>
+    Type get (const juce::uint8*& src)
+    {
+        Type value;
+        std::memcpy (&value, src, sizeof (Type));
+        src += sizeof (Type);
+        return value;
+    }
+    
+    int getPrepareSize (const int numParameters) { return 1 + 8 + 4 + 4 * numParameters; }
+    int getPatchSize (const int numParameters) { return 1 + 4 + 4 * numParameters; }
+    constexpr int blockHeaderSize { 1 + 4 + 1 + 2 + 2 };
+}
+
+SessionRecorder::SessionRecorder() : juce::Thread ("Session recorder")
+{
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    close();
+}
+
+bool SessionRecorder::open (const juce::File& file, const int sizeInMegabytes)
+{
+    close();
+    
+    numPages = juce::jmax (2, (int) ((juce::int64) sizeInMegabytes * 1024 * 1024 / pageSize));
+    file.deleteFile();
+    stream = std::make_unique<juce::FileOutputStream> (file);
+    
+    if (! stream->openedOk())
+    {
+        stream.reset();
+        return false;
+    }
+    
+    // Only the header page here; the writer thread allocates the ring
+    std::vector<juce::uint8> block ((size_t) pageSize, 0);
+    Header header {};
+    header.magic = magic;
+    header.version = (juce::uint16) version;
+    header.numParameters = (juce::uint16) PatchData::numParameters;
+    header.pageSize = (juce::uint32) pageSize;
+    header.numPages = (juce::uint32) numPages;
+    
+    auto* dest = block.data();
+    put (dest, header);
+    
+    for (int i = 0; i < PatchData::numParameters; ++i)
+        put (dest, PatchData::getParameterHash (i));
+    
+    stream->write (block.data(), block.size());
+    stream->flush();
+    
+    if (! stream->getStatus().wasOk())
+    {
+        stream.reset();
+        return false;
+    }
+    
+    fifoData.assign ((size_t) fifoSize, 0);
+    scratch.assign ((size_t) maxRecordSize, 0);
+    page.assign ((size_t) pageSize, 0);
+    pending.reserve ((size_t) fifoSize);
+    fifo.reset();
+    pageUsed = 0;
+    numPagesAllocated = 0;
+    pageSequence = 0;
+    hasPrepare = false;
+    numDropped.store (0);
+    
+    startThread (juce::Thread::Priority::low);
+    return true;
+}
+
+void SessionRecorder::close()
+{
+    signalThreadShouldExit();
+    notify();
+    stopThread (2000);
+    stream.reset();
+}
+
+void SessionRecorder::recordPrepare (const double sampleRate, const int maximumBlockSize, const std::array<std::atomic<float>*, PatchData::numParameters>& values)
+{
+    auto* dest = scratch.data();
+    put (dest, (juce::uint8) 'P');
+    put (dest, sampleRate);
+    put (dest, (juce::int32) maximumBlockSize);
+    
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        recordedValues[i] = values[i]->load();
+        put (dest, recordedValues[i]);
+    }
+    
+    push (scratch.data(), (int) (dest - scratch.data()));
+}
+
+void SessionRecorder::recordBlock (const int numSamples, const juce::MidiBuffer& midi, const int qualityTier,
+                                   const std::array<std::atomic<float>*, PatchData::numParameters>& values)
+{
+    auto* dest = scratch.data() + blockHeaderSize;
+    juce::uint16 numChanges = 0;
+    
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        const auto value = values[i]->load();
+        
+        if (value != recordedValues[i])
+        {
+            put (dest, (juce::uint16) i);
+            put (dest, value);
+            ++numChanges;
+        }
+    }
+    
+    const auto* midiStart = dest;
+    const auto* end = scratch.data() + scratch.size();
+    
+    for (const auto metadata : midi)
+    {
+        // Long sysex, or more MIDI than a record can hold, is cut
+        if (metadata.numBytes > 255 || dest + 3 + metadata.numBytes > end)
+        {
+            numDropped.fetch_add (1);
+            continue;
+        }
+        
+        put (dest, (juce::uint16) metadata.samplePosition);
+        put (dest, (juce::uint8) metadata.numBytes);
+        std::memcpy (dest, metadata.data, (size_t) metadata.numBytes);
+        dest += metadata.numBytes;
+    }
+    
+    const auto numMidiBytes = (juce::uint16) (dest - midiStart);
+    auto* header = scratch.data();
+    put (header, (juce::uint8) 'B');
+    put (header, (juce::int32) numSamples);
+    put (header, (juce::uint8) qualityTier);
+    put (header, numChanges);
+    put (header, numMidiBytes);
+    
+    if (! push (scratch.data(), (int) (dest - scratch.data())))
+        return;
+    
+    // Only once the record is on its way: a dropped one leaves its changes for the next block to record
+    const auto* change = scratch.data() + blockHeaderSize;
+    
+    for (int i = 0; i < numChanges; ++i)
+    {
+        const auto index = get<juce::uint16> (change);
+        recordedValues[index] = get<float> (change);
+    }
+}
+
+void SessionRecorder::recordPatch (const PatchData& patch, const float morphSeconds)
+{
+    auto* dest = scratch.data();
+    put (dest, (juce::uint8) 'M');
+    put (dest, morphSeconds);
+    
+    for (const auto value : patch.getValues())
+        put (dest, value);
+    
+    push (scratch.data(), (int) (dest - scratch.data()));
+}
+
+bool SessionRecorder::push (const juce::uint8* record, const int numBytes)
+{
+    // All or nothing, so the writer only ever sees whole records
+    if (fifo.getFreeSpace() < numBytes)
+    {
+        numDropped.fetch_add (1);
+        return false;
+    }
+    
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite (numBytes, start1, size1, start2, size2);
+    std::memcpy (fifoData.data() + start1, record, (size_t) size1);
+    
+    if (size2 > 0)
+        std::memcpy (fifoData.data() + start2, record + size1, (size_t) size2);
+    
+    fifo.finishedWrite (size1 + size2);
+    return true;
+}
+
+void SessionRecorder::run()
+{
+    // A megabyte at a time, moving records in between so the FIFO doesn't fill meanwhile
+    constexpr int pagesPerStep { (1 << 20) / pageSize };
+    
+    while (! threadShouldExit() && numPagesAllocated < numPages)
+    {
+        if (! allocatePages (juce::jmin (numPages, numPagesAllocated + pagesPerStep)))
+            break;
+        
+        drain();
+    }
+    
+    while (! threadShouldExit())
+    {
+        wait (50);
+        drain();
+    }
+    
+    drain();
+}
+
+void SessionRecorder::drain()
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead (fifo.getNumReady(), start1, size1, start2, size2);
+    pending.insert (pending.end(), fifoData.begin() + start1, fifoData.begin() + start1 + size1);
+    pending.insert (pending.end(), fifoData.begin() + start2, fifoData.begin() + start2 + size2);
+    fifo.finishedRead (size1 + size2);
+    
+    if (pending.empty())
+        return;
+    
+    for (int offset = 0; offset < (int) pending.size();)
+    {
+        const auto* record = pending.data() + offset;
+        const auto size = getRecordSize (record, (int) pending.size() - offset, PatchData::numParameters);
+        
+        if (size <= 0)
+        {
+            jassertfalse;
+            break;
+        }
+        
+        append (record, size);
+        
+        // Follow the parameters, so each new page can start with all of them
+        const auto* src = record + 1;
+        
+        if (record[0] == 'P')
+        {
+            hasPrepare = true;
+            currentSampleRate = get<double> (src);
+            currentMaximumBlockSize = get<juce::int32> (src);
+            
+            for (auto& value : currentValues)
+                value = get<float> (src);
+        }
+        else if (record[0] == 'B')
+        {
+            src = record + 6;
+            const auto numChanges = get<juce::uint16> (src);
+            src = record + blockHeaderSize;
+            
+            for (int i = 0; i < numChanges; ++i)
+            {
+                const auto index = get<juce::uint16> (src);
+                currentValues[index] = get<float> (src);
+            }
+        }
+        
+        offset += size;
+    }
+    
+    pending.clear();
+    writePage();
+}
+
+void SessionRecorder::append (const juce::uint8* record, const int numBytes)
+{
+    if (pageSequence == 0 || pageUsed + numBytes > pageSize)
+    {
+        if (pageSequence > 0)
+            writePage();
+        
+        startPage();
+    }
+    
+    std::memcpy (page.data() + pageUsed, record, (size_t) numBytes);
+    pageUsed += numBytes;
+}
+
+void SessionRecorder::startPage()
+{
+    ++pageSequence;
+    pageUsed = (int) sizeof (PageHeader);
+    
+    if (! hasPrepare)
+        return;
+    
+    auto* dest = page.data() + pageUsed;
+    put (dest, (juce::uint8) 'S');
+    put (dest, currentSampleRate);
+    put (dest, (juce::int32) currentMaximumBlockSize);
+    
+    for (const auto value : currentValues)
+        put (dest, value);
+    
+    pageUsed = (int) (dest - page.data());
+}
+
+void SessionRecorder::writePage()
+{
+    if (stream == nullptr || pageSequence == 0)
+        return;
+    
+    PageHeader header;
+    header.magic = pageMagic;
+    header.numBytes = (juce::uint32) pageUsed;
+    header.sequence = pageSequence;
+    std::memcpy (page.data(), &header, sizeof (header));
+    
+    // Page 0 of the ring comes after the header page. Pages past the end are zeroed first,
+    // so the allocation never writes over them later
+    const auto slot = (juce::int64) ((pageSequence - 1) % (juce::uint64) numPages);
+    allocatePages ((int) slot + 1);
+    stream->setPosition ((1 + slot) * pageSize);
+    stream->write (page.data(), (size_t) pageUsed);
+    stream->flush();
+}
+
+bool SessionRecorder::allocatePages (const int numNeeded)
+{
+    if (numPagesAllocated >= numNeeded)
+        return true;
+    
+    // Not page: that holds the page being filled
+    const std::vector<juce::uint8> zeros ((size_t) pageSize, 0);
+    stream->setPosition ((juce::int64) (1 + numPagesAllocated) * pageSize);
+    
+    for (; numPagesAllocated < numNeeded; ++numPagesAllocated)
+        stream->write (zeros.data(), zeros.size());
+    
+    stream->flush();
+    return stream->getStatus().wasOk();
+}
+
+int SessionRecorder::getRecordSize (const juce::uint8* record, const int available, const int numParameters)
+{
+    if (available < 1)
+        return -1;
+    
+    auto size = -1;
+    
+    switch (record[0])
+    {
+        case 'P':
+        case 'S':
+            size = getPrepareSize (numParameters);
+            break;
+        
+        case 'M':
+            size = getPatchSize (numParameters);
+            break;
+        
+        case 'B':
+        {
+            if (available < blockHeaderSize)
+                return -1;
+            
+            const auto* src = record + 6;
+            const auto numChanges = get<juce::uint16> (src);
+            const auto numMidiBytes = get<juce::uint16> (src);
+            size = blockHeaderSize + 6 * numChanges + numMidiBytes;
+            break;
+        }
+        
+        default:
+            break;
+    }
+    
+    return size <= available ? size : -1;
+}
+
+bool SessionRecorder::read (const juce::File& file, std::vector<Segment>& segments, juce::String& error)
+{
+    segments.clear();
+    juce::MemoryBlock data;
+    
+    if (! file.loadFileAsData (data))
+    {
+        error = "Could not read " + file.getFullPathName();
+        return false;
+    }
+    
+    const auto* bytes = static_cast<const juce::uint8*> (data.getData());
+    Header header {};
+    
+    if (data.getSize() >= sizeof (Header))
+        std::memcpy (&header, bytes, sizeof (Header));
+    
+    if (header.magic != magic || header.version != version || header.pageSize < sizeof (PageHeader)
+        || sizeof (Header) + 4 * (size_t) header.numParameters > header.pageSize)
+    {
+        error = "Not a session capture";
+        return false;
+    }
+    
+    // The capture's parameter order, matched to this build's by id
+    const auto numParameters = (int) header.numParameters;
+    std::vector<int> indices;
+    const auto* src = bytes + sizeof (Header);
+    
+    for (int i = 0; i < numParameters; ++i)
+        indices.push_back (PatchData::getParameterIndexForHash (get<juce::uint32> (src)));
+    
+    const auto readValues = [&indices] (const juce::uint8*& from, Values& values)
+    {
+        values.clear();
+        
+        for (const auto index : indices)
+        {
+            const auto value = get<float> (from);
+            
+            if (index >= 0)
+                values.push_back ({ index, value });
+        }
+    };
+    
+    // Oldest page first; a page the ring hadn't reached yet is still zeros
+    struct PageInfo
+    {
+        juce::uint64 sequence;
+        size_t offset;
+        int numBytes;
+    };
+    
+    std::vector<PageInfo> pages;
+    
+    for (juce::uint32 i = 0; i < header.numPages; ++i)
+    {
+        const auto offset = (size_t) (1 + i) * header.pageSize;
+        
+        if (offset + sizeof (PageHeader) > data.getSize())
+            break;
+        
+        PageHeader pageHeader;
+        std::memcpy (&pageHeader, bytes + offset, sizeof (PageHeader));
+        
+        if (pageHeader.magic == pageMagic && pageHeader.numBytes >= sizeof (PageHeader) && pageHeader.numBytes <= header.pageSize
+            && offset + pageHeader.numBytes <= data.getSize())
+            pages.push_back ({ pageHeader.sequence, offset, (int) pageHeader.numBytes });
+    }
+    
+    std::sort (pages.begin(), pages.end(), [] (const PageInfo& a, const PageInfo& b) { return a.sequence < b.sequence; });
+    
+    for (const auto& pageInfo : pages)
+    {
+        const auto* record = bytes + pageInfo.offset + sizeof (PageHeader);
+        const auto* pageEnd = bytes + pageInfo.offset + pageInfo.numBytes;
+        
+        while (record < pageEnd)
+        {
+            const auto size = getRecordSize (record, (int) (pageEnd - record), numParameters);
+            
+            if (size <= 0)
+            {
+                error = "Damaged record in page " + juce::String ((juce::int64) pageInfo.sequence);
+                return false;
+            }
+            
+            src = record + 1;
+            
+            // A snapshot only matters where reading starts; elsewhere the stream already has it
+            if (record[0] == 'P' || (record[0] == 'S' && segments.empty()))
+            {
+                Segment segment;
+                segment.sampleRate = get<double> (src);
+                segment.maximumBlockSize = get<juce::int32> (src);
+                readValues (src, segment.initialValues);
+                segments.push_back (std::move (segment));
+            }
+            else if (record[0] == 'B' && ! segments.empty())
+            {
+                Block block;
+                block.numSamples = get<juce::int32> (src);
+                block.qualityTier = get<juce::uint8> (src);
+                const auto numChanges = get<juce::uint16> (src);
+                const auto numMidiBytes = get<juce::uint16> (src);
+                
+                for (int i = 0; i < numChanges; ++i)
+                {
+                    const auto index = get<juce::uint16> (src);
+                    const auto value = get<float> (src);
+                    
+                    if (index < indices.size() && indices[index] >= 0)
+                        block.changes.push_back ({ indices[index], value });
+                }
+                
+                for (const auto* midiEnd = src + numMidiBytes; src < midiEnd;)
+                {
+                    const auto samplePosition = get<juce::uint16> (src);
+                    const auto numBytes = get<juce::uint8> (src);
+                    block.midi.addEvent (src, numBytes, samplePosition);
+                    src += numBytes;
+                }
+                
+                segments.back().blocks.push_back (std::move (block));
+            }
+            else if (record[0] == 'M' && ! segments.empty() && ! segments.back().blocks.empty())
+            {
+                auto& block = segments.back().blocks.back();
+                block.startsMorph = true;
+                block.morphSeconds = get<float> (src);
+                readValues (src, block.morphTarget);
+            }
+            
+            record += size;
+        }
+    }
+    
+    if (segments.empty())
+    {
+        error = "The capture holds no blocks";
+        return false;
+    }
+    
+    return true;
+}
@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    SessionRecorder.h
+    Created: 19 Oct 2026 3:26:48am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PatchData.h"
+
+// Records everything a live instance is fed, so a session can be replayed
+// through a headless instance and sounds and times the same.
+//
+// The audio thread packs each host block, with its size, its MIDI and the
+// parameters that changed since the last one, into a record in a preallocated
+// in-memory FIFO; it never blocks or allocates, and drops a record if the FIFO
+// is full. A background thread moves the records into a ring file of fixed
+// size, overwriting the oldest pages once it wraps. The same thread fills the
+// file out to its full size as soon as recording starts, a few pages at a time
+// between moving records, so it never grows once the ring is going round.
+//
+// File layout (little endian):
+//   Header     one page, see below, then numParameters x uint32 parameter id hash
+//   Pages      numPages x pageSize: PageHeader, then whole records
+//
+// Records:
+//   'P' prepare    float64 sample rate, int32 max block, numParameters x float
+//   'S' snapshot   same as 'P'; starts every page, so reading can begin at any page
+//   'B' block      int32 samples, uint8 quality tier, uint16 changes, uint16 MIDI bytes,
+//                  changes x (uint16 index, float value), then MIDI as (uint16 sample, uint8 size, bytes)
+//   'M' patch      float morph seconds, numParameters x float: the preceding block started morphing to it
+class SessionRecorder : private juce::Thread
+{
+public:
+    SessionRecorder();
+    ~SessionRecorder() override;
+    
+    // Writes the file's header and starts the writer, which allocates the rest of the ring
+    bool open (const juce::File& file, const int sizeInMegabytes);
+    void close();
+    bool isOpen() const { return isThreadRunning(); }
+    
+    // Audio thread, or serialised with it as prepareToPlay is
+    void recordPrepare (const double sampleRate, const int maximumBlockSize, const std::array<std::atomic<float>*, PatchData::numParameters>& values);
+    void recordBlock (const int numSamples, const juce::MidiBuffer& midi, const int qualityTier,
+                      const std::array<std::atomic<float>*, PatchData::numParameters>& values);
+    void recordPatch (const PatchData& patch, const float morphSeconds);
+    
+    // Records the audio thread couldn't fit in the FIFO, or MIDI cut from oversized blocks
+    int getNumDropped() const { return numDropped.load(); }
+    
+    // A capture read back, as runs of blocks played at one sample rate. Parameter values
+    // are (PatchData index, value); any this build doesn't know are left out
+    using Values = std::vector<std::pair<int, float>>;
+    
+    struct Block
+    {
+        int numSamples { 0 };
+        int qualityTier { 0 };
+        Values changes;
+        juce::MidiBuffer midi;
+        bool startsMorph { false };
+        Values morphTarget;
+        float morphSeconds { 0.0f };
+    };
+    
+    struct Segment
+    {
+        double sampleRate { 0.0 };
+        int maximumBlockSize { 0 };
+        Values initialValues;
+        std::vector<Block> blocks;
+    };
+    
+    // Segments in the order they were played. After the ring has wrapped, the first
+    // one starts part way through the session, from the oldest page still on disk
+    static bool read (const juce::File& file, std::vector<Segment>& segments, juce::String& error);
+    
+    static constexpr juce::uint32 magic { 0x50435354 }; // 'TSCP'
+    static constexpr int version { 1 };
+    static constexpr int pageSize { 1 << 16 };
+    
+private:
+    struct Header
+    {
+        juce::uint32 magic;
+        juce::uint16 version;
+        juce::uint16 numParameters;
+        juce::uint32 pageSize;
+        juce::uint32 numPages;
+        juce::uint8 reserved[48];
+    };
+    
+    struct PageHeader
+    {
+        juce::uint32 magic;
+        juce::uint32 numBytes;      // including this header
+        juce::uint64 sequence;      // counts up from 1 over the whole session
+    };
+    
+    static_assert (sizeof (Header) == 64, "Header layout is part of the file format");
+    static_assert (sizeof (PageHeader) == 16, "PageHeader layout is part of the file format");
+    
+    static constexpr juce::uint32 pageMagic { 0x47505354 }; // 'TSPG'
+    static constexpr int maxRecordSize { 16384 };
+    static constexpr int fifoSize { 1 << 20 };
+    
+    void run() override;
+    bool push (const juce::uint8* record, const int numBytes);
+    void drain();
+    void append (const juce::uint8* record, const int numBytes);
+    void writePage();
+    void startPage();
+    bool allocatePages (const int numNeeded);
+    
+    static int getRecordSize (const juce::uint8* record, const int available, const int numParameters);
+    
+    // Audio thread. Every record* call builds its record in scratch and diffs against
+    // recordedValues, so they rely on the host never running prepareToPlay alongside
+    // processBlock; a separate buffer for recordPrepare would still share the values
+    juce::AbstractFifo fifo { fifoSize };
+    std::vector<juce::uint8> fifoData;
+    std::vector<juce::uint8> scratch;
+    std::array<float, PatchData::numParameters> recordedValues {};
+    std::atomic<int> numDropped { 0 };
+    
+    // Writer thread
+    std::unique_ptr<juce::FileOutputStream> stream;
+    std::vector<juce::uint8> pending;
+    std::vector<juce::uint8> page;
+    int pageUsed { 0 };
+    int numPages { 0 };
+    int numPagesAllocated { 0 };
+    juce::uint64 pageSequence { 0 };
+    bool hasPrepare { false };
+    double currentSampleRate { 0.0 };
+    int currentMaximumBlockSize { 0 };
+    std::array<float, PatchData::numParameters> currentValues {};
+};
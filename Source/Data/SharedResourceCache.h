@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    SharedResourceCache.h
+    Created: 19 Oct 2026 12:58:13am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Read-only data shared by every plugin instance in the process.
+//
+// A resource is keyed by whatever it was built from: a sample rate, the content
+// of a preset bank. The first instance to ask for a key builds it, and everyone
+// asking for the same key afterwards gets that same object. The cache only keeps
+// weak references, so a resource is freed with the last instance holding it.
+// Resources are const once built, so instances can read them from any thread;
+// anything that keeps working state while it's used, such as an FFT, can't be one.
+template <typename Resource>
+class SharedResourceCache
+{
+public:
+    using Ptr = std::shared_ptr<const Resource>;
+    
+    // build() returns a new Ptr. It runs under the cache's lock, so instances asking at once never both build
+    template <typename Builder>
+    static Ptr get (const juce::String& key, Builder&& build)
+    {
+        auto& cache = getInstance();
+        const juce::ScopedLock sl (cache.lock);
+        
+        for (auto it = cache.resources.begin(); it != cache.resources.end();)
+            it = it->second.expired() ? cache.resources.erase (it) : std::next (it);
+        
+        auto& slot = cache.resources[key];
+        
+        if (auto existing = slot.lock())
+            return existing;
+        
+        Ptr resource = build();
+        slot = resource;
+        return resource;
+    }
+    
+private:
+    static SharedResourceCache& getInstance()
+    {
+        static SharedResourceCache cache;
+        return cache;
+    }
+    
+    juce::CriticalSection lock;
+    std::map<juce::String, std::weak_ptr<const Resource>> resources;
+};
@@ -0,0 +1,458 @@
+/*
+  ==============================================================================
+
+    SimilarityIndex.cpp
+    Created: 18 Oct 2026 10:02:51pm
+
+  ==============================================================================
+*/
+
+#include "SimilarityIndex.h"
+#include "AuditionPhrase.h"
+
+#if JUCE_BIG_ENDIAN
+ #error "SimilarityIndex reads its file in place and assumes a little-endian host"
+#endif
+
+namespace
+{
+    // One held middle C with its release, enough to fingerprint a patch's sound
+    const AuditionPhrase& getProbePhrase()
+    {
+        static const AuditionPhrase phrase { "probe", 1.5, { { 60, 0.8f, 0.0, 1.0 } } };
+        return phrase;
+    }
+
+    // Every index in the process, so the ones on the same file can share one update
+    struct Registry
+    {
+        juce::CriticalSection lock;
+        juce::Array<SimilarityIndex*> indices;
+    };
+
+    Registry& getRegistry()
+    {
+        static Registry registry;
+        return registry;
+    }
+}
+
+SimilarityIndex::SimilarityIndex (InstanceFactory factory)
+: juce::Thread ("Similarity index")
+, createInstance (std::move (factory))
+{
+    const juce::ScopedLock sl (getRegistry().lock);
+    getRegistry().indices.add (this);
+}
+
+SimilarityIndex::~SimilarityIndex()
+{
+    latestQuery.fetch_add (1);
+    
+    if (queryPool != nullptr)
+        queryPool->removeAllJobs (true, 10000);
+    
+    {
+        const juce::ScopedLock sl (getRegistry().lock);
+        getRegistry().indices.removeFirstMatchingValue (this);
+    }
+    
+    stopThread (10000);
+    
+    // An update cut short carries on in another index on the same file, if there is one
+    const juce::ScopedLock sl (getRegistry().lock);
+    
+    if (! isIndexing)
+        return;
+    
+    for (auto* index : getRegistry().indices)
+    {
+        if (index->indexFile == indexFile)
+        {
+            index->startIndexingLocked (bankFile);
+            return;
+        }
+    }
+}
+
+bool SimilarityIndex::open (const juce::File& file)
+{
+    const juce::ScopedWriteLock sl (lock);
+    return openLocked (file);
+}
+
+int SimilarityIndex::getNumEntries() const
+{
+    const juce::ScopedReadLock sl (lock);
+    return numEntries;
+}
+
+void SimilarityIndex::update (const PresetBank& bank)
+{
+    const juce::ScopedLock sl (getRegistry().lock);
+    startIndexingLocked (bank.getFile());
+}
+
+bool SimilarityIndex::isUpdating() const
+{
+    const juce::ScopedLock sl (getRegistry().lock);
+    
+    for (auto* index : getRegistry().indices)
+        if (index->indexFile == indexFile && index->isIndexing)
+            return true;
+    
+    return false;
+}
+
+void SimilarityIndex::startIndexingLocked (const juce::File& newBankFile)
+{
+    // A running update picks up presets added meanwhile on its next pass
+    for (auto* index : getRegistry().indices)
+    {
+        if (index->indexFile == indexFile && index->isIndexing)
+        {
+            index->bankFile = newBankFile;
+            index->hasMoreToIndex = true;
+            return;
+        }
+    }
+    
+    // Not indexing means the last update is past the lock on its way out, so this never waits on it
+    stopThread (10000);
+    bankFile = newBankFile;
+    isIndexing = true;
+    hasMoreToIndex = false;
+    startThread (juce::Thread::Priority::background);
+}
+
+bool SimilarityIndex::finishIndexing()
+{
+    const juce::ScopedLock sl (getRegistry().lock);
+    
+    if (hasMoreToIndex)
+    {
+        hasMoreToIndex = false;
+        return false;
+    }
+    
+    isIndexing = false;
+    return true;
+}
+
+std::vector<int> SimilarityIndex::findNearest (const AudioFeatureExtractor::Vector& features, const int maxResults) const
+{
+    if (maxResults <= 0)
+        return {};
+    
+    const juce::ScopedReadLock sl (lock);
+    
+    std::array<juce::int8, stride> query {};
+    quantise (features, query.data());
+    
+    // Squared L2 over int8 components; a bounded max-heap keeps the best maxResults
+    using Candidate = std::pair<int, int>;
+    std::vector<Candidate> heap;
+    heap.reserve ((size_t) maxResults + 1);
+    
+    for (int i = 0; i < numEntries; ++i)
+    {
+        const auto* entry = entries + (size_t) i * stride;
+        int distance = 0;
+        
+        for (int f = 0; f < stride; ++f)
+        {
+            const auto d = (int) entry[f] - (int) query[(size_t) f];
+            distance += d * d;
+        }
+        
+        if ((int) heap.size() < maxResults || distance < heap.front().first)
+        {
+            heap.emplace_back (distance, i);
+            std::push_heap (heap.begin(), heap.end());
+            
+            if ((int) heap.size() > maxResults)
+            {
+                std::pop_heap (heap.begin(), heap.end());
+                heap.pop_back();
+            }
+        }
+    }
+    
+    std::sort_heap (heap.begin(), heap.end());
+    
+    std::vector<int> result;
+    
+    for (const auto& candidate : heap)
+        result.push_back (candidate.second);
+    
+    return result;
+}
+
+void SimilarityIndex::findNearest (const juce::var& params, const int maxResults, QueryCallback onFound)
+{
+    const auto query = latestQuery.fetch_add (1) + 1;
+    
+    if (queryPool == nullptr)
+        queryPool = std::make_unique<juce::ThreadPool> (1);
+    
+    queryPool->addJob ([this, query, params, maxResults, onFound = std::move (onFound)]
+    {
+        if (query != latestQuery.load())
+            return;
+        
+        AudioFeatureExtractor extractor (probeSampleRate);
+        AudioFeatureExtractor::Vector features;
+        std::vector<int> presets;
+        
+        if (auto instance = createInstance (params))
+            if (computeFeatures (*instance, extractor, features))
+                presets = findNearest (features, maxResults);
+        
+        if (query != latestQuery.load())
+            return;
+        
+        juce::MessageManager::callAsync ([onFound, presets] { onFound (presets); });
+    });
+}
+
+bool SimilarityIndex::computeFeatures (juce::AudioProcessor& instance, AudioFeatureExtractor& extractor, AudioFeatureExtractor::Vector& features)
+{
+    juce::AudioBuffer<float> audio;
+    
+    if (! getProbePhrase().render (instance, audio, probeSampleRate, 512))
+        return false;
+    
+    features = extractor.process (audio);
+    return true;
+}
+
+juce::File SimilarityIndex::getFileForBank (const juce::File& bankFile)
+{
+    return bankFile.withFileExtension ("tspf");
+}
+
+void SimilarityIndex::run()
+{
+    while (! threadShouldExit())
+    {
+        // A bank of our own, so the update doesn't depend on the instance that asked for it
+        juce::File fileToIndex;
+        
+        {
+            const juce::ScopedLock sl (getRegistry().lock);
+            fileToIndex = bankFile;
+        }
+        
+        PresetBank bank;
+        bank.open (fileToIndex);
+        
+        const auto alreadyIndexed = getNumEntries();
+        const auto numPresets = bank.getNumPresets();
+        
+        if (numPresets <= alreadyIndexed)
+        {
+            if (finishIndexing())
+                return;
+            
+            continue;
+        }
+        
+        // Spread the missing presets over every core but one; each worker keeps its own extractor
+        std::vector<AudioFeatureExtractor::Vector> newFeatures ((size_t) (numPresets - alreadyIndexed));
+        std::atomic<int> next { alreadyIndexed };
+        const auto numWorkers = juce::jmax (1, juce::SystemStats::getNumCpus() - 1);
+        juce::ThreadPool pool (numWorkers);
+        
+        for (int w = 0; w < numWorkers; ++w)
+        {
+            pool.addJob ([&]
+            {
+                AudioFeatureExtractor extractor (probeSampleRate);
+                
+                for (auto i = next.fetch_add (1); i < numPresets && ! threadShouldExit(); i = next.fetch_add (1))
+                {
+                    PatchData patch;
+                    auto& features = newFeatures[(size_t) (i - alreadyIndexed)];
+                    
+                    if (! bank.getPatch (i, patch))
+                        continue;
+                    
+                    if (auto instance = createInstance (patch.toJson()))
+                        computeFeatures (*instance, extractor, features);
+                }
+            });
+        }
+        
+        while (pool.getNumJobs() > 0 && ! threadShouldExit())
+            wait (50);
+        
+        if (threadShouldExit())
+        {
+            pool.removeAllJobs (true, 10000);
+            return;
+        }
+        
+        // Stats settle once there's a decent sample; until then every update redoes them.
+        // A file that can't be written would be rendered again and again, so give up
+        // until the next update() instead
+        if (! write (newFeatures, alreadyIndexed < 64))
+        {
+            DBG ("Could not write the similarity index to " << indexFile.getFullPathName());
+            
+            const juce::ScopedLock sl (getRegistry().lock);
+            isIndexing = false;
+            return;
+        }
+        
+        const juce::ScopedLock sl (getRegistry().lock);
+        
+        for (auto* index : getRegistry().indices)
+            if (index != this && index->indexFile == indexFile)
+                index->open (indexFile);
+    }
+}
+
+bool SimilarityIndex::openLocked (const juce::File& file)
+{
+    closeLocked();
+    indexFile = file;
+    
+    if (! file.existsAsFile())
+        return false;
+    
+    auto mapping = std::make_unique<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readOnly);
+    const auto* data = static_cast<const char*> (mapping->getData());
+    const auto size = mapping->getSize();
+    
+    if (data == nullptr || size < sizeof (Header))
+        return false;
+    
+    const auto* header = reinterpret_cast<const Header*> (data);
+    
+    // A different feature layout means a different extractor; such an index is rebuilt from scratch
+    if (header->magic != magic || header->version != version || header->numFeatures != AudioFeatureExtractor::numFeatures)
+        return false;
+    
+    if (header->statsOffset % alignof (float) != 0
+        || header->statsOffset + 2 * sizeof (AudioFeatureExtractor::Vector) > size
+        || header->entriesOffset + (size_t) header->numEntries * stride > size)
+        return false;
+    
+    std::memcpy (mean.data(), data + header->statsOffset, sizeof (AudioFeatureExtractor::Vector));
+    std::memcpy (scale.data(), data + header->statsOffset + sizeof (AudioFeatureExtractor::Vector), sizeof (AudioFeatureExtractor::Vector));
+    entries = reinterpret_cast<const juce::int8*> (data + header->entriesOffset);
+    numEntries = (int) header->numEntries;
+    mappedFile = std::move (mapping);
+    
+    return true;
+}
+
+void SimilarityIndex::closeLocked()
+{
+    mappedFile.reset();
+    entries = nullptr;
+    numEntries = 0;
+}
+
+void SimilarityIndex::quantise (const AudioFeatureExtractor::Vector& features, juce::int8* dest) const
+{
+    std::memset (dest, 0, stride);
+    
+    for (int f = 0; f < AudioFeatureExtractor::numFeatures; ++f)
+    {
+        const auto z = (features[(size_t) f] - mean[(size_t) f]) * scale[(size_t) f];
+        dest[f] = (juce::int8) juce::jlimit (-127, 127, juce::roundToInt (z * quantiseScale));
+    }
+}
+
+bool SimilarityIndex::write (const std::vector<AudioFeatureExtractor::Vector>& newFeatures, const bool recomputeStats)
+{
+    const juce::ScopedWriteLock sl (lock);
+    const auto file = indexFile;
+    
+    // Before the stats change, so a failure leaves the index as it was
+    if (! file.getParentDirectory().createDirectory())
+        return false;
+    
+    // Existing entries are kept as they are unless the stats change, in which case
+    // they are dequantised with the old stats and requantised with the new ones
+    std::vector<AudioFeatureExtractor::Vector> all;
+    all.reserve ((size_t) numEntries + newFeatures.size());
+    
+    for (int i = 0; i < numEntries; ++i)
+    {
+        AudioFeatureExtractor::Vector v {};
+        
+        for (int f = 0; f < AudioFeatureExtractor::numFeatures; ++f)
+            v[(size_t) f] = scale[(size_t) f] > 0.0f ? entries[(size_t) i * stride + (size_t) f] / quantiseScale / scale[(size_t) f] + mean[(size_t) f] : mean[(size_t) f];
+        
+        all.push_back (v);
+    }
+    
+    all.insert (all.end(), newFeatures.begin(), newFeatures.end());
+    
+    if (recomputeStats || numEntries == 0)
+    {
+        for (int f = 0; f < AudioFeatureExtractor::numFeatures; ++f)
+        {
+            double sum = 0.0, sumSquares = 0.0;
+            
+            for (const auto& v : all)
+            {
+                sum += v[(size_t) f];
+                sumSquares += (double) v[(size_t) f] * v[(size_t) f];
+            }
+            
+            const auto m = sum / (double) all.size();
+            const auto variance = juce::jmax (0.0, sumSquares / (double) all.size() - m * m);
+            mean[(size_t) f] = (float) m;
+            scale[(size_t) f] = variance > 1.0e-12 ? (float) (1.0 / std::sqrt (variance)) : 0.0f;
+        }
+    }
+    
+    Header header {};
+    header.magic = magic;
+    header.version = (juce::uint16) version;
+    header.numFeatures = (juce::uint16) AudioFeatureExtractor::numFeatures;
+    header.numEntries = (juce::uint32) all.size();
+    header.statsOffset = (juce::uint32) sizeof (Header);
+    header.entriesOffset = (juce::uint32) (sizeof (Header) + 2 * sizeof (AudioFeatureExtractor::Vector) + 15) & ~15u;
+    
+    juce::TemporaryFile temp (file);
+    bool written = false;
+    
+    {
+        juce::FileOutputStream stream (temp.getFile());
+        
+        if (stream.openedOk())
+        {
+            stream.write (&header, sizeof (Header));
+            stream.write (mean.data(), sizeof (AudioFeatureExtractor::Vector));
+            stream.write (scale.data(), sizeof (AudioFeatureExtractor::Vector));
+            stream.writeRepeatedByte (0, header.entriesOffset - (sizeof (Header) + 2 * sizeof (AudioFeatureExtractor::Vector)));
+            
+            std::array<juce::int8, stride> quantised;
+            
+            for (const auto& v : all)
+            {
+                quantise (v, quantised.data());
+                stream.write (quantised.data(), stride);
+            }
+            
+            stream.flush();
+            written = ! stream.getStatus().failed();
+        }
+    }
+    
+    // The stream is closed by now, and the mapping has to go too: on Windows
+    // neither an open nor a mapped file can be replaced
+    if (written)
+    {
+        closeLocked();
+        written = temp.overwriteTargetFileWithTemporary();
+    }
+    
+    // Either way the stats and entries come back from whatever is on disk
+    openLocked (file);
+    return written;
+}
@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    SimilarityIndex.h
+    Created: 18 Oct 2026 10:02:51pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AudioFeatures.h"
+#include "PresetBank.h"
+
+// "Sounds like" index over the preset bank, kept in a memory-mapped file next to it.
+//
+// Layout (little endian):
+//   Header     64 bytes, see below
+//   Stats      numFeatures x float mean, then numFeatures x float scale
+//   Entries    numEntries x stride int8, one per bank preset in bank order
+//
+// Each entry is the preset's probe feature vector, z-scored with the stats and
+// quantised to int8, so 100k presets take under 5 MB and a brute-force scan of
+// all of them is a few million integer operations. Presets are only ever
+// appended to the bank, so updating renders just the ones the index is missing.
+//
+// Every plugin instance has an index of its own, but only one of those open on
+// the same file renders and writes it at a time; the others map the file again
+// once it has been rewritten.
+class SimilarityIndex : private juce::Thread
+{
+public:
+    using InstanceFactory = std::function<std::unique_ptr<juce::AudioProcessor> (const juce::var& params)>;
+    using QueryCallback = std::function<void (const std::vector<int>& presets)>;
+
+    explicit SimilarityIndex (InstanceFactory factory);
+    ~SimilarityIndex() override;
+
+    bool open (const juce::File& file);
+    int getNumEntries() const;
+
+    // Renders and indexes presets the index doesn't cover yet, on a background thread,
+    // or leaves them to the index in this process that is already updating the file
+    void update (const PresetBank& bank);
+    bool isUpdating() const;
+
+    // Bank indices of the closest presets, nearest first
+    std::vector<int> findNearest (const AudioFeatureExtractor::Vector& features, const int maxResults) const;
+
+    // Renders the patch's probe on a background thread, then calls back on the message thread
+    // with its closest presets. A newer query drops one that hasn't answered yet
+    void findNearest (const juce::var& params, const int maxResults, QueryCallback onFound);
+
+    // Renders the probe phrase through a patch and extracts its features
+    static bool computeFeatures (juce::AudioProcessor& instance, AudioFeatureExtractor& extractor, AudioFeatureExtractor::Vector& features);
+
+    static juce::File getFileForBank (const juce::File& bankFile);
+
+    static constexpr juce::uint32 magic { 0x46505354 }; // 'TSPF'
+    static constexpr int version { 1 };
+    static constexpr int stride { (AudioFeatureExtractor::numFeatures + 15) & ~15 };
+    static constexpr double probeSampleRate { 44100.0 };
+    static constexpr float quantiseScale { 32.0f };
+
+private:
+    struct Header
+    {
+        juce::uint32 magic;
+        juce::uint16 version;
+        juce::uint16 numFeatures;
+        juce::uint32 numEntries;
+        juce::uint32 statsOffset;
+        juce::uint32 entriesOffset;
+        juce::uint8 reserved[44];
+    };
+
+    static_assert (sizeof (Header) == 64, "Header layout is part of the file format");
+
+    void run() override;
+    void startIndexingLocked (const juce::File& newBankFile);
+    bool finishIndexing();
+    bool openLocked (const juce::File& file);
+    void closeLocked();
+    void quantise (const AudioFeatureExtractor::Vector& features, juce::int8* dest) const;
+    bool write (const std::vector<AudioFeatureExtractor::Vector>& newFeatures, const bool recomputeStats);
+
+    InstanceFactory createInstance;
+
+    // Under the process-wide lock that keeps to one update per file
+    juce::File bankFile;
+    bool isIndexing { false };
+    bool hasMoreToIndex { false };
+
+    // Created on first use, so headless instances never start threads of their own
+    std::unique_ptr<juce::ThreadPool> queryPool;
+    std::atomic<int> latestQuery { 0 };
+
+    mutable juce::ReadWriteLock lock;
+    juce::File indexFile;
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    AudioFeatureExtractor::Vector mean {};
+    AudioFeatureExtractor::Vector scale {};
+    const juce::int8* entries { nullptr };
+    int numEntries { 0 };
+};
@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+    StateData.cpp
+    Created: 18 Oct 2026 10:31:47am
+
+  ==============================================================================
+*/
+
+#include "StateData.h"
+
+StateData::StateData (juce::AudioProcessorValueTreeState& a) : apvts (a)
+{
+    // Every parameter has to be covered by PatchData, or it won't be saved
+    jassert (apvts.processor.getParameters().size() == PatchData::numParameters);
+    
+    for (auto* param : apvts.processor.getParameters())
+        param->addListener (this);
+}
+
+StateData::~StateData()
+{
+    for (auto* param : apvts.processor.getParameters())
+        param->removeListener (this);
+}
+
+void StateData::getState (juce::MemoryBlock& destData)
+{
+    const juce::ScopedLock sl (cacheLock);
+    
+    // Clear the flag before reading, so a change that lands mid-capture dirties the cache again
+    if (cacheIsDirty.exchange (false))
+    {
+        PatchData patch;
+        patch.captureFrom (apvts);
+        writeBinary (patch, cachedState);
+    }
+    
+    destData.replaceAll (cachedState.getData(), cachedState.getSize());
+}
+
+bool StateData::setState (const void* data, const int sizeInBytes, PatchData& patch)
+{
+    // Parameters missing from older states fall back to their defaults
+    patch.setToDefaults (apvts);
+    
+    // Decode the whole block before touching anything, so a bad block changes nothing
+    if (! readBinary (data, sizeInBytes, patch))
+        return false;
+    
+    // Snapped the way the parameters will store them, so the cache matches apvts once published
+    for (int i = 0; i < PatchData::numParameters; ++i)
+    {
+        if (auto* param = apvts.getParameter (PatchData::parameterIds[(size_t) i]))
+            patch.setValue (i, param->convertFrom0to1 (param->convertTo0to1 (patch.getValue (i))));
+    }
+    
+    const juce::ScopedLock sl (cacheLock);
+    writeBinary (patch, cachedState);
+    cacheIsDirty.store (false);
+    
+    return true;
+}
+
+void StateData::writeBinary (const PatchData& patch, juce::MemoryBlock& destData)
+{
+    destData.setSize (0);
+    juce::MemoryOutputStream stream (destData, false);
+    
+    stream.writeInt ((int) magic);
+    stream.writeShort ((short) version);
+    stream.writeShort ((short) PatchData::numParameters);
+    
+    for (int i = 0; i < PatchData::numParameters; ++i)
+    {
+        stream.writeInt ((int) PatchData::getParameterHash (i));
+        stream.writeFloat (patch.getValue (i));
+    }
+}
+
+bool StateData::readBinary (const void* data, const int sizeInBytes, PatchData& patch)
+{
+    constexpr int headerSize = 8;
+    constexpr int entrySize = 8;
+    
+    if (data == nullptr || sizeInBytes < headerSize)
+        return false;
+    
+    juce::MemoryInputStream stream (data, (size_t) sizeInBytes, false);
+    
+    if ((juce::uint32) stream.readInt() != magic)
+        return false;
+    
+    const auto storedVersion = (int) (juce::uint16) stream.readShort();
+    const auto numEntries = (int) (juce::uint16) stream.readShort();
+    
+    if (storedVersion > version || sizeInBytes < headerSize + numEntries * entrySize)
+        return false;
+    
+    for (int i = 0; i < numEntries; ++i)
+    {
+        const auto hash = (juce::uint32) stream.readInt();
+        const auto value = stream.readFloat();
+        const auto index = PatchData::getParameterIndexForHash (hash);
+        
+        // Unknown ids come from newer builds; skip them rather than failing the whole state
+        if (index >= 0 && std::isfinite (value))
+            patch.setValue (index, value);
+    }
+    
+    return true;
+}
+
+void StateData::parameterValueChanged (int parameterIndex, float newValue)
+{
+    cacheIsDirty.store (true);
+}
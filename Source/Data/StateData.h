@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    StateData.h
+    Created: 18 Oct 2026 10:31:47am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PatchData.h"
+
+// Versioned binary plugin state.
+//
+// Layout (little endian):
+//   uint32 magic ('TSST'), uint16 version, uint16 numEntries,
+//   numEntries x { uint32 parameter id hash, float value }
+//
+// The encoded block is cached and only rebuilt after a parameter has actually
+// changed, so the frequent getStateInformation calls from hosts are a copy.
+class StateData : private juce::AudioProcessorParameter::Listener
+{
+public:
+    StateData (juce::AudioProcessorValueTreeState& apvts);
+    ~StateData() override;
+
+    void getState (juce::MemoryBlock& destData);
+
+    // Decodes a state block into patch, snapped to the parameter ranges, without applying
+    // it: the processor hands it to the audio thread like any other patch. Until that has
+    // been published to apvts, getState returns the restored patch
+    bool setState (const void* data, const int sizeInBytes, PatchData& patch);
+
+    static void writeBinary (const PatchData& patch, juce::MemoryBlock& destData);
+    static bool readBinary (const void* data, const int sizeInBytes, PatchData& patch);
+
+    static constexpr juce::uint32 magic { 0x54535354 }; // 'TSST'
+    static constexpr int version { 1 };
+
+private:
+    void parameterValueChanged (int parameterIndex, float newValue) override;
+    void parameterGestureChanged (int parameterIndex, bool gestureIsStarting) override {}
+
+    juce::AudioProcessorValueTreeState& apvts;
+    juce::CriticalSection cacheLock;
+    juce::MemoryBlock cachedState;
+    std::atomic<bool> cacheIsDirty { true };
+};
@@ -0,0 +1,152 @@
+/*
+  ==============================================================================
+
+    StreamingPatchParser.cpp
+    Created: 18 Oct 2026 6:05:37pm
+
+  ==============================================================================
+*/
+
+#include "StreamingPatchParser.h"
+
+void StreamingPatchParser::feed (const juce::String& text, const PairCallback& onPair)
+{
+    for (auto p = text.getCharPointer(); ! p.isEmpty(); ++p)
+    {
+        const auto c = *p;
+        
+        switch (state)
+        {
+            case State::seekingKey:
+                if (c == '"')
+                {
+                    key.clear();
+                    escaped = false;
+                    state = State::inKey;
+                }
+                break;
+                
+            case State::inKey:
+                if (escaped)
+                {
+                    key += c;
+                    escaped = false;
+                }
+                else if (c == '\\')
+                {
+                    escaped = true;
+                }
+                else if (c == '"')
+                {
+                    state = State::seekingColon;
+                }
+                else
+                {
+                    key += c;
+                }
+                break;
+                
+            case State::seekingColon:
+                if (c == ':')
+                    state = State::seekingValue;
+                else if (! juce::CharacterFunctions::isWhitespace (c))
+                    state = State::seekingKey;
+                break;
+                
+            case State::seekingValue:
+                if (juce::CharacterFunctions::isWhitespace (c))
+                    break;
+                
+                token.clear();
+                
+                if (c == '"')
+                    state = State::inQuotedNumber;
+                else if (isNumberChar (c))
+                {
+                    token += c;
+                    state = State::inNumber;
+                }
+                else
+                    state = State::seekingKey;
+                break;
+                
+            case State::inNumber:
+                if (isNumberChar (c))
+                {
+                    token += c;
+                    break;
+                }
+                
+                // Anything else ends the number; a quote can only start the next key
+                emit (onPair);
+                state = State::seekingKey;
+                
+                if (c == '"')
+                {
+                    key.clear();
+                    state = State::inKey;
+                }
+                break;
+                
+            case State::inQuotedNumber:
+                if (c == '"')
+                {
+                    emit (onPair);
+                    state = State::seekingKey;
+                }
+                else if (isNumberChar (c) || juce::CharacterFunctions::isWhitespace (c))
+                {
+                    token += c;
+                }
+                else
+                {
+                    // Not a number after all, e.g. "OSC1": "Saw"; skip to the closing quote
+                    token.clear();
+                    escaped = c == '\\';
+                    state = State::skippingString;
+                }
+                break;
+                
+            case State::skippingString:
+                if (escaped)
+                    escaped = false;
+                else if (c == '\\')
+                    escaped = true;
+                else if (c == '"')
+                    state = State::seekingKey;
+                break;
+        }
+    }
+}
+
+void StreamingPatchParser::finish (const PairCallback& onPair)
+{
+    // A number is only terminated by what follows it, so the last one may still be pending
+    if (state == State::inNumber)
+        emit (onPair);
+    
+    reset();
+}
+
+void StreamingPatchParser::reset()
+{
+    state = State::seekingKey;
+    key.clear();
+    token.clear();
+    escaped = false;
+}
+
+bool StreamingPatchParser::isNumberChar (const juce::juce_wchar c)
+{
+    return juce::CharacterFunctions::isDigit (c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+void StreamingPatchParser::emit (const PairCallback& onPair)
+{
+    const auto trimmed = token.trim();
+    
+    if (key.isNotEmpty() && trimmed.containsAnyOf ("0123456789"))
+        onPair (key, trimmed.getDoubleValue());
+    
+    token.clear();
+}
@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    StreamingPatchParser.h
+    Created: 18 Oct 2026 6:05:37pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Incremental scanner for a flat JSON object of "PARAM": number pairs.
+//
+// Text can be fed in arbitrary fragments, as it streams in; each pair is reported
+// as soon as its value is complete, without waiting for the closing brace.
+// Anything that isn't a string key followed by a numeric value is skipped.
+class StreamingPatchParser
+{
+public:
+    using PairCallback = std::function<void (const juce::String& paramId, double value)>;
+
+    void feed (const juce::String& text, const PairCallback& onPair);
+    void finish (const PairCallback& onPair);
+    void reset();
+
+private:
+    enum class State
+    {
+        seekingKey,
+        inKey,
+        seekingColon,
+        seekingValue,
+        inNumber,
+        inQuotedNumber,
+        skippingString
+    };
+
+    static bool isNumberChar (const juce::juce_wchar c);
+    void emit (const PairCallback& onPair);
+
+    State state { State::seekingKey };
+    juce::String key;
+    juce::String token;
+    bool escaped { false };
+};
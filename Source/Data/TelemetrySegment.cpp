@@ -0,0 +1,236 @@
+/*
+  ==============================================================================
+
+    TelemetrySegment.cpp
+    Created: 19 Oct 2026 2:47:31am
+
+  ==============================================================================
+*/
+
+#include "TelemetrySegment.h"
+
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+ #define TAPSYNTH_POSIX_SHM 1
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <fcntl.h>
+ #include <unistd.h>
+ #include <signal.h>
+ #include <errno.h>
+ #if JUCE_MAC
+  #include <sys/sysctl.h>
+ #endif
+#else
+ #define TAPSYNTH_POSIX_SHM 0
+#endif
+
+namespace Telemetry
+{
+    // Another process reads these straight out of the mapping
+    static_assert (std::atomic<juce::int32>::is_always_lock_free && std::atomic<juce::uint32>::is_always_lock_free
+                   && std::atomic<juce::int64>::is_always_lock_free && std::atomic<float>::is_always_lock_free
+                   && std::atomic<double>::is_always_lock_free, "Telemetry needs address-free atomics");
+    
+    void Slot::write (const Stats& stats)
+    {
+        // Rounded up to even, in case a crashed owner left the slot mid-write
+        const auto start = (sequence.load (std::memory_order_relaxed) + 1) & ~1u;
+        sequence.store (start + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_release);
+        
+        load.store (stats.load, std::memory_order_relaxed);
+        rms.store (stats.rms, std::memory_order_relaxed);
+        peak.store (stats.peak, std::memory_order_relaxed);
+        activeVoices.store (stats.activeVoices, std::memory_order_relaxed);
+        numOverruns.store (stats.numOverruns, std::memory_order_relaxed);
+        qualityTier.store (stats.qualityTier, std::memory_order_relaxed);
+        blockSize.store (stats.blockSize, std::memory_order_relaxed);
+        sampleRate.store (stats.sampleRate, std::memory_order_relaxed);
+        numBlocks.store (stats.numBlocks, std::memory_order_relaxed);
+        updateTime.store (stats.updateTime, std::memory_order_relaxed);
+        
+        sequence.store (start + 2, std::memory_order_release);
+    }
+    
+    bool Slot::read (Stats& stats) const
+    {
+        for (int attempt = 0; attempt < 100; ++attempt)
+        {
+            const auto before = sequence.load (std::memory_order_acquire);
+            
+            if ((before & 1) != 0)
+                continue;
+            
+            stats.load = load.load (std::memory_order_relaxed);
+            stats.rms = rms.load (std::memory_order_relaxed);
+            stats.peak = peak.load (std::memory_order_relaxed);
+            stats.activeVoices = activeVoices.load (std::memory_order_relaxed);
+            stats.numOverruns = numOverruns.load (std::memory_order_relaxed);
+            stats.qualityTier = qualityTier.load (std::memory_order_relaxed);
+            stats.blockSize = blockSize.load (std::memory_order_relaxed);
+            stats.sampleRate = sampleRate.load (std::memory_order_relaxed);
+            stats.numBlocks = numBlocks.load (std::memory_order_relaxed);
+            stats.updateTime = updateTime.load (std::memory_order_relaxed);
+            
+            std::atomic_thread_fence (std::memory_order_acquire);
+            
+            if (sequence.load (std::memory_order_relaxed) == before)
+                return true;
+        }
+        
+        return false;
+    }
+    
+    Mapping::Mapping (const bool createIfMissing)
+    {
+       #if TAPSYNTH_POSIX_SHM
+        const auto fd = shm_open (segmentName, O_RDWR | (createIfMissing ? O_CREAT : 0), 0666);
+        
+        if (fd < 0)
+            return;
+        
+        // Growing a new segment fills it with zeros; one that is already this size is left alone
+        struct stat info;
+        
+        if (fstat (fd, &info) == 0 && info.st_size < (off_t) sizeof (Segment) && createIfMissing)
+            juce::ignoreUnused (ftruncate (fd, (off_t) sizeof (Segment)));
+        
+        if (fstat (fd, &info) == 0 && info.st_size >= (off_t) sizeof (Segment))
+        {
+            auto* address = mmap (nullptr, sizeof (Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            
+            if (address != MAP_FAILED)
+                segment = static_cast<Segment*> (address);
+        }
+        
+        close (fd);
+        
+        if (segment == nullptr)
+            return;
+        
+        // A segment from a build with another layout is left to that build
+        auto version = segment->version.load();
+        
+        if (version == 0 && createIfMissing)
+            segment->version.compare_exchange_strong (version, layoutVersion);
+        
+        if (segment->version.load() != layoutVersion)
+        {
+            munmap (segment, sizeof (Segment));
+            segment = nullptr;
+        }
+       #else
+        juce::ignoreUnused (createIfMissing);
+       #endif
+    }
+    
+    Mapping::~Mapping()
+    {
+       #if TAPSYNTH_POSIX_SHM
+        if (segment != nullptr)
+            munmap (segment, sizeof (Segment));
+       #endif
+    }
+    
+    juce::int32 getCurrentProcessId()
+    {
+       #if TAPSYNTH_POSIX_SHM
+        return (juce::int32) getpid();
+       #else
+        return 0;
+       #endif
+    }
+    
+    juce::int64 getProcessOwner (const juce::int32 processId)
+    {
+       #if TAPSYNTH_POSIX_SHM
+        if (processId <= 0)
+            return 0;
+        
+        juce::int64 startTime = 0;
+        
+        #if JUCE_LINUX
+        // Field 22 of stat, in clock ticks since boot. The name before it is in brackets and may hold spaces
+        const auto stat = juce::File ("/proc/" + juce::String (processId) + "/stat").loadFileAsString();
+        
+        if (stat.isEmpty())
+            return 0;
+        
+        startTime = juce::StringArray::fromTokens (stat.fromLastOccurrenceOf (")", false, false), true)[19].getLargeIntValue();
+        #elif JUCE_MAC
+        int name[] { CTL_KERN, KERN_PROC, KERN_PROC_PID, (int) processId };
+        kinfo_proc info {};
+        size_t size = sizeof (info);
+        
+        if (sysctl (name, 4, &info, &size, nullptr, 0) != 0 || size == 0)
+            return 0;
+        
+        startTime = (juce::int64) info.kp_proc.p_starttime.tv_sec * 1000000 + info.kp_proc.p_starttime.tv_usec;
+        #else
+        // No start time to tell a reused id by here
+        if (kill ((pid_t) processId, 0) != 0 && errno != EPERM)
+            return 0;
+        #endif
+        
+        return ((juce::int64) processId << 32) | (juce::int64) (juce::uint32) startTime;
+       #else
+        juce::ignoreUnused (processId);
+        return 0;
+       #endif
+    }
+    
+    bool isOwnerAlive (const juce::int64 owner)
+    {
+        return owner != 0 && getProcessOwner (getOwnerProcessId (owner)) == owner;
+    }
+}
+
+TelemetryPublisher::~TelemetryPublisher()
+{
+    if (slot != nullptr)
+        slot->owner.store (0);
+}
+
+void TelemetryPublisher::open()
+{
+    if (slot != nullptr)
+        return;
+    
+    mapping = std::make_unique<Telemetry::Mapping> (true);
+    auto* segment = mapping->getSegment();
+    
+    if (segment == nullptr)
+    {
+        mapping.reset();
+        return;
+    }
+    
+    static std::atomic<juce::uint32> nextInstanceId { 1 };
+    const auto thisProcess = Telemetry::getProcessOwner (Telemetry::getCurrentProcessId());
+    
+    if (thisProcess == 0)
+    {
+        mapping.reset();
+        return;
+    }
+    
+    for (auto& candidate : segment->slots)
+    {
+        auto owner = candidate.owner.load();
+        
+        // Free, or left behind by a process that crashed
+        if (Telemetry::isOwnerAlive (owner))
+            continue;
+        
+        if (candidate.owner.compare_exchange_strong (owner, thisProcess))
+        {
+            slot = &candidate;
+            slot->instanceId.store (nextInstanceId.fetch_add (1));
+            slot->write ({});
+            return;
+        }
+    }
+    
+    // Every slot is taken; this instance just goes unmonitored
+    mapping.reset();
+}
@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+    TelemetrySegment.h
+    Created: 19 Oct 2026 2:47:31am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Live stats of every plugin instance on the machine, for monitoring tools.
+//
+// All instances share one POSIX shared-memory segment holding a fixed array of
+// slots. An instance claims a free slot, or one whose process has died, and
+// then rewrites it after every block. A slot's owner is the process id together
+// with the process's start time, so a slot left by a crash isn't kept claimed
+// by whichever process is given the same id later. Each slot is a seqlock: its sequence is
+// odd while the audio thread is writing, so a reader copies the stats and
+// retries if the sequence moved. The writer never waits on a reader.
+//
+// A fresh segment is all zeros, which is already a valid empty one, so
+// whichever process gets there first doesn't need to set it up. The layout
+// is fixed: bump layoutVersion when it changes.
+namespace Telemetry
+{
+    static constexpr const char* segmentName { "/tapSynth.telemetry" };
+    static constexpr juce::uint32 layoutVersion { 2 };
+    static constexpr int numSlots { 256 };
+    
+    struct Stats
+    {
+        float load { 0.0f };            // last block's render time over its duration
+        float rms { 0.0f };
+        float peak { 0.0f };
+        juce::int32 activeVoices { 0 };
+        juce::int32 numOverruns { 0 };
+        juce::int32 qualityTier { 0 };
+        juce::int32 blockSize { 0 };
+        double sampleRate { 0.0 };
+        juce::int64 numBlocks { 0 };
+        juce::int64 updateTime { 0 };   // Time::currentTimeMillis() at the last write
+    };
+    
+    class Slot
+    {
+    public:
+        // Audio thread only, from the instance that owns the slot
+        void write (const Stats& stats);
+        
+        // Any process. False if the writer kept getting in the way
+        bool read (Stats& stats) const;
+        
+        std::atomic<juce::int64> owner { 0 };           // 0 when free
+        std::atomic<juce::uint32> instanceId { 0 };
+        
+    private:
+        std::atomic<juce::uint32> sequence { 0 };
+        std::atomic<float> load { 0.0f };
+        std::atomic<float> rms { 0.0f };
+        std::atomic<float> peak { 0.0f };
+        std::atomic<juce::int32> activeVoices { 0 };
+        std::atomic<juce::int32> numOverruns { 0 };
+        std::atomic<juce::int32> qualityTier { 0 };
+        std::atomic<juce::int32> blockSize { 0 };
+        std::atomic<double> sampleRate { 0.0 };
+        std::atomic<juce::int64> numBlocks { 0 };
+        std::atomic<juce::int64> updateTime { 0 };
+    };
+    
+    struct Segment
+    {
+        std::atomic<juce::uint32> version { 0 };
+        Slot slots[numSlots];
+    };
+    
+    // Maps the segment into this process for as long as it lives
+    class Mapping
+    {
+    public:
+        // Only a publisher creates the segment; readers find nothing until one has run
+        explicit Mapping (const bool createIfMissing);
+        ~Mapping();
+        
+        Segment* getSegment() const { return segment; }
+        
+    private:
+        Segment* segment { nullptr };
+        
+        JUCE_DECLARE_NON_COPYABLE (Mapping)
+    };
+    
+    juce::int32 getCurrentProcessId();
+    
+    // The process id in the high half and its start time in the low one, or 0 if no such process is running
+    juce::int64 getProcessOwner (const juce::int32 processId);
+    inline juce::int32 getOwnerProcessId (const juce::int64 owner) { return (juce::int32) (owner >> 32); }
+    
+    // True while the very process that claimed a slot is still running
+    bool isOwnerAlive (const juce::int64 owner);
+}
+
+// One instance's slot in the segment
+class TelemetryPublisher
+{
+public:
+    ~TelemetryPublisher();
+    
+    // Claims a slot. Does nothing on platforms without POSIX shared memory
+    void open();
+    
+    bool isOpen() const { return slot != nullptr; }
+    
+    // Audio thread, once per block; wait-free
+    void publish (const Telemetry::Stats& stats) { slot->write (stats); }
+    
+private:
+    std::unique_ptr<Telemetry::Mapping> mapping;
+    Telemetry::Slot* slot { nullptr };
+};
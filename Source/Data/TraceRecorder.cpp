@@ -0,0 +1,217 @@
+/*
+  ==============================================================================
+
+    TraceRecorder.cpp
+    Created: 19 Oct 2026 2:14:05am
+
+  ==============================================================================
+*/
+
+#include "TraceRecorder.h"
+
+std::atomic<bool> TraceRecorder::recording { false };
+
+namespace
+{
+    struct Event
+    {
+        const char* name;
+        juce::int64 startTicks;
+        juce::int64 durationTicks;
+        int value;
+        char phase;
+    };
+    
+    struct ThreadBuffer
+    {
+        static constexpr int capacity { 1 << 15 };
+        
+        std::array<Event, capacity> events;
+        std::atomic<juce::uint32> numWritten { 0 };     // wraps round the ring
+        char threadName[64] {};
+    };
+    
+    struct Session
+    {
+        // Threads past this many record nothing
+        static constexpr int maxThreads { 32 };
+        
+        juce::CriticalSection lock;
+        int numSessionUsers { 0 };
+        juce::File file;
+        juce::int64 startTicks { 0 };
+        std::atomic<int> generation { 0 };
+        std::atomic<int> numClaimed { 0 };
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    };
+    
+    Session& getSession()
+    {
+        static Session session;
+        return session;
+    }
+    
+    ThreadBuffer* getThreadBuffer()
+    {
+        struct Claim
+        {
+            int generation { -1 };
+            ThreadBuffer* buffer { nullptr };
+        };
+        
+        thread_local Claim claim;
+        auto& session = getSession();
+        const auto generation = session.generation.load (std::memory_order_acquire);
+        
+        if (claim.generation == generation)
+            return claim.buffer;
+        
+        claim.generation = generation;
+        claim.buffer = nullptr;
+        const auto index = session.numClaimed.fetch_add (1);
+        
+        if (index >= (int) session.buffers.size())
+            return nullptr;
+        
+        auto* buffer = session.buffers[(size_t) index].get();
+        
+        // Copied without making a String, which could allocate
+        if (juce::MessageManager::existsAndIsCurrentThread())
+            juce::CharPointer_UTF8 (buffer->threadName).writeAll (juce::CharPointer_ASCII ("Message thread"));
+        else if (auto* thread = juce::Thread::getCurrentThread())
+            thread->getThreadName().copyToUTF8 (buffer->threadName, sizeof (buffer->threadName));
+        else
+            juce::CharPointer_UTF8 (buffer->threadName).writeAll (juce::CharPointer_ASCII ("Host audio"));
+        
+        claim.buffer = buffer;
+        return buffer;
+    }
+    
+    void addEvent (const Event& event)
+    {
+        if (auto* buffer = getThreadBuffer())
+        {
+            const auto index = buffer->numWritten.load (std::memory_order_relaxed);
+            buffer->events[(size_t) (index % ThreadBuffer::capacity)] = event;
+            buffer->numWritten.store (index + 1, std::memory_order_release);
+        }
+    }
+    
+    bool writeChromeTrace (const Session& session)
+    {
+        juce::FileOutputStream out (session.file);
+        
+        if (! out.openedOk() || ! out.setPosition (0) || ! out.truncate().wasOk())
+            return false;
+        
+        const auto toMicros = [&session] (const juce::int64 ticks)
+        {
+            return juce::String (juce::Time::highResolutionTicksToSeconds (ticks - session.startTicks) * 1.0e6, 3);
+        };
+        
+        const auto numThreads = juce::jmin (session.numClaimed.load(), (int) session.buffers.size());
+        const auto processId = juce::String (1);    // one process per trace
+        auto first = true;
+        
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        
+        const auto separate = [&first, &out]
+        {
+            out << (first ? "\n" : ",\n");
+            first = false;
+        };
+        
+        for (int t = 0; t < numThreads; ++t)
+        {
+            const auto& buffer = *session.buffers[(size_t) t];
+            const auto threadId = juce::String (t + 1);
+            
+            separate();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << processId << ",\"tid\":" << threadId
+                << ",\"args\":{\"name\":" << juce::JSON::toString (juce::String (buffer.threadName)) << "}}";
+            
+            // Only the newest capacity events are still in the ring
+            const auto numWritten = buffer.numWritten.load (std::memory_order_acquire);
+            const auto firstKept = numWritten > (juce::uint32) ThreadBuffer::capacity ? numWritten - ThreadBuffer::capacity : 0u;
+            
+            for (auto i = firstKept; i < numWritten; ++i)
+            {
+                const auto& event = buffer.events[(size_t) (i % ThreadBuffer::capacity)];
+                
+                separate();
+                out << "{\"name\":" << juce::JSON::toString (juce::String (event.name))
+                    << ",\"cat\":\"tapSynth\",\"ph\":\"" << juce::String::charToString (event.phase)
+                    << "\",\"ts\":" << toMicros (event.startTicks)
+                    << ",\"pid\":" << processId << ",\"tid\":" << threadId;
+                
+                if (event.phase == 'X')
+                    out << ",\"dur\":" << juce::String (juce::Time::highResolutionTicksToSeconds (event.durationTicks) * 1.0e6, 3);
+                else
+                    out << ",\"s\":\"t\"";
+                
+                if (event.value >= 0)
+                    out << ",\"args\":{\"value\":" << event.value << "}";
+                
+                out << "}";
+            }
+        }
+        
+        out << "\n]}\n";
+        out.flush();
+        return out.getStatus().wasOk();
+    }
+}
+
+void TraceRecorder::beginSession()
+{
+    auto& session = getSession();
+    const juce::ScopedLock sl (session.lock);
+    
+    if (session.numSessionUsers++ > 0)
+        return;
+    
+    const auto path = juce::SystemStats::getEnvironmentVariable ("TAPSYNTH_TRACE_FILE", {});
+    
+    if (path.isEmpty())
+        return;
+    
+    session.file = juce::File::getCurrentWorkingDirectory().getChildFile (path);
+    
+    // Allocated here, once per session, so no thread ever allocates to record
+    while ((int) session.buffers.size() < Session::maxThreads)
+        session.buffers.push_back (std::make_unique<ThreadBuffer>());
+    
+    for (auto& buffer : session.buffers)
+        buffer->numWritten.store (0);
+    
+    session.numClaimed.store (0);
+    session.startTicks = juce::Time::getHighResolutionTicks();
+    session.generation.fetch_add (1, std::memory_order_release);
+    recording.store (true);
+}
+
+void TraceRecorder::endSession()
+{
+    auto& session = getSession();
+    const juce::ScopedLock sl (session.lock);
+    
+    if (--session.numSessionUsers > 0 || ! recording.load())
+        return;
+    
+    recording.store (false);
+    
+    if (! writeChromeTrace (session))
+        DBG ("Could not write the trace to " << session.file.getFullPathName());
+}
+
+void TraceRecorder::addComplete (const char* name, const juce::int64 startTicks, const juce::int64 endTicks)
+{
+    if (isRecording())
+        addEvent ({ name, startTicks, endTicks - startTicks, -1, 'X' });
+}
+
+void TraceRecorder::addInstant (const char* name, const int value)
+{
+    if (isRecording())
+        addEvent ({ name, juce::Time::getHighResolutionTicks(), 0, value, 'i' });
+}
@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    TraceRecorder.h
+    Created: 19 Oct 2026 2:14:05am
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Tracing is compiled out unless the project defines TAPSYNTH_TRACING=1
+#ifndef TAPSYNTH_TRACING
+ #define TAPSYNTH_TRACING 0
+#endif
+
+// Timestamped events from every thread, written out as a Chrome trace.
+//
+// Each thread that records gets a buffer of its own from a pool made when the
+// session starts, so recording never locks or allocates: it writes the event
+// and bumps that thread's counter. The buffers are rings, so a long session
+// keeps the most recent events of each thread. Event names are not copied and
+// must be string literals.
+//
+// With tracing compiled in, a session runs while any non-headless processor is
+// alive and the TAPSYNTH_TRACE_FILE environment variable names the file to
+// write. The file is written when the last of them goes; load it in
+// chrome://tracing or ui.perfetto.dev. Headless instances come and go too often
+// to own a session, but record into the one that's running.
+class TraceRecorder
+{
+public:
+    static void beginSession();
+    static void endSession();
+    
+    static bool isRecording() { return recording.load (std::memory_order_relaxed); }
+    
+    // Something that took from startTicks to endTicks, in Time::getHighResolutionTicks()
+    static void addComplete (const char* name, const juce::int64 startTicks, const juce::int64 endTicks);
+    
+    // Something that happened just now, with an optional value shown alongside it
+    static void addInstant (const char* name, const int value = -1);
+    
+    class Scope
+    {
+    public:
+        explicit Scope (const char* n) : name (n), startTicks (isRecording() ? juce::Time::getHighResolutionTicks() : 0) {}
+        
+        ~Scope()
+        {
+            if (startTicks != 0)
+                addComplete (name, startTicks, juce::Time::getHighResolutionTicks());
+        }
+        
+    private:
+        const char* name;
+        const juce::int64 startTicks;
+        
+        JUCE_DECLARE_NON_COPYABLE (Scope)
+    };
+    
+private:
+    static std::atomic<bool> recording;
+};
+
+#if TAPSYNTH_TRACING
+ #define TAPSYNTH_TRACE_SCOPE(name) const TraceRecorder::Scope JUCE_JOIN_MACRO (traceScope, __LINE__) (name)
+ #define TAPSYNTH_TRACE_INSTANT(name, value) TraceRecorder::addInstant (name, value)
+ #define TAPSYNTH_TRACE_BEGIN_SESSION() TraceRecorder::beginSession()
+ #define TAPSYNTH_TRACE_END_SESSION() TraceRecorder::endSession()
+#else
+ #define TAPSYNTH_TRACE_SCOPE(name)
+ #define TAPSYNTH_TRACE_INSTANT(name, value)
+ #define TAPSYNTH_TRACE_BEGIN_SESSION()
+ #define TAPSYNTH_TRACE_END_SESSION()
+#endif
@@ -9,10 +9,12 @@ TapSynthAudioProcessorEditor::TapSynthAudioProcessorEditor (TapSynthAudioProcess
 , osc2 (audioProcessor.apvts, "OSC2", "OSC2GAIN", "OSC2PITCH", "OSC2FMFREQ", "OSC2FMDEPTH")
 , filter (audioProcessor.apvts, "FILTERTYPE", "FILTERCUTOFF", "FILTERRESONANCE")
 , adsr (audioProcessor.apvts, "ATTACK", "DECAY", "SUSTAIN", "RELEASE")
-, lfo1 (audioProcessor.apvts, "LFO1FREQ", "LFO1DEPTH")
+, lfo1 (audioProcessor.apvts, "LFO1FREQ", "LFO1DEPTH", "LFO1MODE")
 , filterAdsr (audioProcessor.apvts, "FILTERATTACK", "FILTERDECAY", "FILTERSUSTAIN", "FILTERRELEASE")
 , reverb (audioProcessor.apvts, "REVERBSIZE", "REVERBDAMPING", "REVERBWIDTH", "REVERBDRY", "REVERBWET", "REVERBFREEZE")
 , meter (audioProcessor)
+, presetBrowser (audioProcessor)
+, previews (audioProcessor)
 {
     
     addAndMakeVisible (osc1);
@@ -23,8 +25,12 @@ TapSynthAudioProcessorEditor::TapSynthAudioProcessorEditor (TapSynthAudioProcess
     addAndMakeVisible (filterAdsr);
     addAndMakeVisible (reverb);
     addAndMakeVisible (meter);
+    addAndMakeVisible (presetBrowser);
     addAndMakeVisible(promptBox);
     addAndMakeVisible(sendButton);
+    addAndMakeVisible(variationsButton);
+    addAndMakeVisible(previews);
+    addAndMakeVisible(morphTimeSlider);
     
 
     promptBox.setMultiLine(false);
@@ -34,6 +40,15 @@ TapSynthAudioProcessorEditor::TapSynthAudioProcessorEditor (TapSynthAudioProcess
     promptBox.setColour(juce::TextEditor::textColourId, juce::Colours::white);
     promptBox.setColour(juce::TextEditor::outlineColourId, juce::Colours::darkgrey);
 
+    // How long a new patch (prompt or preset) takes to morph in
+    morphTimeSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+    morphTimeSlider.setTextBoxStyle(juce::Slider::TextBoxRight, false, 60, 20);
+    morphTimeSlider.setRange(0.0, 5.0, 0.05);
+    morphTimeSlider.setTextValueSuffix(" s");
+    morphTimeSlider.setTooltip("Morph time");
+    morphTimeSlider.setValue(audioProcessor.getMorphTime(), juce::dontSendNotification);
+    morphTimeSlider.onValueChange = [this]() { audioProcessor.setMorphTime((float) morphTimeSlider.getValue()); };
+
     osc1.setName ("Oscillator 1");
     osc2.setName ("Oscillator 2");
     filter.setName ("Filtro");
@@ -41,6 +56,7 @@ TapSynthAudioProcessorEditor::TapSynthAudioProcessorEditor (TapSynthAudioProcess
     filterAdsr.setName ("Filtro ADSR");
     adsr.setName ("ADSR");
     meter.setName ("Meter");
+    presetBrowser.setName ("Presets");
     
     auto oscColour = juce::Colour::fromRGB (247, 190, 67);
     auto filterColour = juce::Colour::fromRGB (246, 87, 64);
@@ -54,29 +70,40 @@ TapSynthAudioProcessorEditor::TapSynthAudioProcessorEditor (TapSynthAudioProcess
         
     // hook up the button
     sendButton.onClick = [this]() { sendPrompt(); };
+    variationsButton.onClick = [this]() { sendPrompt(true); };
+    audioProcessor.getPatchRequestService().addListener(this);
 
     startTimerHz (30);
-    setSize (1066, 600);
+    setSize (1306, 640);
 }
 
 TapSynthAudioProcessorEditor::~TapSynthAudioProcessorEditor()
 {
     stopTimer();
+
+    // Nothing is left to show the answer to
+    audioProcessor.getPatchRequestService().removeListener(this);
+    audioProcessor.getPatchRequestService().cancelAll();
 }
 
 //==============================================================================
 void TapSynthAudioProcessorEditor::paint (juce::Graphics& g)
 {
+    TAPSYNTH_TRACE_SCOPE ("Editor paint");
     g.fillAll (juce::Colours::black);
 }
 
 void TapSynthAudioProcessorEditor::resized()
 {
     auto bounds = getLocalBounds();
+    presetBrowser.setBounds (bounds.removeFromRight (240));
 
     auto bottomArea = bounds.removeFromBottom(80);
     bottomArea = bottomArea.reduced(0, 9);
+    previews.setBounds(bounds.removeFromBottom(40));
 
+    morphTimeSlider.setBounds(bottomArea.removeFromRight(180).reduced(5));
+    variationsButton.setBounds(bottomArea.removeFromRight(80).reduced(5));
     promptBox.setBounds(bottomArea.removeFromLeft(bottomArea.getWidth() - 80).reduced(5));
     sendButton.setBounds(bottomArea.reduced(5));
 
@@ -100,7 +127,7 @@ void TapSynthAudioProcessorEditor::timerCallback()
 
 
 // sendPrompt implementation
-void TapSynthAudioProcessorEditor::sendPrompt()
+void TapSynthAudioProcessorEditor::sendPrompt(const bool wantsVariations)
 {
     const juce::String promptText = promptBox.getText().trim();
 
@@ -114,201 +141,29 @@ void TapSynthAudioProcessorEditor::sendPrompt()
         return;
     }
 
-    const juce::String apiKey   = "";
-    const juce::String modelId  = "gemini-flash-latest"; // HERE HERE HERE "gemini-2.5-flash" if things go bad
-    const juce::String endpoint =
-        "https://generativelanguage.googleapis.com/v1beta/models/"
-        + modelId
-        + ":generateContent";
-
-
-
-    sendButton.setEnabled(false);
+    // Network, parsing and validation all happen on the processor's request thread;
+    // sending again while a request is running supersedes it
+    pendingRequestId = audioProcessor.getPatchRequestService().submit(promptText, wantsVariations ? PreviewComponent::maxPreviews : 0);
     sendButton.setButtonText("Gerando...");
+}
 
-    TapSynthAudioProcessor& processor = audioProcessor;
-    const juce::String promptCopy = promptText;
-    const juce::String endpointCopy = endpoint;
-
-    std::thread([promptCopy, endpointCopy, apiKey, &processor, this]()
-    {
-        juce::String responseBody;
-        juce::String errorMsg;
-
-        // --- Build Gemini JSON ---
-        juce::String jsonPrompt =
-            "You are an assistant that controls a synthesizer by returning ONLY valid JSON. "
-            "Your output will be parsed by a machine. YOU MUST FOLLOW THESE RULES:\n"
-            "\n"
-            "STRICT RULES:\n"
-            "1. Output ONLY a JSON object.\n"
-            "2. No text before or after the JSON.\n"
-            "3. No explanations, no comments, no code blocks.\n"
-            "4. Use ONLY the parameter IDs listed below.\n"
-            "5. Clamp all values inside the ranges provided.\n"
-            "6. If the user gives a musical description, convert it into sensible parameter values.\n"
-            "\n"
-            "PARAMETER DEFINITIONS:\n"
-            "CHOICE PARAMETERS (INTEGER INDEX):\n"
-            "\"OSC1\": 0=Sine, 1=Saw, 2=Square\n"
-            "\"OSC2\": 0=Sine, 1=Saw, 2=Square\n"
-            "\"FILTERTYPE\": 0=Low Pass, 1=Band Pass, 2=High Pass\n"
-            "\n"
-            "FLOAT PARAMETERS:\n"
-            "\"OSC1GAIN\": -40.0 to 0.2\n"
-            "\"OSC2GAIN\": -40.0 to 0.2\n"
-            "\"OSC1PITCH\": -48 to 48\n"
-            "\"OSC2PITCH\": -48 to 48\n"
-            "\"OSC1FMFREQ\": 0.0 to 1000.0\n"
-            "\"OSC2FMFREQ\": 0.0 to 1000.0\n"
-            "\"OSC1FMDEPTH\": 0.0 to 100.0\n"
-            "\"OSC2FMDEPTH\": 0.0 to 100.0\n"
-            "\"LFO1FREQ\": 0.0 to 20.0\n"
-            "\"LFO1DEPTH\": 0.0 to 10000.0\n"
-            "\"FILTERCUTOFF\": 20.0 to 20000.0\n"
-            "\"FILTERRESONANCE\": 0.1 to 2.0\n"
-            "\"ATTACK\": 0.1 to 1.0\n"
-            "\"DECAY\": 0.1 to 1.0\n"
-            "\"SUSTAIN\": 0.1 to 1.0\n"
-            "\"RELEASE\": 0.1 to 3.0\n"
-            "\"FILTERADSRDEPTH\": 0.0 to 10000.0\n"
-            "\"FILTERATTACK\": 0.0 to 1.0\n"
-            "\"FILTERDECAY\": 0.0 to 1.0\n"
-            "\"FILTERSUSTAIN\": 0.0 to 1.0\n"
-            "\"FILTERRELEASE\": 0.0 to 3.0\n"
-            "\"REVERBSIZE\": 0.0 to 1.0\n"
-            "\"REVERBWIDTH\": 0.0 to 1.0\n"
-            "<<HIDDEN>> ?? The user did not include product information\n\n"
-            "\"REVERBDAMPING\": 0.0 to 1.0\n"
-            "\"REVERBDRY\": 0.0 to 1.0\n"
-            "\"REVERBWET\": 0.0 to 1.0\n"
-            "\"REVERBFREEZE\": 0.0 to 1.0\n"
-            "\n"
-            "OUTPUT FORMAT:\n"
-            "Return ONLY something like this:\n"
-            "{\n"
-            "  \"OSC1\": 1,\n"
-            "  \"OSC2\": 0,\n"
-            "  \"OSC1GAIN\": -12.5,\n"
-            "  \"OSC2GAIN\": -9.0,\n"
-            "  \"FILTERCUTOFF\": 645.0,\n"
-            "  \"ATTACK\": 0.2,\n"
-            "  \"REVERBWET\": 0.35\n"
-            "}\n"
-            "\n"
-            "USER REQUEST:\n" +
-            promptCopy;
-
-        juce::DynamicObject* textObj = new juce::DynamicObject();
-        textObj->setProperty("text", jsonPrompt);
-
-
-        juce::DynamicObject* partObj = new juce::DynamicObject();
-        partObj->setProperty("parts", juce::Array<juce::var>{ juce::var(textObj) });
-
-        juce::Array<juce::var> contentsArr;
-        contentsArr.add(juce::var(partObj));
-
-        juce::DynamicObject* rootObj = new juce::DynamicObject();
-        rootObj->setProperty("contents", contentsArr);
-
-        const juce::String body = juce::JSON::toString(juce::var(rootObj));
-
-        try
-        {
-            juce::URL url(endpointCopy);
-
-            juce::String headers;
-            headers << "Content-Type: application/json\r\n";
-            headers << "x-goog-api-key: " << apiKey << "\r\n";
-
-            std::unique_ptr<juce::InputStream> stream =
-                url.withPOSTData(body)
-                   .createInputStream(
-                       juce::URL::InputStreamOptions(juce::URL::ParameterHandling::inPostData)
-                           .withHttpRequestCmd("POST")
-                           .withExtraHeaders(headers)
-                           .withConnectionTimeoutMs(15000)
-                           .withNumRedirectsToFollow(2)
-                   );
-
-            if (stream == nullptr)
-                errorMsg = "Could not open network stream.";
-            else
-                responseBody = stream->readEntireStreamAsString();
-        }
-        catch (const std::exception& e)
-        {
-            errorMsg = e.what();
-        }
-        catch (...)
-        {
-            errorMsg = "Unknown network error.";
-        }
-        
-        juce::MessageManager::callAsync([this, &processor, responseBody, errorMsg]()
-        {
-            sendButton.setEnabled(true);
-            sendButton.setButtonText("Enviar");
-
-            if (! errorMsg.isEmpty())
-            {
-                juce::AlertWindow::showMessageBoxAsync(
-                    juce::AlertWindow::WarningIcon,
-                    "Network Error",
-                    errorMsg
-                );
-                return;
-            }
-
-            juce::var parsed = juce::JSON::parse(responseBody);
-            if (! parsed.isObject())
-            {
-                juce::AlertWindow::showMessageBoxAsync(
-                    juce::AlertWindow::WarningIcon,
-                    "JSON Error",
-                    "Invalid JSON:\n" + responseBody
-                );
-                return;
-            }
-
-            auto* root = parsed.getDynamicObject();
-            auto candidates = root->getProperty("candidates");
-
-            if (! candidates.isArray() || candidates.getArray()->isEmpty())
-            {
-                juce::AlertWindow::showMessageBoxAsync(
-                    juce::AlertWindow::WarningIcon,
-                    "API Error",
-                    "Unexpected response:\n" + responseBody
-                );
-                return;
-            }
-
-            auto* candObj = candidates.getArray()->getFirst().getDynamicObject();
-            auto content  = candObj->getProperty("content");
-
-            if (! content.isObject())
-                return;
-
-            auto parts = content.getDynamicObject()->getProperty("parts");
-            if (! parts.isArray() || parts.getArray()->isEmpty())
-                return;
+void TapSynthAudioProcessorEditor::patchRequestFinished(const PatchRequestService::Result& result)
+{
+    if (result.requestId != pendingRequestId)
+        return;
 
-            auto* part0 = parts.getArray()->getFirst().getDynamicObject();
-            juce::String jsonParams = part0->getProperty("text").toString();
+    pendingRequestId = 0;
+    sendButton.setButtonText("Enviar");
 
-            juce::var params = juce::JSON::parse(jsonParams);
-            if (params.isObject())
-                processor.applyParametersFromJson(params);
-            else
-                juce::AlertWindow::showMessageBoxAsync(
-                    juce::AlertWindow::WarningIcon,
-                    "Parse Error",
-                    "Returned text was not valid JSON:\n" + jsonParams
-                );
-        });
+    if (! result.variations.isEmpty())
+        audioProcessor.renderPreviews(result.variations);
 
-    }).detach();
+    if (result.status == PatchRequestService::Status::failed)
+    {
+        juce::AlertWindow::showMessageBoxAsync(
+            juce::AlertWindow::WarningIcon,
+            "Network Error",
+            result.error
+        );
+    }
 }
-
@@ -16,14 +16,16 @@
 #include "UI/LfoComponent.h"
 #include "UI/ReverbComponent.h"
 #include "UI/MeterComponent.h"
+#include "UI/PresetBrowserComponent.h"
+#include "UI/PreviewComponent.h"
 #include "UI/Assets.h"
-#include <thread>
 
 //==============================================================================
 /**
 */
 class TapSynthAudioProcessorEditor  : public juce::AudioProcessorEditor
 , public juce::Timer
+, private PatchRequestService::Listener
 {
 public:
     TapSynthAudioProcessorEditor (TapSynthAudioProcessor&);
@@ -45,11 +47,19 @@ private:
     AdsrComponent filterAdsr;
     ReverbComponent reverb;
     MeterComponent meter;
+    PresetBrowserComponent presetBrowser;
     juce::TextEditor promptBox;
     juce::TextButton sendButton{ "Enviar" };
+    juce::TextButton variationsButton{ "Variar" };
+    PreviewComponent previews;
+    juce::Slider morphTimeSlider;
 
-    // send the prompt text to the configured REST endpoint (runs network on background thread)
-    void sendPrompt();
+    int pendingRequestId { 0 };
+
+    // send the prompt text to the processor's request service (runs network on background thread);
+    // with variations, the candidates are rendered for audition instead of applied
+    void sendPrompt(const bool wantsVariations = false);
+    void patchRequestFinished(const PatchRequestService::Result& result) override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TapSynthAudioProcessorEditor)
 };
@@ -3,7 +3,7 @@
 #include <algorithm>
 
 //==============================================================================
-TapSynthAudioProcessor::TapSynthAudioProcessor()
+TapSynthAudioProcessor::TapSynthAudioProcessor (const bool isHeadless, const bool isIsolated)
 #ifndef JucePlugin_PreferredChannelConfigurations
      : AudioProcessor (BusesProperties()
                      #if ! JucePlugin_IsMidiEffect
@@ -13,19 +13,64 @@ TapSynthAudioProcessor::TapSynthAudioProcessor()
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
                        ), apvts (*this, nullptr, "Parameters", createParams())
+                        , headless (isHeadless)
 #endif
 {
     synth.addSound (new SynthSound());
+    synth.setMinimumRenderingSubdivisionSize (quantumSize, true);
     
     for (int i = 0; i < 5; i++)
     {
-        synth.addVoice (new SynthVoice());
+        auto* voice = new SynthVoice();
+        voice->setLfo (&lfo, i);
+        voice->setSynth (&synth);
+        synth.addVoice (voice);
+    }
+    
+    for (int i = 0; i < PatchData::numParameters; ++i)
+    {
+        parameters[(size_t) i] = apvts.getParameter (PatchData::parameterIds[(size_t) i]);
+        rawParameters[(size_t) i] = apvts.getRawParameterValue (PatchData::parameterIds[(size_t) i]);
+        jassert (parameters[(size_t) i] != nullptr && rawParameters[(size_t) i] != nullptr);
+    }
+    
+    blockPatch.captureFrom (apvts);
+    
+    if (! isHeadless)
+    {
+        TAPSYNTH_TRACE_BEGIN_SESSION();
+        
+        if (isIsolated)
+            return;
+        
+        presetBank.open (PresetBank::getDefaultFile());
+        rebuildOfflineModel();
+        
+        similarityIndex.open (SimilarityIndex::getFileForBank (presetBank.getFile()));
+        similarityIndex.update (presetBank);
+        
+        telemetry.open();
+        
+        // A new file per instance and run, so an earlier capture isn't lost to a restart
+        const auto capturePath = juce::SystemStats::getEnvironmentVariable ("TAPSYNTH_CAPTURE_FILE", {});
+        
+        if (capturePath.isNotEmpty())
+        {
+            auto captureFile = juce::File::getCurrentWorkingDirectory().getChildFile (capturePath);
+            recorder.open (captureFile.existsAsFile() ? captureFile.getNonexistentSibling (false) : captureFile, captureSizeInMegabytes);
+        }
     }
 }
 
 TapSynthAudioProcessor::~TapSynthAudioProcessor()
 {
+    cancelPendingUpdate();
     
+    // Braced: with tracing compiled out the macro is empty
+    if (! headless)
+    {
+        TAPSYNTH_TRACE_END_SESSION();
+    }
 }
 
 //==============================================================================
@@ -68,41 +113,164 @@ double TapSynthAudioProcessor::getTailLengthSeconds() const
 
 int TapSynthAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    // NB: some hosts don't cope very well if you tell them there are 0 programs,
+    // so this should be at least 1, even if the bank is empty.
+    return juce::jmax (1, presetBank.getNumPresets());
 }
 
 int TapSynthAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram.load();
 }
 
 void TapSynthAudioProcessor::setCurrentProgram (int index)
 {
+    // Parameters the bank doesn't store keep their current values
+    PatchData patch;
+    patch.captureFrom (apvts);
+    
+    if (! presetBank.getPatch (index, patch))
+        return;
+    
+    currentProgram.store (index);
+    applyPatch (patch);
 }
 
 const juce::String TapSynthAudioProcessor::getProgramName (int index)
 {
-    return {};
+    return presetBank.getName (index);
 }
 
 void TapSynthAudioProcessor::changeProgramName (int index, const juce::String& newName)
 {
+    if (presetBank.renamePreset (index, newName))
+        rebuildOfflineModel();
+}
+
+bool TapSynthAudioProcessor::savePreset (const juce::String& name, const juce::String& tags)
+{
+    PresetBank::Preset preset { name, tags, {} };
+    preset.patch.captureFrom (apvts);
+    
+    if (! presetBank.addPreset (preset))
+        return false;
+    
+    currentProgram.store (presetBank.getNumPresets() - 1);
+    updateHostDisplay (ChangeDetails().withProgramChanged (true));
+    rebuildOfflineModel();
+    similarityIndex.update (presetBank);
+    return true;
+}
+
+void TapSynthAudioProcessor::findSimilarPresets (const int maxResults, SimilarityIndex::QueryCallback onFound)
+{
+    PatchData patch;
+    patch.captureFrom (apvts);
+    
+    // The probe renders on the index's own thread, so the editor never waits for it
+    similarityIndex.findNearest (patch.toJson(), maxResults, std::move (onFound));
+}
+
+void TapSynthAudioProcessor::renderPreviews (const juce::Array<juce::var>& candidates)
+{
+    stopPreview();
+    previewRenderer.render (candidates, getSampleRate() > 0.0 ? getSampleRate() : 44100.0);
+}
+
+void TapSynthAudioProcessor::playPreview (const int index)
+{
+    const auto preview = previewRenderer.getPreview (index);
+    
+    if (preview.audio != nullptr)
+        previewPlayer.play (preview.audio);
+}
+
+void TapSynthAudioProcessor::stopPreview()
+{
+    previewPlayer.stop();
+}
+
+void TapSynthAudioProcessor::commitPreview (const int index)
+{
+    stopPreview();
+    applyParametersFromJson (previewRenderer.getPreview (index).params);
+}
+
+int TapSynthAudioProcessor::getPlayingPreview() const
+{
+    const auto* clip = previewPlayer.getActiveClip();
+    
+    for (int i = 0; clip != nullptr && i < previewRenderer.getNumPreviews(); ++i)
+        if (previewRenderer.getPreview (i).audio.get() == clip)
+            return i;
+    
+    return -1;
+}
+
+std::unique_ptr<TapSynthAudioProcessor> TapSynthAudioProcessor::createHeadlessInstance (const juce::var& params)
+{
+    auto instance = std::make_unique<TapSynthAudioProcessor> (true);
+    
+    // Straight into apvts on this thread: a headless instance has nothing to morph from or publish to
+    PatchData patch;
+    patch.captureFrom (instance->apvts);
+    
+    if (! instance->createPatchFromJson (params, patch))
+        return nullptr;
+    
+    patch.applyTo (instance->apvts);
+    instance->blockPatch = patch;
+    return instance;
+}
+
+void TapSynthAudioProcessor::rebuildOfflineModel()
+{
+    PatchData defaults;
+    defaults.setToDefaults (apvts);
+    offlineModel.rebuild (presetBank, defaults);
 }
 
 //==============================================================================
 void TapSynthAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    synth.setCurrentPlaybackSampleRate (sampleRate);
+    const auto numOutputChannels = getTotalNumOutputChannels();
     
-    for (int i = 0; i < synth.getNumVoices(); i++)
+    // Everything either mode needs is allocated here, so processBlock can switch between
+    // them without allocating when the host starts or ends a bounce
+    maxChunkSize = juce::jmax (quantumSize, samplesPerBlock);
+    offlineBatchSize = maxChunkSize / quantumSize * quantumSize;
+    maxRenderSize = headless ? quantumSize : offlineBatchSize << offlineOversamplingOrder;
+    
+    quantumBuffer.setSize (numOutputChannels, maxRenderSize);
+    
+    if (! headless)
     {
-        if (auto voice = dynamic_cast<SynthVoice*>(synth.getVoice(i)))
-        {
-            voice->prepareToPlay (sampleRate, samplesPerBlock, getTotalNumOutputChannels());
-        }
+        oversampling = std::make_unique<juce::dsp::Oversampling<float>> ((size_t) numOutputChannels, (size_t) offlineOversamplingOrder,
+                                                                         juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR, true, true);
+        oversampling->initProcessing ((size_t) offlineBatchSize);
+        downsamplingLatency = measureDownsamplingLatency();
+        jassert (downsamplingLatency < quantumSize);
+        voiceRenderer.prepare (synth.getNumVoices(), numOutputChannels, maxRenderSize);
     }
     
+    // Between reads the FIFO holds up to a quantum left over, plus everything rendered for one host chunk
+    fifoBuffer.setSize (numOutputChannels, maxChunkSize + 2 * quantumSize + 1);
+    outputFifo.setTotalSize (fifoBuffer.getNumSamples());
+    
+    // The same in both modes, so switching never changes what the host was told
+    setLatencySamples (quantumSize);
+    
+    pendingMidi.ensureSize (4096);
+    spareMidi.ensureSize (4096);
+    quantumMidi.ensureSize (4096);
+    
+    governor.reset();
+    appliedTier = -1;
+    
+    onsets.prepare (sampleRate);
+    hostSamplePosition = 0;
+    renderedSamplePosition = 0;
+    
     juce::dsp::ProcessSpec spec;
     spec.maximumBlockSize = samplesPerBlock;
     spec.sampleRate = sampleRate;
@@ -116,12 +284,64 @@ void TapSynthAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     reverbParams.wetLevel = 0.0f;
     
     reverb.setParameters (reverbParams);
+    
+    // The first time, this sizes the voices and LFO at maxRenderSize, which later switches reuse
+    prepareRenderMode (isNonRealtime() && ! headless);
+    
+    if (recorder.isOpen())
+        recorder.recordPrepare (sampleRate, samplesPerBlock, rawParameters);
+}
+
+void TapSynthAudioProcessor::prepareRenderMode (const bool offline)
+{
+    // Only what was allocated in prepareToPlay is used here: processBlock calls this too
+    isOfflineBounce = offline;
+    renderFactor = offline ? 1 << offlineOversamplingOrder : 1;
+    renderSampleRate = getSampleRate() * renderFactor;
+    maxBatchSize = offline ? offlineBatchSize : quantumSize;
+    
+    synth.setCurrentPlaybackSampleRate (renderSampleRate);
+    synth.setVoiceRenderer (offline ? &voiceRenderer : nullptr);
+    lfo.prepare (renderSampleRate, maxRenderSize);
+    declickSamples = (int) (renderSampleRate * 0.005);
+    
+    // At the sizes they were prepared with, the voices only take the new rate and start over
+    for (int i = 0; i < synth.getNumVoices(); i++)
+    {
+        if (auto voice = dynamic_cast<SynthVoice*>(synth.getVoice(i)))
+        {
+            voice->prepareToPlay (renderSampleRate, maxRenderSize, getTotalNumOutputChannels());
+        }
+    }
+    
+    if (oversampling != nullptr)
+        oversampling->reset();
+    
+    // The quantum of silence in front is the latency that lets each host block be filled
+    // straight away, even when the quantum its last samples belong to isn't complete yet.
+    // Offline, the downsampling filter's delay comes out of it, so the latency stays the same
+    fifoBuffer.clear();
+    outputFifo.reset();
+    outputFifo.finishedWrite (quantumSize - (offline ? downsamplingLatency : 0));
+    
+    pendingSamples = 0;
+    pendingMidi.clear();
+    renderedSamplePosition = hostSamplePosition;
+    
+    // Voices start out on the patch itself. Otherwise a note in the first block, as every offline
+    // render has, would fade in from the default waveform and filter and ramp up to the levels
+    setParams();
+    
+    for (int i = 0; i < synth.getNumVoices(); ++i)
+        if (auto voice = dynamic_cast<SynthVoice*> (synth.getVoice (i)))
+            voice->settleParams();
 }
 
 void TapSynthAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    voiceRenderer.release();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -151,20 +371,293 @@ bool TapSynthAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 void TapSynthAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    TAPSYNTH_TRACE_SCOPE ("processBlock");
+
+    // Not every host prepares again when a bounce starts or ends, so the mode follows
+    // isNonRealtime() block by block; switching renders from a fresh start
+    if (! headless && isNonRealtime() != isOfflineBounce)
+        prepareRenderMode (! isOfflineBounce);
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    setParams();
+    const auto tierOverride = qualityTierOverride.load();
+    const auto tier = tierOverride >= 0 ? tierOverride : governor.getTier();
+    
+    if (recorder.isOpen())
+        recorder.recordBlock (buffer.getNumSamples(), midiMessages, tier, rawParameters);
+    
+    updateBlockPatch();
+    applyQualityTier (tier);
+    
+    const auto numSamples = buffer.getNumSamples();
+    const auto numChannels = juce::jmin (buffer.getNumChannels(), fifoBuffer.getNumChannels());
+    pendingMidi.addEvents (midiMessages, 0, numSamples, pendingSamples);
+    
+    for (const auto metadata : midiMessages)
+    {
+        const auto message = metadata.getMessage();
+        
+        if (message.isNoteOn())
+            onsets.noteOn (message.getNoteNumber(), hostSamplePosition + metadata.samplePosition, numSamples);
+    }
+    
+    hostSamplePosition += numSamples;
+    
+    for (int start = 0; start < numSamples; start += maxChunkSize)
+    {
+        const auto chunkSize = juce::jmin (maxChunkSize, numSamples - start);
+        pendingSamples += chunkSize;
+        
+        // A morph moves a quantum at a time, so it stays as smooth offline as it is live
+        while (pendingSamples >= quantumSize)
+        {
+            const auto batchSize = isOfflineBounce && ! morph.isMorphing() ? juce::jmin (pendingSamples, maxBatchSize) : quantumSize;
+            renderQuanta (batchSize / quantumSize);
+        }
+        
+        int start1, size1, start2, size2;
+        outputFifo.prepareToRead (chunkSize, start1, size1, start2, size2);
+        jassert (size1 + size2 == chunkSize);
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            buffer.copyFrom (ch, start, fifoBuffer, ch, start1, size1);
+            
+            if (size2 > 0)
+                buffer.copyFrom (ch, start + size1, fifoBuffer, ch, start2, size2);
+        }
         
-    synth.renderNextBlock (buffer, midiMessages, 0, buffer.getNumSamples());
+        outputFifo.finishedRead (size1 + size2);
+    }
+    
     juce::dsp::AudioBlock<float> block { buffer };
-    reverb.process (juce::dsp::ProcessContextReplacing<float> (block));
+    
+    {
+        TAPSYNTH_TRACE_SCOPE ("Reverb");
+        
+        // The voices are the same on every channel, so a mono reverb only loses the width of the tail
+        if (appliedTier >= QualityGovernor::lightReverb && block.getNumChannels() > 1)
+        {
+            auto firstChannel = block.getSingleChannelBlock (0);
+            reverb.process (juce::dsp::ProcessContextReplacing<float> (firstChannel));
+            
+            for (size_t ch = 1; ch < block.getNumChannels(); ++ch)
+                block.getSingleChannelBlock (ch).copyFrom (firstChannel);
+        }
+        else
+        {
+            reverb.process (juce::dsp::ProcessContextReplacing<float> (block));
+        }
+    }
+    
+    previewPlayer.process (buffer);
     
     meter.processRMS (buffer);
     meter.processPeak (buffer);
+    
+    const auto secondsTaken = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+    
+    if (! isOfflineBounce && ! headless)
+        governor.addMeasurement (secondsTaken, numSamples, getSampleRate());
+    
+    if (telemetry.isOpen())
+        publishTelemetry (secondsTaken, numSamples);
+}
+
+void TapSynthAudioProcessor::renderQuanta (const int numQuanta)
+{
+    TAPSYNTH_TRACE_SCOPE ("Render quanta");
+    const auto numSamples = numQuanta * quantumSize;
+    const auto numRendered = numSamples * renderFactor;
+    
+    // Events inside a quantum are handled at its start; voices delay their own onsets.
+    // Everything later moves up, to be timed from the start of the next quantum
+    quantumMidi.clear();
+    spareMidi.clear();
+    
+    for (const auto metadata : pendingMidi)
+    {
+        const auto message = metadata.getMessage();
+        const auto position = message.isNoteOff() ? getNoteOffPosition (message, metadata.samplePosition) : metadata.samplePosition;
+        
+        if (position < numSamples)
+            quantumMidi.addEvent (metadata.data, metadata.numBytes, position * renderFactor);
+        else
+            spareMidi.addEvent (metadata.data, metadata.numBytes, position - numSamples);
+    }
+    
+    pendingMidi.swapWith (spareMidi);
+    pendingSamples -= numSamples;
+    
+    if (morph.isMorphing())
+        morph.process (numRendered, blockPatch);
+    
+    if (appliedTier >= QualityGovernor::fewerTails)
+        limitReleaseTails();
+    
+    setParams();
+    lfo.process (0, numRendered);
+    
+    quantumBuffer.clear (0, numRendered);
+    
+    {
+        TAPSYNTH_TRACE_SCOPE ("Synth render");
+        synth.render (quantumBuffer, quantumMidi, numRendered);
+    }
+    
+    if (isOfflineBounce)
+    {
+        TAPSYNTH_TRACE_SCOPE ("Downsample");
+        
+        // Only the way down is wanted: the upsampled block is just somewhere to put the render
+        auto output = juce::dsp::AudioBlock<float> (quantumBuffer).getSubBlock (0, (size_t) numSamples);
+        auto oversampled = oversampling->processSamplesUp (output);
+        oversampled.copyFrom (quantumBuffer, 0, 0, (size_t) numRendered);
+        oversampling->processSamplesDown (output);
+    }
+    
+    collectOnsets();
+    renderedSamplePosition += numSamples;
+    
+    int start1, size1, start2, size2;
+    outputFifo.prepareToWrite (numSamples, start1, size1, start2, size2);
+    jassert (size1 + size2 == numSamples);
+    
+    for (int ch = 0; ch < fifoBuffer.getNumChannels(); ++ch)
+    {
+        fifoBuffer.copyFrom (ch, start1, quantumBuffer, ch, 0, size1);
+        
+        if (size2 > 0)
+            fifoBuffer.copyFrom (ch, start2, quantumBuffer, ch, size1, size2);
+    }
+    
+    outputFifo.finishedWrite (size1 + size2);
+}
+
+int TapSynthAudioProcessor::measureDownsamplingLatency()
+{
+    // getLatencyInSamples() counts the way up too, which renderQuanta skips by writing
+    // the render straight into the upsampled block. The delay of the way down alone is
+    // the area between its step response and the step, summed until it has settled
+    juce::AudioBuffer<float> step (quantumBuffer.getNumChannels(), offlineBatchSize);
+    juce::dsp::AudioBlock<float> output { step };
+    auto delay = 0.0;
+    
+    oversampling->reset();
+    
+    for (int numMeasured = 0; numMeasured < 1024; numMeasured += offlineBatchSize)
+    {
+        output.clear();
+        oversampling->processSamplesUp (output).fill (1.0f);
+        oversampling->processSamplesDown (output);
+        
+        for (int i = 0; i < offlineBatchSize; ++i)
+            delay += 1.0 - step.getSample (0, i);
+    }
+    
+    oversampling->reset();
+    return juce::roundToInt (delay);
+}
+
+int TapSynthAudioProcessor::getNoteOffPosition (const juce::MidiMessage& noteOff, const int position) const
+{
+    // Handled in the same quantum as its note-on, a note-off would end the note before it
+    // is heard, so it waits until a quantum after the latest note-on for it in this render
+    int noteOnPosition = -1;
+    
+    for (const auto metadata : quantumMidi)
+    {
+        const auto message = metadata.getMessage();
+        
+        if (message.isNoteOn() && message.getChannel() == noteOff.getChannel() && message.getNoteNumber() == noteOff.getNoteNumber())
+            noteOnPosition = metadata.samplePosition / renderFactor;
+    }
+    
+    return noteOnPosition >= 0 ? juce::jmax (position, noteOnPosition + quantumSize) : position;
+}
+
+void TapSynthAudioProcessor::collectOnsets()
+{
+    // Rendered samples reach the output a quantum later: the FIFO's head start, plus the
+    // downsampling filter's delay when there is one, which the head start was cut by
+    for (int i = 0; i < synth.getNumVoices(); ++i)
+    {
+        if (auto voice = dynamic_cast<SynthVoice*>(synth.getVoice(i)))
+        {
+            int noteNumber, sample;
+            
+            if (voice->takeOnset (noteNumber, sample))
+                onsets.noteSounded (noteNumber, renderedSamplePosition + sample / renderFactor + quantumSize);
+        }
+    }
+}
+
+void TapSynthAudioProcessor::applyQualityTier (const int tier)
+{
+    if (tier == appliedTier)
+        return;
+    
+    appliedTier = tier;
+    
+    for (int i = 0; i < synth.getNumVoices(); ++i)
+    {
+        if (auto voice = dynamic_cast<SynthVoice*>(synth.getVoice(i)))
+        {
+            voice->setFastOscillators (tier >= QualityGovernor::fastOscillators);
+        }
+    }
+}
+
+void TapSynthAudioProcessor::limitReleaseTails()
+{
+    std::array<SynthVoice*, numVoices> tails {};
+    int numTails = 0;
+    
+    for (int i = 0; i < synth.getNumVoices() && numTails < numVoices; ++i)
+    {
+        if (auto voice = dynamic_cast<SynthVoice*>(synth.getVoice(i)))
+        {
+            if (voice->isReleaseTail())
+                tails[(size_t) numTails++] = voice;
+        }
+    }
+    
+    if (numTails <= maxReleaseTails)
+        return;
+    
+    // The loudest tails play out; the rest fade away over a declick
+    std::sort (tails.begin(), tails.begin() + numTails, [] (const SynthVoice* a, const SynthVoice* b)
+    {
+        return a->getEnvelopeLevel() > b->getEnvelopeLevel();
+    });
+    
+    for (int i = maxReleaseTails; i < numTails; ++i)
+        tails[(size_t) i]->fadeOutTail (declickSamples);
+}
+
+void TapSynthAudioProcessor::publishTelemetry (const double secondsTaken, const int numSamples)
+{
+    Telemetry::Stats stats;
+    stats.load = numSamples > 0 ? (float) (secondsTaken * getSampleRate() / numSamples) : 0.0f;
+    stats.rms = meter.getRMS().load();
+    stats.peak = meter.getPeak().load();
+    stats.numOverruns = governor.getNumOverruns();
+    stats.qualityTier = governor.getTier();
+    stats.blockSize = numSamples;
+    stats.sampleRate = getSampleRate();
+    stats.numBlocks = ++numBlocksProcessed;
+    stats.updateTime = (juce::int64) juce::Time::currentTimeMillis();
+    
+    for (int i = 0; i < synth.getNumVoices(); ++i)
+        if (synth.getVoice (i)->isVoiceActive())
+            ++stats.activeVoices;
+    
+    telemetry.publish (stats);
 }
 
 //==============================================================================
@@ -181,15 +674,23 @@ juce::AudioProcessorEditor* TapSynthAudioProcessor::createEditor()
 //==============================================================================
 void TapSynthAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    state.getState (destData);
 }
 
 void TapSynthAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    PatchData patch;
+    
+    if (! state.setState (data, sizeInBytes, patch))
+    {
+        DBG ("Ignoring unrecognised plugin state.");
+        return;
+    }
+    
+    // Whole, through the patch queue, so the audio thread never renders a half-restored state
+    // and apvts is published in one gesture instead of a notification per parameter.
+    // Without a morph: a restored session has to sound as saved from its first block
+    applyPatch (patch, 0.0f);
 }
 
 //==============================================================================
@@ -226,6 +727,7 @@ juce::AudioProcessorValueTreeState::ParameterLayout TapSynthAudioProcessor::crea
     // LFO
     params.push_back (std::make_unique<juce::AudioParameterFloat>("LFO1FREQ", "LFO1 Frequency", juce::NormalisableRange<float> { 0.0f, 20.0f, 0.1f }, 0.0f, "Hz"));
     params.push_back (std::make_unique<juce::AudioParameterFloat>("LFO1DEPTH", "LFO1 Depth", juce::NormalisableRange<float> { 0.0f, 10000.0f, 0.1f, 0.3f }, 0.0f, ""));
+    params.push_back (std::make_unique<juce::AudioParameterChoice>("LFO1MODE", "LFO1 Mode", juce::StringArray { "Global", "Free", "Key Sync" }, 0));
     
     //Filter
     params.push_back (std::make_unique<juce::AudioParameterChoice>("FILTERTYPE", "Filter Type", juce::StringArray { "Low Pass", "Band Pass", "High Pass" }, 0));
@@ -257,6 +759,7 @@ juce::AudioProcessorValueTreeState::ParameterLayout TapSynthAudioProcessor::crea
 
 void TapSynthAudioProcessor::setParams()
 {
+    TAPSYNTH_TRACE_SCOPE ("Set params");
     setVoiceParams();
     setFilterParams();
     setReverbParams();
@@ -264,31 +767,33 @@ void TapSynthAudioProcessor::setParams()
 
 void TapSynthAudioProcessor::setVoiceParams()
 {
+    const auto attack = blockPatch.getValue (PatchData::attack);
+    const auto decay = blockPatch.getValue (PatchData::decay);
+    const auto sustain = blockPatch.getValue (PatchData::sustain);
+    const auto release = blockPatch.getValue (PatchData::release);
+    
+    const auto osc1Choice = (int) blockPatch.getValue (PatchData::osc1Choice);
+    const auto osc2Choice = (int) blockPatch.getValue (PatchData::osc2Choice);
+    const auto osc1Gain = blockPatch.getValue (PatchData::osc1Gain);
+    const auto osc2Gain = blockPatch.getValue (PatchData::osc2Gain);
+    const auto osc1Pitch = (int) blockPatch.getValue (PatchData::osc1Pitch);
+    const auto osc2Pitch = (int) blockPatch.getValue (PatchData::osc2Pitch);
+    const auto osc1FmFreq = blockPatch.getValue (PatchData::osc1FmFreq);
+    const auto osc2FmFreq = blockPatch.getValue (PatchData::osc2FmFreq);
+    const auto osc1FmDepth = blockPatch.getValue (PatchData::osc1FmDepth);
+    const auto osc2FmDepth = blockPatch.getValue (PatchData::osc2FmDepth);
+    
+    const auto filterAttack = blockPatch.getValue (PatchData::filterAttack);
+    const auto filterDecay = blockPatch.getValue (PatchData::filterDecay);
+    const auto filterSustain = blockPatch.getValue (PatchData::filterSustain);
+    const auto filterRelease = blockPatch.getValue (PatchData::filterRelease);
+    
+    const auto fadeSamples = getDiscreteFadeSamples();
+    
     for (int i = 0; i < synth.getNumVoices(); ++i)
     {
         if (auto voice = dynamic_cast<SynthVoice*>(synth.getVoice(i)))
         {
-            auto& attack = *apvts.getRawParameterValue ("ATTACK");
-            auto& decay = *apvts.getRawParameterValue ("DECAY");
-            auto& sustain = *apvts.getRawParameterValue ("SUSTAIN");
-            auto& release = *apvts.getRawParameterValue ("RELEASE");
-            
-            auto& osc1Choice = *apvts.getRawParameterValue ("OSC1");
-            auto& osc2Choice = *apvts.getRawParameterValue ("OSC2");
-            auto& osc1Gain = *apvts.getRawParameterValue ("OSC1GAIN");
-            auto& osc2Gain = *apvts.getRawParameterValue ("OSC2GAIN");
-            auto& osc1Pitch = *apvts.getRawParameterValue ("OSC1PITCH");
-            auto& osc2Pitch = *apvts.getRawParameterValue ("OSC2PITCH");
-            auto& osc1FmFreq = *apvts.getRawParameterValue ("OSC1FMFREQ");
-            auto& osc2FmFreq = *apvts.getRawParameterValue ("OSC2FMFREQ");
-            auto& osc1FmDepth = *apvts.getRawParameterValue ("OSC1FMDEPTH");
-            auto& osc2FmDepth = *apvts.getRawParameterValue ("OSC2FMDEPTH");
-            
-            auto& filterAttack = *apvts.getRawParameterValue ("FILTERATTACK");
-            auto& filterDecay = *apvts.getRawParameterValue ("FILTERDECAY");
-            auto& filterSustain = *apvts.getRawParameterValue ("FILTERSUSTAIN");
-            auto& filterRelease = *apvts.getRawParameterValue ("FILTERRELEASE");
-
             auto& osc1 = voice->getOscillator1();
             auto& osc2 = voice->getOscillator2();
             
@@ -297,11 +802,11 @@ void TapSynthAudioProcessor::setVoiceParams()
            
             for (int i = 0; i < getTotalNumOutputChannels(); i++)
             {
-                osc1[i].setParams (osc1Choice, osc1Gain, osc1Pitch, osc1FmFreq, osc1FmDepth);
-                osc2[i].setParams (osc2Choice, osc2Gain, osc2Pitch, osc2FmFreq, osc2FmDepth);
+                osc1[i].setParams (osc1Choice, osc1Gain, osc1Pitch, osc1FmFreq, osc1FmDepth, fadeSamples);
+                osc2[i].setParams (osc2Choice, osc2Gain, osc2Pitch, osc2FmFreq, osc2FmDepth, fadeSamples);
             }
             
-            adsr.update (attack.load(), decay.load(), sustain.load(), release.load());
+            adsr.update (attack, decay, sustain, release);
             filterAdsr.update (filterAttack, filterDecay, filterSustain, filterRelease);
         }
     }
@@ -309,72 +814,193 @@ void TapSynthAudioProcessor::setVoiceParams()
 
 void TapSynthAudioProcessor::setFilterParams()
 {
-    auto& filterType = *apvts.getRawParameterValue ("FILTERTYPE");
-    auto& filterCutoff = *apvts.getRawParameterValue ("FILTERCUTOFF");
-    auto& filterResonance = *apvts.getRawParameterValue ("FILTERRESONANCE");
-    auto& adsrDepth = *apvts.getRawParameterValue ("FILTERADSRDEPTH");
-    auto& lfoFreq = *apvts.getRawParameterValue ("LFO1FREQ");
-    auto& lfoDepth = *apvts.getRawParameterValue ("LFO1DEPTH");
+    const auto filterType = (int) blockPatch.getValue (PatchData::filterType);
+    const auto filterCutoff = blockPatch.getValue (PatchData::filterCutoff);
+    const auto filterResonance = blockPatch.getValue (PatchData::filterResonance);
+    const auto adsrDepth = blockPatch.getValue (PatchData::filterAdsrDepth);
+    const auto lfoFreq = blockPatch.getValue (PatchData::lfo1Freq);
+    const auto lfoDepth = blockPatch.getValue (PatchData::lfo1Depth);
+    const auto lfoMode = (int) blockPatch.getValue (PatchData::lfo1Mode);
+    const auto fadeSamples = getDiscreteFadeSamples();
+    
+    lfo.setParams (lfoFreq, lfoMode);
         
     for (int i = 0; i < synth.getNumVoices(); ++i)
     {
         if (auto voice = dynamic_cast<SynthVoice*>(synth.getVoice(i)))
         {
-            voice->updateModParams (filterType, filterCutoff, filterResonance, adsrDepth, lfoFreq, lfoDepth);
+            voice->updateModParams (filterType, filterCutoff, filterResonance, adsrDepth, lfoDepth, fadeSamples);
         }
     }
 }
 
 void TapSynthAudioProcessor::setReverbParams()
 {
-    reverbParams.roomSize = *apvts.getRawParameterValue ("REVERBSIZE");
-    reverbParams.width = *apvts.getRawParameterValue ("REVERBWIDTH");
-    reverbParams.damping = *apvts.getRawParameterValue ("REVERBDAMPING");
-    reverbParams.dryLevel = *apvts.getRawParameterValue ("REVERBDRY");
-    reverbParams.wetLevel = *apvts.getRawParameterValue ("REVERBWET");
-    reverbParams.freezeMode = *apvts.getRawParameterValue ("REVERBFREEZE");
+    reverbParams.roomSize = blockPatch.getValue (PatchData::reverbSize);
+    reverbParams.width = blockPatch.getValue (PatchData::reverbWidth);
+    reverbParams.damping = blockPatch.getValue (PatchData::reverbDamping);
+    reverbParams.dryLevel = blockPatch.getValue (PatchData::reverbDry);
+    reverbParams.wetLevel = blockPatch.getValue (PatchData::reverbWet);
+    reverbParams.freezeMode = blockPatch.getValue (PatchData::reverbFreeze);
     
     reverb.setParameters (reverbParams);
 }
 
-void TapSynthAudioProcessor::applyParametersFromJson (const juce::var& json)
+void TapSynthAudioProcessor::updateBlockPatch()
 {
-    if (! juce::MessageManager::getInstance()->isThisTheMessageThread())
+    TAPSYNTH_TRACE_SCOPE ("Parameter snapshot");
+    
+    // Load the count before pulling: if it includes a new push, the pull is guaranteed to see it
+    const auto pushed = pushedPatchCount.load (std::memory_order_acquire);
+    
+    // A new patch morphs in from whatever is sounding right now
+    float seconds = 0.0f;
+    
+    if (patchQueue.pull (heldPatch, seconds))
     {
-        juce::MessageManager::callAsync ([this, json]()
-        {
-            applyParametersFromJson (json);
-        });
+        TAPSYNTH_TRACE_INSTANT ("Patch snapshot applied", -1);
+        morph.start (blockPatch, heldPatch, (int) (seconds * renderSampleRate));
+        
+        if (recorder.isOpen())
+            recorder.recordPatch (heldPatch, seconds);
+    }
+    
+    // The morph drives blockPatch itself, in steps, while processBlock renders
+    if (morph.isMorphing())
+        return;
+    
+    // While a pushed patch is still being published, apvts can be half-way between
+    // two patches, so the voices keep using the complete snapshot instead
+    if (publishedPatchCount.load (std::memory_order_acquire) != pushed)
+    {
+        blockPatch = heldPatch;
         return;
     }
+    
+    for (int i = 0; i < PatchData::numParameters; ++i)
+        blockPatch.setValue (i, rawParameters[(size_t) i]->load());
+}
+
+int TapSynthAudioProcessor::getDiscreteFadeSamples() const
+{
+    // Waveform and filter type switches crossfade over the whole morph, or just declick otherwise
+    return morph.isMorphing() ? morph.getRemainingSamples() : declickSamples;
+}
+
+void TapSynthAudioProcessor::applyParametersFromJson (const juce::var& json)
+{
+    // Build the complete patch here, on the calling thread, on top of whatever is about to be live
+    auto patch = getLatestPatch();
 
+    if (createPatchFromJson (json, patch))
+        applyPatch (patch);
+}
+
+bool TapSynthAudioProcessor::createPatchFromJson (const juce::var& json, PatchData& patch)
+{
     // Must be a JSON object
     auto* obj = json.getDynamicObject();
     if (obj == nullptr)
     {
         DBG("JSON is not an object.");
-        return;
+        return false;
     }
 
-    auto& props = obj->getProperties();
-
-    for (auto& entry : props)
+    for (auto& entry : obj->getProperties())
     {
         juce::String id = entry.name.toString();
         const juce::var& value = entry.value;
+        const auto index = PatchData::getParameterIndex (id);
 
-        if (auto* param = apvts.getParameter(id))
+        if (index < 0)
         {
-            juce::Value paramValue = apvts.getParameterAsValue(id);
-
-            paramValue.setValue(value);
+            DBG("Unknown parameter id from JSON: " << id);
+            continue;
         }
-        else
+
+        if (value.isVoid() || value.isObject() || value.isArray())
         {
-            DBG("Unknown parameter id from JSON: " << id);
+            DBG("Invalid value from JSON for: " << id);
+            continue;
         }
+
+        // Clamp to the range and snap to the interval, as the parameter itself would
+        auto* param = parameters[(size_t) index];
+        patch.setValue (index, param->convertFrom0to1 (param->convertTo0to1 ((float) value)));
+    }
+
+    return true;
+}
+
+void TapSynthAudioProcessor::applyPatch (const PatchData& patch)
+{
+    applyPatch (patch, morphTime.load());
+}
+
+void TapSynthAudioProcessor::applyPatch (const PatchData& patch, const float morphSeconds)
+{
+    {
+        const juce::ScopedLock sl (latestPatchLock);
+        latestPatch = patch;
+        patchQueue.push (patch, juce::jmax (0.0f, morphSeconds));
+        pushedPatchCount.fetch_add (1, std::memory_order_release);
     }
+    
+    triggerAsyncUpdate();
+    
+    if (juce::MessageManager::existsAndIsCurrentThread())
+        handleUpdateNowIfNeeded();
 }
 
+PatchData TapSynthAudioProcessor::getLatestPatch()
+{
+    const juce::ScopedLock sl (latestPatchLock);
+    
+    if (publishedPatchCount.load() != pushedPatchCount.load())
+        return latestPatch;
+    
+    PatchData patch;
+    patch.captureFrom (apvts);
+    return patch;
+}
 
+void TapSynthAudioProcessor::handleAsyncUpdate()
+{
+    PatchData patch;
+    juce::uint32 count;
+    
+    {
+        const juce::ScopedLock sl (latestPatchLock);
+        patch = latestPatch;
+        count = pushedPatchCount.load();
+    }
+    
+    publishPatch (patch);
+    publishedPatchCount.store (count, std::memory_order_release);
+}
 
+void TapSynthAudioProcessor::publishPatch (const PatchData& patch)
+{
+    TAPSYNTH_TRACE_SCOPE ("Publish patch");
+    std::array<std::pair<juce::RangedAudioParameter*, float>, PatchData::numParameters> changed;
+    int numChanged = 0;
+    
+    for (int i = 0; i < PatchData::numParameters; ++i)
+    {
+        auto* param = parameters[(size_t) i];
+        const auto normalised = param->convertTo0to1 (patch.getValue (i));
+        
+        if (param->getValue() != normalised)
+            changed[(size_t) numChanged++] = { param, normalised };
+    }
+    
+    // One gesture spanning the whole patch, so hosts record it as a single edit
+    for (int i = 0; i < numChanged; ++i)
+        changed[(size_t) i].first->beginChangeGesture();
+    
+    for (int i = 0; i < numChanged; ++i)
+        changed[(size_t) i].first->setValueNotifyingHost (changed[(size_t) i].second);
+    
+    for (int i = 0; i < numChanged; ++i)
+        changed[(size_t) i].first->endChangeGesture();
+}
@@ -12,15 +12,33 @@
 #include "SynthVoice.h"
 #include "SynthSound.h"
 #include "Data/MeterData.h"
+#include "Data/StateData.h"
+#include "Data/PresetBank.h"
+#include "Data/PatchQueue.h"
+#include "Data/MorphData.h"
+#include "Data/PromptCache.h"
+#include "Data/PatchRequestService.h"
+#include "Data/PreviewRenderer.h"
+#include "Data/PreviewPlayer.h"
+#include "Data/SimilarityIndex.h"
+#include "Data/QualityGovernor.h"
+#include "Data/TraceRecorder.h"
+#include "Data/TelemetrySegment.h"
+#include "Data/SessionRecorder.h"
+#include "Data/OnsetMeter.h"
 
 //==============================================================================
 /**
 */
 class TapSynthAudioProcessor  : public juce::AudioProcessor
+                              , private juce::AsyncUpdater
 {
 public:
     //==============================================================================
-    TapSynthAudioProcessor();
+    // Headless instances skip the preset bank and prompt model; they only render.
+    // Isolated ones render as live ones do, but leave the preset bank, similarity
+    // index, telemetry and capture file alone, so benchmarks time the processing only
+    explicit TapSynthAudioProcessor (const bool isHeadless = false, const bool isIsolated = false);
     ~TapSynthAudioProcessor() override;
 
     //==============================================================================
@@ -61,10 +79,51 @@ public:
     juce::AudioProcessorValueTreeState apvts;
 
     void applyParametersFromJson (const juce::var& json);
+    bool createPatchFromJson (const juce::var& json, PatchData& patch);
+
+    // Morphs in over the morph time; a zero-length morph lands the patch at once
+    void applyPatch (const PatchData& patch);
+    void applyPatch (const PatchData& patch, const float morphSeconds);
+    PatchData getLatestPatch();
+    
+    void setMorphTime (const float seconds) { morphTime.store (juce::jmax (0.0f, seconds)); }
+    float getMorphTime() const { return morphTime.load(); }
+    
+    PresetBank& getPresetBank() { return presetBank; }
+    bool savePreset (const juce::String& name, const juce::String& tags);
+    
+    PromptCache& getPromptCache() { return promptCache; }
+    PatchRequestService& getPatchRequestService() { return patchRequests; }
+    const OfflinePatchModel& getOfflinePatchModel() const { return offlineModel; }
+    
+    // Bank presets that sound closest to the current patch, nearest first
+    void findSimilarPresets (const int maxResults, SimilarityIndex::QueryCallback onFound);
+    bool isSimilarityIndexUpdating() const { return similarityIndex.isUpdating(); }
+    
+    // Candidate patches are rendered on background instances and auditioned over the live output
+    PreviewRenderer& getPreviewRenderer() { return previewRenderer; }
+    void renderPreviews (const juce::Array<juce::var>& candidates);
+    void playPreview (const int index);
+    void stopPreview();
+    void commitPreview (const int index);
+    int getPlayingPreview() const;
+    
+    // How far the live path has stepped down to keep up, and how often it fell behind anyway
+    int getQualityTier() const { return governor.getTier(); }
+    int getNumOverruns() const { return governor.getNumOverruns(); }
+    
+    // Pins the quality tier, as a replay does to match the capture; -1 hands it back to the governor
+    void setQualityTierOverride (const int tier) { qualityTierOverride.store (tier); }
+    
+    // How long notes take from their note-on to being heard, by the size of block they came in
+    const OnsetMeter& getOnsetMeter() const { return onsets; }
+    
+    // A headless instance with params applied, ready to render on the calling thread
+    static std::unique_ptr<TapSynthAudioProcessor> createHeadlessInstance (const juce::var& params);
 
 private:
     static constexpr int numChannelsToProcess { 2 };
-    juce::Synthesiser synth;
+    QuantumSynthesiser synth;
     
     juce::AudioProcessorValueTreeState::ParameterLayout createParams();
     void setParams();
@@ -72,10 +131,106 @@ private:
     void setFilterParams();
     void setReverbParams();
     
+    void prepareRenderMode (const bool offline);
+    void renderQuanta (const int numQuanta);
+    int measureDownsamplingLatency();
+    int getNoteOffPosition (const juce::MidiMessage& noteOff, const int position) const;
+    void applyQualityTier (const int tier);
+    void limitReleaseTails();
+    void collectOnsets();
+    void publishTelemetry (const double secondsTaken, const int numSamples);
+    void updateBlockPatch();
+    int getDiscreteFadeSamples() const;
+    void publishPatch (const PatchData& patch);
+    void rebuildOfflineModel();
+    void handleAsyncUpdate() override;
+    
     static constexpr int numVoices { 5 };
+    static_assert (numVoices <= LfoData::maxVoices, "Every voice needs its own LFO lane");
+    LfoData lfo;
     juce::dsp::Reverb reverb;
     juce::Reverb::Parameters reverbParams;
     MeterData meter;
+    StateData state { apvts };
+    PresetBank presetBank;
+    PromptCache promptCache { PromptCache::getDefaultDirectory() };
+    OfflinePatchModel offlineModel;
+    SimilarityIndex similarityIndex { createHeadlessInstance };
+    std::atomic<int> currentProgram { 0 };
+    
+    // Whole patches reach the audio thread through patchQueue; apvts is only
+    // updated afterwards on the message thread, in a single gesture
+    std::array<juce::RangedAudioParameter*, PatchData::numParameters> parameters;
+    std::array<std::atomic<float>*, PatchData::numParameters> rawParameters;
+    PatchQueue patchQueue;
+    PatchData blockPatch;
+    PatchData heldPatch;
+    PatchData latestPatch;
+    juce::CriticalSection latestPatchLock;
+    std::atomic<juce::uint32> pushedPatchCount { 0 };
+    std::atomic<juce::uint32> publishedPatchCount { 0 };
+    
+    // The synth renders in fixed quanta whatever size the host's blocks are, and
+    // reaches the output through a FIFO running one quantum behind. MIDI waits in
+    // pendingMidi, timed from the start of the next quantum, until that is rendered
+    static constexpr int quantumSize { LfoData::stepSize };
+    juce::AbstractFifo outputFifo { quantumSize + 1 };
+    juce::AudioBuffer<float> fifoBuffer;
+    juce::AudioBuffer<float> quantumBuffer;
+    juce::MidiBuffer pendingMidi;
+    juce::MidiBuffer spareMidi;
+    juce::MidiBuffer quantumMidi;
+    int pendingSamples { 0 };
+    int maxChunkSize { 0 };
+    
+    // Offline bounces render as many quanta as are complete in one go, spread the
+    // voices over every core and oversample. Headless instances never do: they are
+    // already rendered one per core, and must sound the way the plugin does live.
+    // Live instances are prepared for both modes, and isOfflineBounce is the one in use
+    static constexpr int offlineOversamplingOrder { 1 };
+    const bool headless;
+    bool isOfflineBounce { false };
+    int renderFactor { 1 };
+    double renderSampleRate { 44100.0 };
+    int maxBatchSize { quantumSize };
+    int offlineBatchSize { quantumSize };
+    int maxRenderSize { quantumSize };
+    int downsamplingLatency { 0 };
+    std::unique_ptr<juce::dsp::Oversampling<float>> oversampling;
+    ParallelVoiceRenderer voiceRenderer;
+    
+    // Only the live path is governed; offline and headless renders have no deadline
+    static constexpr int maxReleaseTails { 2 };
+    QualityGovernor governor;
+    int appliedTier { -1 };
+    std::atomic<int> qualityTierOverride { -1 };
+    
+    // Live instances show up in the tools' telemetry listing; headless ones don't
+    TelemetryPublisher telemetry;
+    juce::int64 numBlocksProcessed { 0 };
+    
+    // Only runs when TAPSYNTH_CAPTURE_FILE names a file to record the session to
+    SessionRecorder recorder;
+    static constexpr int captureSizeInMegabytes { 64 };
+    
+    // Both count from the last prepareToPlay, in host samples: what the host has sent, and
+    // what the synth has rendered. They differ by pendingSamples
+    OnsetMeter onsets;
+    juce::int64 hostSamplePosition { 0 };
+    juce::int64 renderedSamplePosition { 0 };
+    
+    // New patches are morphed in a quantum at a time, so parameters move smoothly
+    MorphData morph;
+    std::atomic<float> morphTime { 0.25f };
+    int declickSamples { 0 };
+    
+    PreviewPlayer previewPlayer;
+    PreviewRenderer previewRenderer { createHeadlessInstance };
+    
+    // Declared last, so its worker stops before anything it applies patches to goes away
+    PatchRequestService patchRequests { promptCache, offlineModel,
+                                        [this] (const juce::var& params) { applyParametersFromJson (params); },
+                                        [this] { return getLatestPatch().toJson(); } };
     
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TapSynthAudioProcessor)
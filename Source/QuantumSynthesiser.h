@@ -0,0 +1,51 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "Data/ParallelVoiceRenderer.h"
+
+// The processor renders this in fixed quanta, with every MIDI event in a quantum
+// handled at its start so the quantum is never split. While an event is being
+// handled it remembers how far past the current render position the event really
+// belongs, so voices starting from it can hold off until that exact sample. A
+// note-off never shares a quantum with its note-on: the processor holds it back
+// to the next one, so short notes still sound.
+class QuantumSynthesiser : public juce::Synthesiser
+{
+public:
+    // Renders numSamples from the start of buffer
+    void render (juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midi, const int numSamples)
+    {
+        renderPosition = 0;
+        renderNextBlock (buffer, midi, 0, numSamples);
+    }
+    
+    int getEventOffset() const { return eventOffset; }
+    
+    // Spreads the voices over the renderer's threads instead, or nullptr for the usual loop
+    void setVoiceRenderer (ParallelVoiceRenderer* renderer) { voiceRenderer = renderer; }
+    
+protected:
+    using juce::Synthesiser::renderVoices;
+    
+    void renderVoices (juce::AudioBuffer<float>& buffer, int startSample, int numSamples) override
+    {
+        if (voiceRenderer != nullptr)
+            voiceRenderer->render (voices.begin(), voices.size(), buffer, startSample, numSamples);
+        else
+            juce::Synthesiser::renderVoices (buffer, startSample, numSamples);
+        
+        renderPosition = startSample + numSamples;
+    }
+    
+    void handleMidiEvent (const juce::MidiMessage& message) override
+    {
+        eventOffset = juce::jmax (0, (int) message.getTimeStamp() - renderPosition);
+        juce::Synthesiser::handleMidiEvent (message);
+        eventOffset = 0;
+    }
+    
+private:
+    ParallelVoiceRenderer* voiceRenderer { nullptr };
+    int renderPosition { 0 };
+    int eventOffset { 0 };
+};
@@ -7,6 +7,8 @@ bool SynthVoice::canPlaySound (juce::SynthesiserSound* sound)
 
 void SynthVoice::startNote (int midiNoteNumber, float velocity, juce::SynthesiserSound *sound, int currentPitchWheelPosition)
 {
+    TAPSYNTH_TRACE_INSTANT ("Voice start", midiNoteNumber);
+    
     for (int i = 0; i < 2; i++)
     {
         osc1[i].setFreq (midiNoteNumber);
@@ -15,10 +17,20 @@ void SynthVoice::startNote (int midiNoteNumber, float velocity, juce::Synthesise
     
     adsr.noteOn();
     filterAdsr.noteOn();
+    
+    tailFadeRemaining = 0;
+    isAwaitingOnset = true;
+    
+    // Notes are started at the top of the quantum, so the voice stays silent up to the note's own sample
+    onsetDelay = synth != nullptr ? synth->getEventOffset() : 0;
+    
+    // The note's position in the block is only known once the voice is rendered from it
+    lfoNeedsSync = true;
 }
 
 void SynthVoice::stopNote (float velocity, bool allowTailOff)
 {
+    TAPSYNTH_TRACE_INSTANT ("Voice stop", getCurrentlyPlayingNote());
     adsr.noteOff();
     filterAdsr.noteOff();
     
@@ -40,25 +52,18 @@ void SynthVoice::prepareToPlay (double sampleRate, int samplesPerBlock, int outp
 {
     reset();
     
-    adsr.setSampleRate (sampleRate);
-    filterAdsr.setSampleRate (sampleRate);
-    
-    juce::dsp::ProcessSpec spec;
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.sampleRate = sampleRate;
-    spec.numChannels = outputChannels;
+    adsr.prepare (sampleRate);
+    filterAdsr.prepare (sampleRate);
     
     for (int ch = 0; ch < numChannelsToProcess; ch++)
     {
         osc1[ch].prepareToPlay (sampleRate, samplesPerBlock, outputChannels);
         osc2[ch].prepareToPlay (sampleRate, samplesPerBlock, outputChannels);
         filter[ch].prepareToPlay (sampleRate, samplesPerBlock, outputChannels);
-        lfo[ch].prepare (spec);
-        lfo[ch].initialise ([](float x) { return std::sin (x); });
     }
     
-    gain.prepare (spec);
-    gain.setGainLinear (0.07f);
+    synthBuffer.setSize (outputChannels, samplesPerBlock);
+    envelopeBuffer.setSize (1, samplesPerBlock);
     
     isPrepared = true;
 }
@@ -70,12 +75,24 @@ void SynthVoice::renderNextBlock (juce::AudioBuffer< float > &outputBuffer, int
     if (! isVoiceActive())
         return;
     
-    synthBuffer.setSize (outputBuffer.getNumChannels(), numSamples, false, false, true);
+    if (onsetDelay > 0)
+    {
+        const auto delaySamples = juce::jmin (onsetDelay, numSamples);
+        onsetDelay -= delaySamples;
+        startSample += delaySamples;
+        numSamples -= delaySamples;
+        
+        if (numSamples == 0)
+            return;
+    }
     
-    filterAdsr.applyEnvelopeToBuffer (synthBuffer, 0, synthBuffer.getNumSamples());
-    filterAdsrOutput = filterAdsr.getNextSample();
+    if (lfoNeedsSync && lfo != nullptr)
+        lfo->noteOn (voiceIndex, startSample);
     
-    synthBuffer.clear();
+    lfoNeedsSync = false;
+    
+    synthBuffer.setSize (outputBuffer.getNumChannels(), numSamples, false, false, true);
+    envelopeBuffer.setSize (1, numSamples, false, false, true);
     
     for (int ch = 0; ch < synthBuffer.getNumChannels(); ++ch)
     {
@@ -83,60 +100,163 @@ void SynthVoice::renderNextBlock (juce::AudioBuffer< float > &outputBuffer, int
         
         for (int s = 0; s < synthBuffer.getNumSamples(); ++s)
         {
-            buffer[s] = osc1[ch].processNextSample (buffer[s]) + osc2[ch].processNextSample (buffer[s]);
+            buffer[s] = osc1[ch].getNextGain() * osc1[ch].processNextSample (0.0f) + osc2[ch].getNextGain() * osc2[ch].processNextSample (0.0f);
         }
     }
     
-    juce::dsp::AudioBlock<float> audioBlock { synthBuffer };
-    gain.process (juce::dsp::ProcessContextReplacing<float> (audioBlock));
-    adsr.applyEnvelopeToBuffer (synthBuffer, 0, synthBuffer.getNumSamples());
-    
-    for (int ch = 0; ch < synthBuffer.getNumChannels(); ++ch)
+    for (int start = 0; start < numSamples; start += modulationStepSize)
     {
-        auto* buffer = synthBuffer.getWritePointer (ch, 0);
+        const auto stepSamples = juce::jmin (modulationStepSize, numSamples - start);
+        filterAdsrOutput = filterAdsr.advance (stepSamples);
+        lfoOutput = lfo != nullptr ? lfo->getValue (voiceIndex, startSample + start) : 0.0f;
         
-        for (int s = 0; s < synthBuffer.getNumSamples(); ++s)
+        // The cutoff glides from the last step's value to this one's in short sub-steps
+        const auto fromCutoff = filterCutoff;
+        const auto fromResonance = filterResonance;
+        const auto toCutoff = getFilterCutoff();
+        
+        for (int sub = 0; sub < stepSamples; sub += filterGlideStepSize)
         {
-            //lfoOutput[ch] = lfo[ch].processSample (synthBuffer.getSample (ch, s));
-            buffer[s] = filter[ch].processNextSample (ch, synthBuffer.getSample (ch, s));
+            const auto subSamples = juce::jmin (filterGlideStepSize, stepSamples - sub);
+            const auto position = (float) (sub + subSamples) / (float) stepSamples;
+            filterCutoff = fromCutoff + (toCutoff - fromCutoff) * position;
+            filterResonance = fromResonance + (filterSettings.resonance - fromResonance) * position;
+            updateFilter();
+            
+            for (int ch = 0; ch < synthBuffer.getNumChannels(); ++ch)
+            {
+                auto* buffer = synthBuffer.getWritePointer (ch, start + sub);
+                
+                for (int s = 0; s < subSamples; ++s)
+                {
+                    buffer[s] = filter[ch].processNextSample (ch, buffer[s]);
+                }
+            }
         }
     }
     
-    for (int channel = 0; channel < outputBuffer.getNumChannels(); ++channel)
+    // Voice level and amp envelope make one multiplier stream, applied while mixing into the output
+    auto* envelope = envelopeBuffer.getWritePointer (0);
+    adsr.process (envelope, numSamples);
+    juce::FloatVectorOperations::multiply (envelope, voiceGain, numSamples);
+    
+    const auto isFadingOut = tailFadeRemaining > 0;
+    
+    if (isFadingOut)
     {
-        outputBuffer.addFrom (channel, startSample, synthBuffer, channel, 0, numSamples);
+        const auto fadeSamples = juce::jmin (tailFadeRemaining, numSamples);
+        
+        for (int s = 0; s < fadeSamples; ++s)
+            envelope[s] *= (float) (tailFadeRemaining - s) / (float) tailFadeLength;
         
-        if (! adsr.isActive())
-            clearCurrentNote();
+        juce::FloatVectorOperations::clear (envelope + fadeSamples, numSamples - fadeSamples);
+        tailFadeRemaining -= fadeSamples;
+    }
+    
+    if (isAwaitingOnset)
+        findOnset (envelope, startSample, numSamples);
+    
+    for (int channel = 0; channel < outputBuffer.getNumChannels(); ++channel)
+    {
+        juce::FloatVectorOperations::addWithMultiply (outputBuffer.getWritePointer (channel, startSample),
+                                                      synthBuffer.getReadPointer (channel), envelope, numSamples);
+    }
+    
+    if (isFadingOut && tailFadeRemaining == 0)
+        adsr.reset();
+    
+    if (! adsr.isActive())
+        clearCurrentNote();
+}
+
+void SynthVoice::fadeOutTail (const int numSamples)
+{
+    if (tailFadeRemaining > 0)
+        return;
+    
+    tailFadeLength = juce::jmax (1, numSamples);
+    tailFadeRemaining = tailFadeLength;
+}
+
+bool SynthVoice::takeOnset (int& noteNumber, int& sample)
+{
+    if (onsetSample < 0)
+        return false;
+    
+    noteNumber = onsetNote;
+    sample = onsetSample;
+    onsetSample = -1;
+    return true;
+}
+
+void SynthVoice::findOnset (const float* envelope, const int startSample, const int numSamples)
+{
+    // Every channel plays the same voice, so the first one is enough
+    const auto* voice = synthBuffer.getReadPointer (0);
+    
+    for (int s = 0; s < numSamples; ++s)
+    {
+        if (std::abs (voice[s] * envelope[s]) > OnsetMeter::silenceThreshold)
+        {
+            onsetNote = getCurrentlyPlayingNote();
+            onsetSample = startSample + s;
+            isAwaitingOnset = false;
+            return;
+        }
+    }
+}
+
+void SynthVoice::setFastOscillators (const bool shouldUseFastOscillators)
+{
+    for (int ch = 0; ch < numChannelsToProcess; ++ch)
+    {
+        osc1[ch].setFastSine (shouldUseFastOscillators);
+        osc2[ch].setFastSine (shouldUseFastOscillators);
+    }
+}
+
+void SynthVoice::settleParams()
+{
+    for (int ch = 0; ch < numChannelsToProcess; ++ch)
+    {
+        osc1[ch].settle();
+        osc2[ch].settle();
+        filter[ch].settle();
     }
 }
 
 void SynthVoice::reset()
 {
-    gain.reset();
     adsr.reset();
     filterAdsr.reset();
+    hasFilterValues = false;
+}
+
+void SynthVoice::updateModParams (const int filterType, const float cutoff, const float resonance, const float adsrDepth, const float lfoDepth, const int fadeSamples)
+{
+    filterSettings = { filterType, cutoff, resonance, adsrDepth, lfoDepth, fadeSamples };
+    
+    // Only the first settings are taken as they are; after that the render glides to new ones
+    if (! hasFilterValues)
+    {
+        filterCutoff = getFilterCutoff();
+        filterResonance = filterSettings.resonance;
+        hasFilterValues = true;
+    }
+    
+    updateFilter();
 }
 
-void SynthVoice::updateModParams (const int filterType, const float filterCutoff, const float filterResonance, const float adsrDepth, const float lfoFreq, const float lfoDepth)
+float SynthVoice::getFilterCutoff() const
 {
-    auto cutoff = (adsrDepth * filterAdsrOutput) + filterCutoff;
-    cutoff = std::clamp<float> (cutoff, 20.0f, 20000.0f);
+    const auto cutoff = (filterSettings.adsrDepth * filterAdsrOutput) + (filterSettings.lfoDepth * lfoOutput) + filterSettings.cutoff;
+    return std::clamp<float> (cutoff, 20.0f, 20000.0f);
+}
 
+void SynthVoice::updateFilter()
+{
     for (int ch = 0; ch < numChannelsToProcess; ++ch)
     {
-        filter[ch].setParams (filterType, cutoff, filterResonance);
+        filter[ch].setParams (filterSettings.type, filterCutoff, filterResonance, filterSettings.fadeSamples);
     }
-    
-//    auto cutoff = (adsrDepth * adsr.getNextSample()) + filterCutoff;
-//
-//    DBG (cutoff);
-//
-//    for (int ch = 0; ch < numChannelsToProcess; ++ch)
-//    {
-//        lfo[ch].setFrequency (lfoFreq);
-//        //cutoff = (lfoDepth * lfoOutput[ch]) + cutoff;
-//        cutoff = std::clamp<float> (cutoff, 20.0f, 20000.0f);
-//        filter[ch].setParams (filterType, cutoff, filterResonance);
-//    }
 }
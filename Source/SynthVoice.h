@@ -2,9 +2,13 @@
 
 #include <JuceHeader.h>
 #include "SynthSound.h"
+#include "QuantumSynthesiser.h"
 #include "Data/OscData.h"
 #include "Data/FilterData.h"
 #include "Data/AdsrData.h"
+#include "Data/LfoData.h"
+#include "Data/TraceRecorder.h"
+#include "Data/OnsetMeter.h"
 
 class SynthVoice : public juce::SynthesiserVoice
 {
@@ -24,21 +28,81 @@ public:
     AdsrData& getAdsr() { return adsr; }
     AdsrData& getFilterAdsr() { return filterAdsr; }
     float getFilterAdsrOutput() { return filterAdsrOutput; }
-    void updateModParams (const int filterType, const float filterCutoff, const float filterResonance, const float adsrDepth, const float lfoFreq, const float lfoDepth);
+    void updateModParams (const int filterType, const float cutoff, const float resonance, const float adsrDepth, const float lfoDepth, const int fadeSamples);
+    
+    // Makes the parameters last set take effect at once, instead of fading and ramping to them
+    void settleParams();
+    void setFastOscillators (const bool shouldUseFastOscillators);
+    
+    // A released note still playing out, and not already being cut short
+    bool isReleaseTail() const { return isVoiceActive() && adsr.isReleasing() && tailFadeRemaining == 0; }
+    float getEnvelopeLevel() const { return adsr.getCurrentValue(); }
+    
+    // Ends a release tail early, with a short linear fade
+    void fadeOutTail (const int numSamples);
+    
+    // The processor's shared LFO bank, and this voice's lane in it
+    void setLfo (LfoData* bank, const int index) { lfo = bank; voiceIndex = index; }
+    
+    // The synth this voice plays in, for where inside the quantum its notes start
+    void setSynth (const QuantumSynthesiser* owner) { synth = owner; }
+    
+    // The note and the sample of the last render its output first rose above silence at;
+    // true once per note, after the render it was heard in
+    bool takeOnset (int& noteNumber, int& sample);
     
 private:
     static constexpr int numChannelsToProcess { 2 };
     std::array<OscData, numChannelsToProcess> osc1;
     std::array<OscData, numChannelsToProcess> osc2;
     std::array<FilterData, numChannelsToProcess> filter;
-    std::array<juce::dsp::Oscillator<float>, numChannelsToProcess> lfo;
     AdsrData adsr;
     AdsrData filterAdsr;
     juce::AudioBuffer<float> synthBuffer;
+    juce::AudioBuffer<float> envelopeBuffer;
     float filterAdsrOutput { 0.0f };
-    std::array<float, numChannelsToProcess> lfoOutput { 0.0f, 0.0f };
+    
+    LfoData* lfo { nullptr };
+    int voiceIndex { 0 };
+    float lfoOutput { 0.0f };
+    bool lfoNeedsSync { false };
+    
+    const QuantumSynthesiser* synth { nullptr };
+    int onsetDelay { 0 };
+    
+    int tailFadeLength { 0 };
+    int tailFadeRemaining { 0 };
+    
+    bool isAwaitingOnset { false };
+    int onsetNote { -1 };
+    int onsetSample { -1 };
+    void findOnset (const float* envelope, const int startSample, const int numSamples);
+    
+    // The filter envelope and LFO are control signals: the cutoff follows them once per step,
+    // gliding there in sub-steps so it doesn't jump, as the oscillators' gains ramp per sample
+    static constexpr int modulationStepSize { LfoData::stepSize };
+    static constexpr int filterGlideStepSize { 8 };
+    static_assert (OscData::rampLength == modulationStepSize, "Oscillator ramps should span one control step");
+    float filterCutoff { 20000.0f };
+    float filterResonance { 0.1f };
+    bool hasFilterValues { false };
+    float getFilterCutoff() const;
+    void updateFilter();
+    
+    struct FilterSettings
+    {
+        int type { 0 };
+        float cutoff { 20000.0f };
+        float resonance { 0.1f };
+        float adsrDepth { 0.0f };
+        float lfoDepth { 0.0f };
+        int fadeSamples { 0 };
+    };
+    
+    FilterSettings filterSettings;
 
     
-    juce::dsp::Gain<float> gain;
+    // Folded into the amp envelope, so level, envelope and mix into the output are one pass
+    static constexpr float voiceGain { 0.07f };
     bool isPrepared { false };
 };
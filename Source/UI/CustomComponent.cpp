@@ -1,5 +1,6 @@
 #include <JuceHeader.h>
 #include "CustomComponent.h"
+#include "../Data/TraceRecorder.h"
 
 //==============================================================================
 
@@ -49,6 +50,7 @@ CustomComponent::~CustomComponent()
 
 void CustomComponent::paint (juce::Graphics& g)
 {
+    TAPSYNTH_TRACE_SCOPE ("Panel paint");
     g.fillAll (juce::Colours::black);
     auto bounds = getLocalBounds();
     g.setColour (boundsColour);
@@ -2,10 +2,17 @@
 #include "LfoComponent.h"
 
 //==============================================================================
-LfoComponent::LfoComponent (juce::AudioProcessorValueTreeState& apvts, juce::String lfoFreqId, juce::String lfoDepthId)
+LfoComponent::LfoComponent (juce::AudioProcessorValueTreeState& apvts, juce::String lfoFreqId, juce::String lfoDepthId, juce::String lfoModeId)
 : lfoFreq ("LFO Freq", lfoFreqId, apvts, dialWidth, dialHeight)
 , lfoDepth ("LFO Depth", lfoDepthId, apvts, dialWidth, dialHeight)
 {
+    juce::StringArray lfoModeChoices { "Global", "Free", "Key Sync" };
+    lfoModeSelector.addItemList (lfoModeChoices, 1);
+    lfoModeSelector.setSelectedItemIndex (0);
+    addAndMakeVisible (lfoModeSelector);
+    
+    lfoModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(apvts, lfoModeId, lfoModeSelector);
+    
     addAndMakeVisible (lfoFreq);
     addAndMakeVisible (lfoDepth);
 }
@@ -18,8 +25,9 @@ void LfoComponent::resized()
 {
     const auto width = 70;
     const auto height = 88;
-    const auto startY = 40;
-        
+    const auto startY = 62;
+    
+    lfoModeSelector.setBounds (18, 36, 142, 22);
     lfoFreq.setBounds (18, startY, width, height);
     lfoDepth.setBounds (90, startY, width, height);
 }
@@ -9,7 +9,7 @@
 class LfoComponent  : public CustomComponent
 {
 public:
-    LfoComponent (juce::AudioProcessorValueTreeState& apvts, juce::String lfoFreqId, juce::String lfoDepthId);
+    LfoComponent (juce::AudioProcessorValueTreeState& apvts, juce::String lfoFreqId, juce::String lfoDepthId, juce::String lfoModeId);
     ~LfoComponent() override;
 
     void resized() override;
@@ -31,6 +31,9 @@ private:
     SliderWithLabel lfoFreq;
     SliderWithLabel lfoDepth;
     
+    juce::ComboBox lfoModeSelector;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> lfoModeAttachment;
+    
     static constexpr int dialWidth = 70;
     static constexpr int dialHeight = 70;
     
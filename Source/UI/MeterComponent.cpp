@@ -6,7 +6,7 @@ MeterComponent::MeterComponent (TapSynthAudioProcessor& p) : audioProcessor (p)
 {
     // In your constructor, you should add any child components, and
     // initialise any special settings that your component needs.
-
+    
 }
 
 MeterComponent::~MeterComponent()
@@ -14,6 +14,29 @@ MeterComponent::~MeterComponent()
 }
 
 void MeterComponent::paintOverChildren (juce::Graphics& g)
+{
+    TAPSYNTH_TRACE_SCOPE ("Meter paint");
+    
+    if (showsOnsets)
+        paintOnsets (g);
+    else
+        paintLevels (g);
+    
+    // The quality governor's tier, and blocks that ran late anyway
+    static const juce::StringArray tierNames { "Plena", "Menos caudas", "Osciladores leves", "Reverb leve" };
+    const auto tier = audioProcessor.getQualityTier();
+    const auto numOverruns = audioProcessor.getNumOverruns();
+    auto status = "Qualidade: " + tierNames[tier] + "   Atrasos: " + juce::String (numOverruns);
+    
+    if (showsOnsets)
+        status << "   Notas perdidas: " << audioProcessor.getOnsetMeter().getNumMissed();
+    
+    g.setColour (tier > QualityGovernor::full ? juce::Colour::fromRGB (246, 87, 64) : juce::Colours::grey);
+    g.setFont (12.0f);
+    g.drawText (status, getLocalBounds().removeFromBottom (22).reduced (20, 0), juce::Justification::centredLeft);
+}
+
+void MeterComponent::paintLevels (juce::Graphics& g)
 {
     auto bounds = getLocalBounds().reduced (20, 35).translated (0, 10);
     auto leftMeter = bounds.removeFromTop (bounds.getHeight() / 2).reduced (0, 5);
@@ -38,7 +61,76 @@ void MeterComponent::paintOverChildren (juce::Graphics& g)
     g.drawRoundedRectangle (rightMeter.toFloat(), 5, 2.0f);
 }
 
+void MeterComponent::paintOnsets (juce::Graphics& g)
+{
+    // One row per block size band that has heard a note: latency in ms, then its histogram
+    // over the range every band together covers, one bar per sample
+    const auto& onsets = audioProcessor.getOnsetMeter();
+    const auto msPerSample = 1000.0 / onsets.getSampleRate();
+    std::array<OnsetMeter::Histogram, OnsetMeter::numBlockSizeBands> histograms;
+    std::array<bool, OnsetMeter::numBlockSizeBands> hasOnsets {};
+    int first = OnsetMeter::numBins, last = 0;
+    
+    for (int band = 0; band < OnsetMeter::numBlockSizeBands; ++band)
+    {
+        hasOnsets[(size_t) band] = onsets.getHistogram (band, histograms[(size_t) band]);
+        
+        if (hasOnsets[(size_t) band])
+        {
+            first = juce::jmin (first, juce::jlimit (0, OnsetMeter::numBins - 1, histograms[(size_t) band].minimum));
+            last = juce::jmax (last, juce::jlimit (0, OnsetMeter::numBins - 1, histograms[(size_t) band].maximum));
+        }
+    }
+    
+    auto bounds = getLocalBounds().reduced (20, 0).withTrimmedTop (32).withTrimmedBottom (22);
+    g.setFont (12.0f);
+    
+    if (first > last)
+    {
+        g.setColour (juce::Colours::grey);
+        g.drawText ("Nenhuma nota medida", bounds, juce::Justification::centred);
+        return;
+    }
+    
+    for (int band = 0; band < OnsetMeter::numBlockSizeBands && bounds.getHeight() >= 16; ++band)
+    {
+        if (! hasOnsets[(size_t) band])
+            continue;
+        
+        const auto& histogram = histograms[(size_t) band];
+        auto row = bounds.removeFromTop (16);
+        const auto sizeText = histogram.maximumBlockSize > 0 ? "<= " + juce::String (histogram.maximumBlockSize)
+                                                             : "> " + juce::String (32 << (OnsetMeter::numBlockSizeBands - 2));
+        
+        g.setColour (juce::Colours::white);
+        g.drawText (sizeText.paddedRight (' ', 8) + juce::String (histogram.mean * msPerSample, 2) + " ms  jitter "
+                    + juce::String (histogram.deviation * msPerSample, 2) + "  max " + juce::String (histogram.maximum * msPerSample, 2),
+                    row.removeFromLeft (250), juce::Justification::centredLeft);
+        
+        juce::uint32 tallest = 1;
+        
+        for (int bin = first; bin <= last; ++bin)
+            tallest = juce::jmax (tallest, histogram.counts[(size_t) bin]);
+        
+        const auto barWidth = (float) row.getWidth() / (float) (last - first + 1);
+        g.setColour (juce::Colour::fromRGB (247, 190, 67));
+        
+        for (int bin = first; bin <= last; ++bin)
+        {
+            const auto height = (float) (row.getHeight() - 2) * (float) histogram.counts[(size_t) bin] / (float) tallest;
+            g.fillRect ((float) row.getX() + (float) (bin - first) * barWidth, (float) row.getBottom() - 1.0f - height,
+                        juce::jmax (1.0f, barWidth - 1.0f), height);
+        }
+    }
+}
+
 void MeterComponent::resized()
 {
-   
+
+}
+
+void MeterComponent::mouseDoubleClick (const juce::MouseEvent&)
+{
+    showsOnsets = ! showsOnsets;
+    repaint();
 }
@@ -12,12 +12,19 @@ class MeterComponent  : public CustomComponent
 public:
     MeterComponent (TapSynthAudioProcessor& p);
     ~MeterComponent() override;
-
+    
     void paintOverChildren (juce::Graphics& g) override;
     void resized() override;
-
+    
+    // Swaps the levels for the onset latency histograms, and back
+    void mouseDoubleClick (const juce::MouseEvent& event) override;
+    
 private:
+    void paintLevels (juce::Graphics& g);
+    void paintOnsets (juce::Graphics& g);
+    
     TapSynthAudioProcessor& audioProcessor;
+    bool showsOnsets { false };
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MeterComponent)
 };
@@ -0,0 +1,188 @@
+#include <JuceHeader.h>
+#include "PresetBrowserComponent.h"
+
+//==============================================================================
+PresetBrowserComponent::PresetBrowserComponent (TapSynthAudioProcessor& p) : audioProcessor (p)
+{
+    searchBox.setTextToShowWhenEmpty ("Buscar...", juce::Colours::grey);
+    searchBox.setColour (juce::TextEditor::backgroundColourId, juce::Colours::darkgrey.withAlpha (0.2f));
+    searchBox.setColour (juce::TextEditor::textColourId, juce::Colours::white);
+    searchBox.setColour (juce::TextEditor::outlineColourId, juce::Colours::darkgrey);
+    searchBox.onTextChange = [this]() { updateFilter(); };
+    addAndMakeVisible (searchBox);
+    
+    saveButton.onClick = [this]() { savePreset(); };
+    addAndMakeVisible (saveButton);
+    
+    similarButton.onClick = [this]() { showSimilar(); };
+    addAndMakeVisible (similarButton);
+    
+    presetList.setModel (this);
+    presetList.setRowHeight (rowHeight);
+    presetList.setColour (juce::ListBox::backgroundColourId, juce::Colours::black);
+    addAndMakeVisible (presetList);
+    
+    refresh();
+}
+
+PresetBrowserComponent::~PresetBrowserComponent()
+{
+    presetList.setModel (nullptr);
+}
+
+void PresetBrowserComponent::resized()
+{
+    auto bounds = getLocalBounds().reduced (18, 0).withTrimmedTop (45).withTrimmedBottom (18);
+    
+    searchBox.setBounds (bounds.removeFromTop (25));
+    auto buttons = bounds.removeFromBottom (25);
+    saveButton.setBounds (buttons.removeFromLeft (buttons.getWidth() / 2).withTrimmedRight (2));
+    similarButton.setBounds (buttons.withTrimmedLeft (2));
+    presetList.setBounds (bounds.reduced (0, 5));
+}
+
+void PresetBrowserComponent::refresh()
+{
+    updateFilter();
+    
+    const auto current = audioProcessor.getCurrentProgram();
+    
+    for (int row = 0; row < getNumRows(); ++row)
+    {
+        if (getPresetIndexForRow (row) == current)
+        {
+            presetList.selectRow (row, true, true);
+            presetList.scrollToEnsureRowIsOnscreen (row);
+            break;
+        }
+    }
+}
+
+int PresetBrowserComponent::getNumRows()
+{
+    return isFiltered ? (int) filteredRows.size() : audioProcessor.getPresetBank().getNumPresets();
+}
+
+void PresetBrowserComponent::paintListBoxItem (int rowNumber, juce::Graphics& g, int width, int height, bool rowIsSelected)
+{
+    const auto presetIndex = getPresetIndexForRow (rowNumber);
+    
+    if (presetIndex < 0)
+        return;
+    
+    if (rowIsSelected)
+    {
+        g.setColour (juce::Colour::fromRGB (247, 190, 67).withAlpha (0.3f));
+        g.fillRect (0, 0, width, height);
+    }
+    
+    const auto& bank = audioProcessor.getPresetBank();
+    
+    g.setFont (fontHeight);
+    g.setColour (juce::Colours::white);
+    g.drawText (bank.getName (presetIndex), 5, 0, width * 2 / 3 - 5, height, juce::Justification::centredLeft, true);
+    
+    g.setColour (juce::Colours::grey);
+    g.drawText (bank.getTags (presetIndex), width * 2 / 3, 0, width / 3 - 5, height, juce::Justification::centredRight, true);
+}
+
+void PresetBrowserComponent::selectedRowsChanged (int lastRowSelected)
+{
+    const auto presetIndex = getPresetIndexForRow (lastRowSelected);
+    
+    if (presetIndex < 0 || presetIndex == audioProcessor.getCurrentProgram())
+        return;
+    
+    audioProcessor.setCurrentProgram (presetIndex);
+    audioProcessor.updateHostDisplay (juce::AudioProcessor::ChangeDetails().withProgramChanged (true));
+}
+
+int PresetBrowserComponent::getPresetIndexForRow (const int row) const
+{
+    if (row < 0)
+        return -1;
+    
+    if (isFiltered)
+        return row < (int) filteredRows.size() ? filteredRows[(size_t) row] : -1;
+    
+    return row < audioProcessor.getPresetBank().getNumPresets() ? row : -1;
+}
+
+void PresetBrowserComponent::updateFilter()
+{
+    const auto text = searchBox.getText().trim();
+    const auto& bank = audioProcessor.getPresetBank();
+    
+    isAwaitingSimilar = false;
+    isFiltered = text.isNotEmpty();
+    filteredRows.clear();
+    
+    if (isFiltered)
+    {
+        const auto numPresets = bank.getNumPresets();
+        filteredRows.reserve ((size_t) numPresets);
+        
+        for (int i = 0; i < numPresets; ++i)
+        {
+            if (bank.matches (i, text))
+                filteredRows.push_back (i);
+        }
+    }
+    
+    presetList.updateContent();
+    presetList.repaint();
+}
+
+void PresetBrowserComponent::savePreset()
+{
+    auto name = searchBox.getText().trim();
+    
+    if (name.isEmpty())
+        name = "Preset " + juce::String (audioProcessor.getPresetBank().getNumPresets() + 1);
+    
+    if (! audioProcessor.savePreset (name, {}))
+    {
+        juce::AlertWindow::showMessageBoxAsync (juce::AlertWindow::WarningIcon,
+                                                "Preset Error",
+                                                "Could not write the preset bank:\n" + audioProcessor.getPresetBank().getFile().getFullPathName());
+        return;
+    }
+    
+    searchBox.clear();
+    refresh();
+}
+
+void PresetBrowserComponent::showSimilar()
+{
+    isAwaitingSimilar = true;
+    similarButton.setEnabled (false);
+    
+    audioProcessor.findSimilarPresets (maxSimilar, [safeThis = juce::Component::SafePointer<PresetBrowserComponent> (this)] (const std::vector<int>& presets)
+    {
+        if (safeThis != nullptr)
+            safeThis->showSimilar (presets);
+    });
+}
+
+void PresetBrowserComponent::showSimilar (const std::vector<int>& presets)
+{
+    similarButton.setEnabled (true);
+    
+    if (! isAwaitingSimilar)
+        return;
+    
+    // Ranked by sound rather than name; typing in the search box goes back to text matches
+    isAwaitingSimilar = false;
+    filteredRows = presets;
+    isFiltered = true;
+    
+    if (filteredRows.empty() && audioProcessor.isSimilarityIndexUpdating())
+        searchBox.setTextToShowWhenEmpty ("Indexando...", juce::Colours::grey);
+    else
+        searchBox.setTextToShowWhenEmpty ("Buscar...", juce::Colours::grey);
+    
+    presetList.updateContent();
+    presetList.deselectAllRows();
+    presetList.scrollToEnsureRowIsOnscreen (0);
+    presetList.repaint();
+}
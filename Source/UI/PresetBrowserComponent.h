@@ -0,0 +1,48 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../PluginProcessor.h"
+#include "CustomComponent.h"
+
+//==============================================================================
+/*
+*/
+class PresetBrowserComponent  : public CustomComponent
+                              , private juce::ListBoxModel
+{
+public:
+    PresetBrowserComponent (TapSynthAudioProcessor& p);
+    ~PresetBrowserComponent() override;
+
+    void resized() override;
+    void refresh();
+
+private:
+    int getNumRows() override;
+    void paintListBoxItem (int rowNumber, juce::Graphics& g, int width, int height, bool rowIsSelected) override;
+    void selectedRowsChanged (int lastRowSelected) override;
+    
+    int getPresetIndexForRow (const int row) const;
+    void updateFilter();
+    void savePreset();
+    void showSimilar();
+    void showSimilar (const std::vector<int>& presets);
+
+    TapSynthAudioProcessor& audioProcessor;
+    juce::TextEditor searchBox;
+    juce::TextButton saveButton { "Salvar" };
+    juce::TextButton similarButton { "Similares" };
+    juce::ListBox presetList;
+    
+    // Rows map straight to bank indices unless a search or similarity list is active
+    std::vector<int> filteredRows;
+    bool isFiltered { false };
+    
+    // Similar presets arrive later, and are dropped if a search has replaced the list by then
+    bool isAwaitingSimilar { false };
+    
+    static constexpr int rowHeight { 20 };
+    static constexpr int maxSimilar { 20 };
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetBrowserComponent)
+};
@@ -0,0 +1,82 @@
+#include <JuceHeader.h>
+#include "PreviewComponent.h"
+
+//==============================================================================
+PreviewComponent::PreviewComponent (TapSynthAudioProcessor& p) : audioProcessor (p)
+{
+    for (int i = 0; i < maxPreviews; ++i)
+    {
+        auto* button = previewButtons.add (new juce::TextButton (juce::String::charToString ((juce::juce_wchar) ('A' + i))));
+        button->setClickingTogglesState (false);
+        button->onClick = [this, i]() { selectPreview (i); };
+        addAndMakeVisible (button);
+    }
+    
+    stopButton.onClick = [this]() { audioProcessor.stopPreview(); };
+    addAndMakeVisible (stopButton);
+    
+    commitButton.onClick = [this]()
+    {
+        if (selectedPreview >= 0)
+            audioProcessor.commitPreview (selectedPreview);
+    };
+    addAndMakeVisible (commitButton);
+    
+    audioProcessor.getPreviewRenderer().addListener (this);
+    previewsChanged();
+}
+
+PreviewComponent::~PreviewComponent()
+{
+    audioProcessor.getPreviewRenderer().removeListener (this);
+}
+
+void PreviewComponent::paint (juce::Graphics& g)
+{
+    TAPSYNTH_TRACE_SCOPE ("Preview strip paint");
+    const auto& renderer = audioProcessor.getPreviewRenderer();
+    
+    g.setColour (juce::Colours::white);
+    g.setFont (fontHeight);
+    g.drawText (renderer.isRendering() ? "Renderizando..." : juce::String (juce::CharPointer_UTF8 ("Pr\xc3\xa9vias")), 15, 0, 110, getHeight(), juce::Justification::centredLeft);
+}
+
+void PreviewComponent::resized()
+{
+    auto bounds = getLocalBounds().withTrimmedLeft (130).reduced (0, 5);
+    
+    for (auto* button : previewButtons)
+        button->setBounds (bounds.removeFromLeft (50).reduced (3, 0));
+    
+    bounds.removeFromLeft (20);
+    stopButton.setBounds (bounds.removeFromLeft (70).reduced (3, 0));
+    commitButton.setBounds (bounds.removeFromLeft (70).reduced (3, 0));
+}
+
+void PreviewComponent::previewsChanged()
+{
+    const auto& renderer = audioProcessor.getPreviewRenderer();
+    const auto numPreviews = renderer.getNumPreviews();
+    
+    if (selectedPreview >= numPreviews)
+        selectedPreview = -1;
+    
+    for (int i = 0; i < previewButtons.size(); ++i)
+    {
+        auto* button = previewButtons[i];
+        button->setVisible (i < numPreviews);
+        button->setEnabled (renderer.getPreview (i).audio != nullptr);
+        button->setToggleState (i == selectedPreview, juce::dontSendNotification);
+    }
+    
+    commitButton.setEnabled (selectedPreview >= 0);
+    repaint();
+}
+
+void PreviewComponent::selectPreview (const int index)
+{
+    // Clicking a candidate auditions it from the top; "Usar" morphs the live patch to it
+    selectedPreview = index;
+    audioProcessor.playPreview (index);
+    previewsChanged();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../PluginProcessor.h"
+#include "CustomComponent.h"
+
+//==============================================================================
+/*
+*/
+class PreviewComponent  : public juce::Component
+                        , private PreviewRenderer::Listener
+{
+public:
+    PreviewComponent (TapSynthAudioProcessor& p);
+    ~PreviewComponent() override;
+
+    void paint (juce::Graphics& g) override;
+    void resized() override;
+
+    static constexpr int maxPreviews { 4 };
+
+private:
+    void previewsChanged() override;
+    void selectPreview (const int index);
+
+    TapSynthAudioProcessor& audioProcessor;
+    juce::OwnedArray<juce::TextButton> previewButtons;
+    juce::TextButton stopButton { "Parar" };
+    juce::TextButton commitButton { "Usar" };
+    int selectedPreview { -1 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PreviewComponent)
+};
@@ -0,0 +1,291 @@
+/*
+  ==============================================================================
+
+    DatasetCommand.cpp
+    Created: 18 Oct 2026 9:07:18pm
+
+  ==============================================================================
+*/
+
+#include "ToolCommands.h"
+#include "ToolHelpers.h"
+
+namespace
+{
+    // Every setting that changes what a sample index renders to; a resumed run must match it exactly
+    struct DatasetSettings
+    {
+        juce::File directory;
+        int count { 0 };
+        int shardSize { 0 };
+        juce::int64 seed { 0 };
+        double sampleRate { 0.0 };
+        bool rawFormat { false };
+        
+        juce::var toJson() const
+        {
+            auto* obj = new juce::DynamicObject();
+            obj->setProperty ("count", count);
+            obj->setProperty ("shardSize", shardSize);
+            obj->setProperty ("seed", seed);
+            obj->setProperty ("sampleRate", sampleRate);
+            obj->setProperty ("format", rawFormat ? "raw" : "wav");
+            obj->setProperty ("blockSize", blockSize);
+            
+            juce::Array<juce::var> phraseNames;
+            
+            for (const auto& phrase : ToolHelpers::getDatasetPhrases())
+                phraseNames.add (phrase.name);
+            
+            obj->setProperty ("phrases", phraseNames);
+            
+            juce::Array<juce::var> parameterIds;
+            
+            for (const auto* paramId : PatchData::parameterIds)
+                parameterIds.add (juce::String (paramId));
+            
+            obj->setProperty ("parameters", parameterIds);
+            
+            juce::Array<juce::var> featureNames;
+            
+            for (const auto& name : AudioFeatureExtractor::getFeatureNames())
+                featureNames.add (name);
+            
+            obj->setProperty ("features", featureNames);
+            return juce::var (obj);
+        }
+        
+        int getNumShards() const { return (count + shardSize - 1) / shardSize; }
+        juce::File getShardDirectory (const int shard) const { return directory.getChildFile ("shard-" + juce::String (shard).paddedLeft ('0', 5)); }
+        
+        static constexpr int blockSize { 512 };
+    };
+    
+    // Shards that couldn't be finished, reported once the pool is done
+    struct ShardFailures
+    {
+        juce::CriticalSection lock;
+        juce::StringArray messages;
+    };
+    
+    class ShardJob : public juce::ThreadPoolJob
+    {
+    public:
+        ShardJob (const DatasetSettings& s, const int sh, std::atomic<int>& done, ShardFailures& f)
+        : juce::ThreadPoolJob ("Dataset shard"), settings (s), shard (sh), samplesDone (done), failures (f), extractor (s.sampleRate)
+        {
+        }
+        
+        JobStatus runJob() override
+        {
+            // A shard is all or nothing: a partial one from an interrupted run starts over
+            const auto directory = settings.getShardDirectory (shard);
+            directory.deleteRecursively();
+            directory.createDirectory();
+            
+            juce::FileOutputStream meta (directory.getChildFile ("meta.jsonl"));
+            std::unique_ptr<juce::FileOutputStream> rawAudio;
+            juce::int64 rawFrameOffset = 0;
+            
+            if (settings.rawFormat)
+                rawAudio = std::make_unique<juce::FileOutputStream> (directory.getChildFile ("audio.f32"));
+            
+            if (meta.failedToOpen() || (rawAudio != nullptr && rawAudio->failedToOpen()))
+                return fail ("could not create its files in " + directory.getFullPathName());
+            
+            const auto first = shard * settings.shardSize;
+            const auto last = juce::jmin (settings.count, first + settings.shardSize);
+            juce::AudioBuffer<float> audio;
+            
+            for (int index = first; index < last; ++index)
+            {
+                if (shouldExit())
+                    return jobHasFinished;
+                
+                // Seeded by index alone, so any sample can be regenerated on its own
+                juce::Random random (settings.seed * 1000003 + index);
+                const auto params = ToolHelpers::sampleRandomParams (random);
+                
+                auto* record = new juce::DynamicObject();
+                juce::var recordVar (record);
+                juce::Array<juce::var> renders;
+                record->setProperty ("index", index);
+                
+                for (const auto& phrase : ToolHelpers::getDatasetPhrases())
+                {
+                    // A fresh instance per render, so no voice or reverb state leaks between samples
+                    auto instance = TapSynthAudioProcessor::createHeadlessInstance (params);
+                    
+                    if (instance == nullptr)
+                        return fail ("could not create an instance for sample " + juce::String (index));
+                    
+                    if (! record->hasProperty ("params"))
+                    {
+                        PatchData patch;
+                        patch.captureFrom (instance->apvts);
+                        record->setProperty ("params", patch.toJson());
+                    }
+                    
+                    if (! phrase.render (*instance, audio, settings.sampleRate, DatasetSettings::blockSize))
+                        return fail ("could not render sample " + juce::String (index) + ", " + phrase.name);
+                    
+                    auto* render = new juce::DynamicObject();
+                    render->setProperty ("phrase", phrase.name);
+                    render->setProperty ("numChannels", audio.getNumChannels());
+                    render->setProperty ("numFrames", audio.getNumSamples());
+                    render->setProperty ("peak", audio.getMagnitude (0, audio.getNumSamples()));
+                    render->setProperty ("rms", audio.getRMSLevel (0, 0, audio.getNumSamples()));
+                    
+                    juce::Array<juce::var> features;
+                    
+                    for (const auto value : extractor.process (audio))
+                        features.add (value);
+                    
+                    render->setProperty ("features", features);
+                    
+                    if (rawAudio != nullptr)
+                    {
+                        // Planar float32: every channel in turn, frames counted per channel
+                        for (int ch = 0; ch < audio.getNumChannels(); ++ch)
+                            if (! rawAudio->write (audio.getReadPointer (ch), sizeof (float) * (size_t) audio.getNumSamples()))
+                                return fail ("could not write audio.f32");
+                        
+                        render->setProperty ("frameOffset", rawFrameOffset);
+                        rawFrameOffset += (juce::int64) audio.getNumSamples() * audio.getNumChannels();
+                    }
+                    else
+                    {
+                        const auto fileName = juce::String (index).paddedLeft ('0', 9) + "-" + phrase.name + ".wav";
+                        
+                        if (! ToolHelpers::writeWav (directory.getChildFile (fileName), audio, settings.sampleRate))
+                            return fail ("could not write " + fileName);
+                        
+                        render->setProperty ("file", fileName);
+                    }
+                    
+                    renders.add (juce::var (render));
+                }
+                
+                record->setProperty ("renders", renders);
+                meta << juce::JSON::toString (recordVar, true) << "\n";
+                samplesDone.fetch_add (1);
+            }
+            
+            meta.flush();
+            
+            if (rawAudio != nullptr)
+                rawAudio->flush();
+            
+            // Only a shard whose every file made it to disk is marked, so anything less is redone next run
+            if (meta.getStatus().failed() || (rawAudio != nullptr && rawAudio->getStatus().failed()))
+                return fail ("could not finish writing its files");
+            
+            if (! directory.getChildFile ("complete").create())
+                return fail ("could not mark it complete");
+            
+            return jobHasFinished;
+        }
+        
+    private:
+        JobStatus fail (const juce::String& reason)
+        {
+            const juce::ScopedLock sl (failures.lock);
+            failures.messages.add ("Shard " + juce::String (shard) + " failed: " + reason);
+            return jobHasFinished;
+        }
+        
+        const DatasetSettings& settings;
+        const int shard;
+        std::atomic<int>& samplesDone;
+        ShardFailures& failures;
+        AudioFeatureExtractor extractor;
+    };
+    
+    void runDataset (const juce::ArgumentList& args)
+    {
+        if (! args.containsOption ("--out"))
+            juce::ConsoleApplication::fail ("Missing --out <folder>");
+        
+        DatasetSettings settings;
+        settings.directory = juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--out").unquoted());
+        settings.count = ToolHelpers::getIntOption (args, "--count", 10000);
+        settings.shardSize = juce::jmax (1, ToolHelpers::getIntOption (args, "--shard-size", 1000));
+        settings.seed = ToolHelpers::getIntOption (args, "--seed", 1);
+        settings.sampleRate = ToolHelpers::getDoubleOption (args, "--rate", 44100.0);
+        settings.rawFormat = ToolHelpers::getStringOption (args, "--format", "wav") == "raw";
+        const auto numThreads = ToolHelpers::getIntOption (args, "--threads", ToolHelpers::getDefaultNumThreads());
+        
+        if (! settings.directory.createDirectory())
+            juce::ConsoleApplication::fail ("Could not create " + settings.directory.getFullPathName());
+        
+        const auto manifestFile = settings.directory.getChildFile ("dataset.json");
+        const auto manifest = juce::JSON::toString (settings.toJson());
+        
+        if (manifestFile.existsAsFile())
+        {
+            if (juce::JSON::toString (juce::JSON::parse (manifestFile)) != manifest)
+                juce::ConsoleApplication::fail ("The output folder holds a dataset made with different settings");
+        }
+        else
+        {
+            manifestFile.replaceWithText (manifest);
+        }
+        
+        // Resume: finished shards are skipped, anything else is rendered from scratch
+        std::vector<int> pendingShards;
+        int alreadyDone = 0;
+        
+        for (int shard = 0; shard < settings.getNumShards(); ++shard)
+        {
+            if (settings.getShardDirectory (shard).getChildFile ("complete").existsAsFile())
+                alreadyDone += juce::jmin (settings.shardSize, settings.count - shard * settings.shardSize);
+            else
+                pendingShards.push_back (shard);
+        }
+        std::cout << "Rendering " << settings.count << " samples in " << settings.getNumShards() << " shards, "
+                  << pendingShards.size() << " still to do, on " << numThreads << " threads" << std::endl;
+        
+        // Shards are independent, so throughput grows with the number of threads
+        ToolHelpers::getParameterRanges();
+        std::atomic<int> samplesDone { 0 };
+        ShardFailures failures;
+        juce::ThreadPool pool (numThreads);
+        
+        for (const auto shard : pendingShards)
+            pool.addJob (new ShardJob (settings, shard, samplesDone, failures), true);
+        
+        const auto startTime = juce::Time::getMillisecondCounterHiRes();
+        
+        while (pool.getNumJobs() > 0)
+        {
+            juce::Thread::sleep (1000);
+            
+            const auto done = samplesDone.load();
+            const auto seconds = (juce::Time::getMillisecondCounterHiRes() - startTime) * 0.001;
+            std::cout << "\r" << alreadyDone + done << " / " << settings.count
+                      << " samples, " << juce::String (done / juce::jmax (0.001, seconds), 1) << " per second" << std::flush;
+        }
+        
+        std::cout << std::endl;
+        
+        for (const auto& message : failures.messages)
+            std::cerr << message << std::endl;
+        
+        if (! failures.messages.isEmpty())
+            juce::ConsoleApplication::fail (juce::String (failures.messages.size()) + " shards failed; run again with the same settings to redo them");
+        
+        std::cout << "Done" << std::endl;
+    }
+}
+
+juce::ConsoleApplication::Command createDatasetCommand()
+{
+    return { "dataset",
+             "dataset --out <folder> [--count N] [--shard-size N] [--seed N] [--rate Hz] [--format wav|raw] [--threads N]",
+             "Renders random patches to a sharded (parameters, audio, features) dataset",
+             "Samples parameter vectors uniformly from the plugin's parameter ranges and renders the fixed "
+             "dataset phrases for each with an independent headless instance. Samples are grouped into shards "
+             "that are written by one worker each; interrupted runs resume from the first unfinished shard "
+             "when started again with the same settings.",
+             runDataset };
+}
@@ -0,0 +1,35 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 18 Oct 2026 8:55:02pm
+
+    Headless command line tools built on the plugin's own processor.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ToolCommands.h"
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // Processors expect a message manager to exist, even though nothing here runs its loop
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    
+    juce::ConsoleApplication app;
+    app.addHelpCommand ("--help|-h", "Usage: tapSynthTools <command> [options]", true);
+    app.addVersionCommand ("--version|-v", "tapSynthTools 1.0");
+    
+    app.addCommand (createDatasetCommand());
+    app.addCommand (createMatchCommand());
+    app.addCommand (createScaleCommand());
+    app.addCommand (createStressCommand());
+    app.addCommand (createTelemetryCommand());
+    app.addCommand (createReplayCommand());
+    app.addCommand (createOnsetCommand());
+    app.addCommand (createStandInCommand());
+    
+    return app.findAndRunCommand (argc, argv);
+}
@@ -0,0 +1,512 @@
+/*
+  ==============================================================================
+
+    MatchCommand.cpp
+    Created: 18 Oct 2026 10:41:09pm
+
+  ==============================================================================
+*/
+
+#include "ToolCommands.h"
+#include "ToolHelpers.h"
+
+namespace
+{
+    // Multi-resolution STFT distance to a fixed target: spectral convergence plus
+    // mean absolute log-magnitude difference, averaged over three frame sizes so
+    // both transients and partials count. Not thread-safe; one per worker.
+    class SpectralLoss
+    {
+    public:
+        explicit SpectralLoss (const std::vector<float>& target)
+        {
+            for (const auto order : { 8, 10, 11 })
+            {
+                Resolution res;
+                res.fft = std::make_unique<juce::dsp::FFT> (order);
+                res.size = 1 << order;
+                res.hop = res.size / 4;
+                res.numBins = res.size / 2 + 1;
+                res.window.resize ((size_t) res.size);
+                juce::dsp::WindowingFunction<float>::fillWindowingTables (res.window.data(), (size_t) res.size,
+                                                                          juce::dsp::WindowingFunction<float>::hann, false);
+                
+                res.numFrames = juce::jmax (0, ((int) target.size() - res.size) / res.hop + 1);
+                res.targetMagnitudes.resize ((size_t) (res.numFrames * res.numBins));
+                res.targetLogMagnitudes.resize (res.targetMagnitudes.size());
+                
+                for (int f = 0; f < res.numFrames; ++f)
+                {
+                    auto* magnitudes = res.targetMagnitudes.data() + (size_t) (f * res.numBins);
+                    analyse (res, target.data() + f * res.hop, magnitudes);
+                    
+                    for (int bin = 0; bin < res.numBins; ++bin)
+                        res.targetLogMagnitudes[(size_t) (f * res.numBins + bin)] = std::log (magnitudes[bin] + magnitudeFloor);
+                }
+                
+                resolutions.push_back (std::move (res));
+            }
+        }
+        
+        // Over the frames that fit in the first numSamples, so a partly rendered clip gets a comparable score
+        float compute (const float* signal, const int numSamples)
+        {
+            float total = 0.0f;
+            int numResolutions = 0;
+            
+            for (auto& res : resolutions)
+            {
+                const auto numFrames = juce::jmin (res.numFrames, (numSamples - res.size) / res.hop + 1);
+                
+                if (numFrames <= 0)
+                    continue;
+                
+                magnitudes.resize ((size_t) res.numBins);
+                double differenceSquared = 0.0, targetSquared = 0.0, logDifference = 0.0;
+                
+                for (int f = 0; f < numFrames; ++f)
+                {
+                    analyse (res, signal + f * res.hop, magnitudes.data());
+                    const auto* target = res.targetMagnitudes.data() + (size_t) (f * res.numBins);
+                    const auto* targetLog = res.targetLogMagnitudes.data() + (size_t) (f * res.numBins);
+                    
+                    for (int bin = 0; bin < res.numBins; ++bin)
+                    {
+                        const auto difference = magnitudes[(size_t) bin] - target[bin];
+                        differenceSquared += difference * difference;
+                        targetSquared += target[bin] * target[bin];
+                        logDifference += std::abs (std::log (magnitudes[(size_t) bin] + magnitudeFloor) - targetLog[bin]);
+                    }
+                }
+                
+                total += (float) (std::sqrt (differenceSquared / (targetSquared + 1.0e-9))
+                                  + logDifference / (double) (numFrames * res.numBins));
+                ++numResolutions;
+            }
+            
+            return numResolutions > 0 ? total / (float) numResolutions : std::numeric_limits<float>::max();
+        }
+        
+        int getMinimumSamples() const { return resolutions.back().size; }
+        
+    private:
+        struct Resolution
+        {
+            std::unique_ptr<juce::dsp::FFT> fft;
+            int size { 0 };
+            int hop { 0 };
+            int numBins { 0 };
+            int numFrames { 0 };
+            std::vector<float> window;
+            std::vector<float> targetMagnitudes;       // numFrames x numBins
+            std::vector<float> targetLogMagnitudes;
+        };
+        
+        void analyse (Resolution& res, const float* input, float* output)
+        {
+            frame.assign ((size_t) (2 * res.size), 0.0f);
+            juce::FloatVectorOperations::multiply (frame.data(), input, res.window.data(), res.size);
+            res.fft->performFrequencyOnlyForwardTransform (frame.data(), true);
+            juce::FloatVectorOperations::copy (output, frame.data(), res.numBins);
+        }
+        
+        static constexpr float magnitudeFloor { 1.0e-5f };
+        
+        std::vector<Resolution> resolutions;
+        std::vector<float> frame;
+        std::vector<float> magnitudes;
+    };
+    
+    // Separable CMA-ES: a diagonal covariance keeps the update O(n) per sample and
+    // still learns per-parameter step sizes, which is what matters with mostly
+    // independent synth controls. Searches the [0, 1] normalised parameter space.
+    class DiagonalCmaEs
+    {
+    public:
+        DiagonalCmaEs (std::vector<float> initialMean, const float initialSigma, const int populationSize, const juce::int64 seed)
+        : n ((int) initialMean.size()), lambda (populationSize), mu (populationSize / 2)
+        , mean (std::move (initialMean)), sigma (initialSigma), random (seed)
+        {
+            for (int i = 0; i < mu; ++i)
+                weights.push_back (std::log (mu + 0.5) - std::log (i + 1.0));
+            
+            const auto weightSum = std::accumulate (weights.begin(), weights.end(), 0.0);
+            double weightSquares = 0.0;
+            
+            for (auto& w : weights)
+            {
+                w /= weightSum;
+                weightSquares += w * w;
+            }
+            
+            muEff = 1.0 / weightSquares;
+            cc = 4.0 / (n + 4.0);
+            cs = (muEff + 2.0) / (n + muEff + 5.0);
+            
+            // The separable variant can afford the faster learning rates, scaled by (n + 2) / 3
+            c1 = juce::jmin (1.0, 2.0 / ((n + 1.3) * (n + 1.3) + muEff) * (n + 2.0) / 3.0);
+            cMu = juce::jmin (1.0 - c1, 2.0 * (muEff - 2.0 + 1.0 / muEff) / ((n + 2.0) * (n + 2.0) + muEff) * (n + 2.0) / 3.0);
+            damps = 1.0 + 2.0 * juce::jmax (0.0, std::sqrt ((muEff - 1.0) / (n + 1.0)) - 1.0) + cs;
+            chiN = std::sqrt ((double) n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+            
+            variances.assign ((size_t) n, 1.0);
+            pc.assign ((size_t) n, 0.0);
+            ps.assign ((size_t) n, 0.0);
+        }
+        
+        // New candidates, mean + sigma * sqrt (C) * z, clamped into range for evaluation
+        const std::vector<std::vector<float>>& sample()
+        {
+            z.assign ((size_t) lambda, std::vector<double> ((size_t) n));
+            candidates.assign ((size_t) lambda, std::vector<float> ((size_t) n));
+            
+            for (int k = 0; k < lambda; ++k)
+            {
+                for (int i = 0; i < n; ++i)
+                {
+                    z[(size_t) k][(size_t) i] = gaussian();
+                    const auto x = mean[(size_t) i] + sigma * std::sqrt (variances[(size_t) i]) * z[(size_t) k][(size_t) i];
+                    candidates[(size_t) k][(size_t) i] = juce::jlimit (0.0f, 1.0f, (float) x);
+                }
+            }
+            
+            return candidates;
+        }
+        
+        // Losses in the same order as sample() returned; lower is better
+        void update (const std::vector<float>& losses)
+        {
+            std::vector<int> order ((size_t) lambda);
+            std::iota (order.begin(), order.end(), 0);
+            std::stable_sort (order.begin(), order.end(), [&] (int a, int b) { return losses[(size_t) a] < losses[(size_t) b]; });
+            
+            std::vector<double> zw ((size_t) n, 0.0), yw ((size_t) n, 0.0);
+            
+            for (int j = 0; j < mu; ++j)
+            {
+                const auto& zk = z[(size_t) order[(size_t) j]];
+                
+                for (int i = 0; i < n; ++i)
+                {
+                    zw[(size_t) i] += weights[(size_t) j] * zk[(size_t) i];
+                    yw[(size_t) i] += weights[(size_t) j] * std::sqrt (variances[(size_t) i]) * zk[(size_t) i];
+                }
+            }
+            
+            ++generation;
+            double psNorm = 0.0;
+            
+            for (int i = 0; i < n; ++i)
+            {
+                mean[(size_t) i] = juce::jlimit (0.0f, 1.0f, (float) (mean[(size_t) i] + sigma * yw[(size_t) i]));
+                ps[(size_t) i] = (1.0 - cs) * ps[(size_t) i] + std::sqrt (cs * (2.0 - cs) * muEff) * zw[(size_t) i];
+                psNorm += ps[(size_t) i] * ps[(size_t) i];
+            }
+            
+            psNorm = std::sqrt (psNorm);
+            const auto hSig = psNorm / std::sqrt (1.0 - std::pow (1.0 - cs, 2.0 * generation)) / chiN < 1.4 + 2.0 / (n + 1.0);
+            
+            for (int i = 0; i < n; ++i)
+            {
+                pc[(size_t) i] = (1.0 - cc) * pc[(size_t) i] + (hSig ? std::sqrt (cc * (2.0 - cc) * muEff) * yw[(size_t) i] : 0.0);
+                
+                double rankMu = 0.0;
+                
+                for (int j = 0; j < mu; ++j)
+                {
+                    const auto y = std::sqrt (variances[(size_t) i]) * z[(size_t) order[(size_t) j]][(size_t) i];
+                    rankMu += weights[(size_t) j] * y * y;
+                }
+                
+                variances[(size_t) i] = (1.0 - c1 - cMu) * variances[(size_t) i]
+                                      + c1 * (pc[(size_t) i] * pc[(size_t) i] + (hSig ? 0.0 : cc * (2.0 - cc) * variances[(size_t) i]))
+                                      + cMu * rankMu;
+            }
+            
+            sigma *= std::exp ((cs / damps) * (psNorm / chiN - 1.0));
+        }
+        
+        const std::vector<float>& getMean() const { return mean; }
+        double getSigma() const { return sigma; }
+        int getNumParents() const { return mu; }
+        
+    private:
+        double gaussian()
+        {
+            // Box-Muller; juce::Random only hands out uniform values
+            const auto u1 = juce::jmax (1.0e-12, random.nextDouble());
+            const auto u2 = random.nextDouble();
+            return std::sqrt (-2.0 * std::log (u1)) * std::cos (juce::MathConstants<double>::twoPi * u2);
+        }
+        
+        const int n, lambda, mu;
+        std::vector<double> weights;
+        double muEff, cc, cs, c1, cMu, damps, chiN;
+        
+        std::vector<float> mean;
+        double sigma;
+        std::vector<double> variances, pc, ps;
+        int generation { 0 };
+        
+        std::vector<std::vector<double>> z;
+        std::vector<std::vector<float>> candidates;
+        juce::Random random;
+    };
+    
+    struct MatchSettings
+    {
+        std::vector<float> target;
+        double sampleRate { 44100.0 };
+        AuditionPhrase phrase;
+        float pruneFactor { 1.5f };
+        float checkpoint { 0.4f };
+        
+        static constexpr int blockSize { 512 };
+    };
+    
+    struct Evaluation
+    {
+        float loss { std::numeric_limits<float>::max() };
+        bool pruned { false };
+    };
+    
+    // Scores every candidate on a pool of workers, each with its own loss scratch.
+    // A candidate whose loss over the first part of the phrase is already well
+    // behind this generation's parents is abandoned without rendering the rest.
+    class ParallelEvaluator
+    {
+    public:
+        ParallelEvaluator (const MatchSettings& s, const int numThreads)
+        : settings (s), pool (numThreads)
+        {
+            for (int i = 0; i < numThreads; ++i)
+                losses.push_back (std::make_unique<SpectralLoss> (settings.target));
+        }
+        
+        std::vector<Evaluation> evaluate (const std::vector<std::vector<float>>& candidates, const float pruneThreshold)
+        {
+            std::vector<Evaluation> results (candidates.size());
+            std::atomic<int> next { 0 };
+            std::atomic<int> remaining { (int) losses.size() };
+            juce::WaitableEvent finished;
+            
+            for (auto& loss : losses)
+            {
+                pool.addJob ([&, lossScratch = loss.get()]
+                {
+                    for (auto k = next.fetch_add (1); k < (int) candidates.size(); k = next.fetch_add (1))
+                        results[(size_t) k] = evaluate (candidates[(size_t) k], *lossScratch, pruneThreshold);
+                    
+                    if (remaining.fetch_sub (1) == 1)
+                        finished.signal();
+                });
+            }
+            
+            finished.wait();
+            return results;
+        }
+        
+        Evaluation evaluate (const std::vector<float>& candidate, SpectralLoss& loss, const float pruneThreshold)
+        {
+            Evaluation result;
+            auto instance = TapSynthAudioProcessor::createHeadlessInstance (ToolHelpers::denormaliseParams (candidate));
+            
+            if (instance == nullptr)
+                return result;
+            
+            const auto totalSamples = settings.phrase.getNumSamples (settings.sampleRate);
+            const auto checkpoint = juce::jmax (loss.getMinimumSamples(), (int) ((float) totalSamples * settings.checkpoint));
+            juce::AudioBuffer<float> clip;
+            std::vector<float> mono;
+            int samplesRendered = 0;
+            bool checked = pruneThreshold >= std::numeric_limits<float>::max();
+            
+            // render() asks before each block, so the clip holds samplesRendered samples at this point
+            const auto shouldExit = [&]
+            {
+                if (! checked && samplesRendered >= checkpoint)
+                {
+                    checked = true;
+                    mixToMono (clip, samplesRendered, mono);
+                    result.loss = loss.compute (mono.data(), samplesRendered);
+                    result.pruned = result.loss > pruneThreshold;
+                }
+                
+                samplesRendered += MatchSettings::blockSize;
+                return result.pruned;
+            };
+            
+            if (! settings.phrase.render (*instance, clip, settings.sampleRate, MatchSettings::blockSize, shouldExit))
+                return result;
+            
+            mixToMono (clip, clip.getNumSamples(), mono);
+            result.loss = loss.compute (mono.data(), clip.getNumSamples());
+            result.pruned = false;
+            return result;
+        }
+        
+    private:
+        static void mixToMono (const juce::AudioBuffer<float>& clip, const int numSamples, std::vector<float>& mono)
+        {
+            mono.assign ((size_t) numSamples, 0.0f);
+            
+            for (int ch = 0; ch < clip.getNumChannels(); ++ch)
+                juce::FloatVectorOperations::addWithMultiply (mono.data(), clip.getReadPointer (ch), 1.0f / (float) clip.getNumChannels(), numSamples);
+        }
+        
+        const MatchSettings& settings;
+        juce::ThreadPool pool;
+        std::vector<std::unique_ptr<SpectralLoss>> losses;
+    };
+    
+    // Pruned candidates rank behind every completed one, in order of their partial loss
+    std::vector<float> getRankingLosses (const std::vector<Evaluation>& evaluations)
+    {
+        float worstCompleted = 0.0f;
+        
+        for (const auto& e : evaluations)
+            if (! e.pruned && e.loss < std::numeric_limits<float>::max())
+                worstCompleted = juce::jmax (worstCompleted, e.loss);
+        
+        std::vector<float> ranking;
+        
+        for (const auto& e : evaluations)
+            ranking.push_back (e.pruned ? worstCompleted + e.loss : e.loss);
+        
+        return ranking;
+    }
+    
+    void runMatch (const juce::ArgumentList& args)
+    {
+        if (! args.containsOption ("--target") || ! args.containsOption ("--out"))
+            juce::ConsoleApplication::fail ("Missing --target <audio file> or --out <json file>");
+        
+        const auto cwd = juce::File::getCurrentWorkingDirectory();
+        const auto targetFile = cwd.getChildFile (args.getValueForOption ("--target").unquoted());
+        const auto outFile = cwd.getChildFile (args.getValueForOption ("--out").unquoted());
+        
+        juce::AudioBuffer<float> targetAudio;
+        MatchSettings settings;
+        
+        if (! ToolHelpers::readAudioFile (targetFile, targetAudio, settings.sampleRate))
+            juce::ConsoleApplication::fail ("Could not read " + targetFile.getFullPathName());
+        
+        // The target is compared against the same phrase played in the candidate patches
+        const auto phraseName = ToolHelpers::getStringOption (args, "--phrase", "note");
+        
+        for (const auto& phrase : ToolHelpers::getDatasetPhrases())
+            if (phrase.name == phraseName)
+                settings.phrase = phrase;
+        
+        if (settings.phrase.notes.empty())
+            juce::ConsoleApplication::fail ("Unknown phrase " + phraseName);
+        
+        const auto transpose = ToolHelpers::getIntOption (args, "--note", 60) - 60;
+        
+        for (auto& note : settings.phrase.notes)
+            note.noteNumber = juce::jlimit (0, 127, note.noteNumber + transpose);
+        
+        // Mono, cut or padded to the phrase, since candidates are rendered at exactly that length
+        settings.target.assign ((size_t) settings.phrase.getNumSamples (settings.sampleRate), 0.0f);
+        const auto targetLength = juce::jmin ((int) settings.target.size(), targetAudio.getNumSamples());
+        
+        for (int ch = 0; ch < targetAudio.getNumChannels(); ++ch)
+            juce::FloatVectorOperations::addWithMultiply (settings.target.data(), targetAudio.getReadPointer (ch),
+                                                          1.0f / (float) targetAudio.getNumChannels(), targetLength);
+        
+        const auto numDimensions = (int) ToolHelpers::getParameterRanges().size();
+        const auto population = juce::jmax (4, ToolHelpers::getIntOption (args, "--population", 4 + (int) (3.0 * std::log ((double) numDimensions))));
+        const auto generations = ToolHelpers::getIntOption (args, "--generations", 150);
+        const auto seed = (juce::int64) ToolHelpers::getIntOption (args, "--seed", 1);
+        const auto numThreads = ToolHelpers::getIntOption (args, "--threads", ToolHelpers::getDefaultNumThreads());
+        settings.pruneFactor = (float) ToolHelpers::getDoubleOption (args, "--prune", 1.5);
+        
+        ParallelEvaluator evaluator (settings, numThreads);
+        
+        // Start from the best of a random scan; the parameter space has plenty of silent or degenerate corners
+        juce::Random random (seed);
+        std::vector<std::vector<float>> scan ((size_t) (population * 4), std::vector<float> ((size_t) numDimensions));
+        
+        for (auto& candidate : scan)
+            for (auto& value : candidate)
+                value = random.nextFloat();
+        
+        const auto scanResults = evaluator.evaluate (scan, std::numeric_limits<float>::max());
+        size_t bestScan = 0;
+        
+        for (size_t k = 1; k < scanResults.size(); ++k)
+            if (scanResults[k].loss < scanResults[bestScan].loss)
+                bestScan = k;
+        
+        auto bestParams = scan[bestScan];
+        auto bestLoss = scanResults[bestScan].loss;
+        std::cout << "Random scan of " << scan.size() << " patches, best loss " << bestLoss << std::endl;
+        
+        DiagonalCmaEs optimiser (bestParams, 0.25f, population, seed);
+        auto pruneThreshold = std::numeric_limits<float>::max();
+        
+        for (int generation = 0; generation < generations && optimiser.getSigma() > 1.0e-4; ++generation)
+        {
+            const auto& candidates = optimiser.sample();
+            const auto evaluations = evaluator.evaluate (candidates, pruneThreshold);
+            const auto ranking = getRankingLosses (evaluations);
+            int numPruned = 0;
+            
+            for (size_t k = 0; k < evaluations.size(); ++k)
+            {
+                numPruned += evaluations[k].pruned ? 1 : 0;
+                
+                if (! evaluations[k].pruned && evaluations[k].loss < bestLoss)
+                {
+                    bestLoss = evaluations[k].loss;
+                    bestParams = candidates[k];
+                }
+            }
+            
+            // Next generation: anything this far behind the last parent's loss can't become a parent
+            auto sorted = ranking;
+            std::sort (sorted.begin(), sorted.end());
+            pruneThreshold = sorted[(size_t) (optimiser.getNumParents() - 1)] * settings.pruneFactor;
+            
+            optimiser.update (ranking);
+            
+            std::cout << "Generation " << generation + 1 << ": best " << bestLoss << ", sigma " << optimiser.getSigma()
+                      << ", " << numPruned << " of " << evaluations.size() << " stopped early" << std::endl;
+        }
+        
+        // Written through the processor, so the file holds exactly what applyParametersFromJson will set
+        auto instance = TapSynthAudioProcessor::createHeadlessInstance (ToolHelpers::denormaliseParams (bestParams));
+        
+        if (instance == nullptr)
+            juce::ConsoleApplication::fail ("Could not create the matched patch");
+        
+        PatchData patch;
+        patch.captureFrom (instance->apvts);
+        
+        if (! outFile.replaceWithText (juce::JSON::toString (patch.toJson())))
+            juce::ConsoleApplication::fail ("Could not write " + outFile.getFullPathName());
+        
+        if (args.containsOption ("--render"))
+        {
+            juce::AudioBuffer<float> audio;
+            settings.phrase.render (*instance, audio, settings.sampleRate, MatchSettings::blockSize);
+            ToolHelpers::writeWav (cwd.getChildFile (args.getValueForOption ("--render").unquoted()), audio, settings.sampleRate);
+        }
+        
+        std::cout << "Best loss " << bestLoss << ", written to " << outFile.getFullPathName() << std::endl;
+    }
+}
+
+juce::ConsoleApplication::Command createMatchCommand()
+{
+    return { "match",
+             "match --target <audio file> --out <json file> [--phrase note|chord|arpeggio] [--note N] [--population N] "
+             "[--generations N] [--prune F] [--seed N] [--threads N] [--render <wav file>]",
+             "Searches for the patch that best reproduces a target recording",
+             "Renders the chosen dataset phrase (transposed so its root is --note) through candidate patches "
+             "and scores them against the target with a multi-resolution spectral loss. The search is a "
+             "separable CMA-ES over the normalised parameters, seeded from a random scan; each generation is "
+             "evaluated in parallel on headless instances, and candidates that are clearly losing by the "
+             "checkpoint are stopped early. The result is parameter JSON as applyParametersFromJson takes it.",
+             runMatch };
+}
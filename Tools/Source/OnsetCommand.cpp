@@ -0,0 +1,185 @@
+/*
+  ==============================================================================
+
+    OnsetCommand.cpp
+    Created: 19 Oct 2026 5:02:37am
+
+  ==============================================================================
+*/
+
+#include "ToolCommands.h"
+#include "ToolHelpers.h"
+
+namespace
+{
+    struct NoteEvent
+    {
+        juce::int64 position;
+        juce::MidiMessage message;
+    };
+    
+    // The same notes for every block size: placed in samples, then cut into whichever blocks are played.
+    // Chords go past the polyphony, so some notes have to steal a voice
+    std::vector<NoteEvent> makeNotes (juce::Random& random, const double sampleRate, const juce::int64 totalSamples)
+    {
+        std::vector<NoteEvent> events;
+        const auto toSamples = [sampleRate] (const double seconds) { return (juce::int64) (seconds * sampleRate); };
+        
+        for (auto position = toSamples (0.05); position < totalSamples; position += toSamples (0.01 + 0.24 * random.nextDouble()))
+        {
+            const auto numNotes = random.nextInt (10) == 0 ? 3 + random.nextInt (6) : 1;
+            
+            for (int i = 0; i < numNotes; ++i)
+            {
+                const auto note = 24 + random.nextInt (84);
+                const auto length = toSamples (0.03 + 0.57 * random.nextDouble());
+                events.push_back ({ position, juce::MidiMessage::noteOn (1, note, 0.2f + 0.8f * random.nextFloat()) });
+                events.push_back ({ position + length, juce::MidiMessage::noteOff (1, note) });
+            }
+        }
+        
+        std::stable_sort (events.begin(), events.end(), [] (const NoteEvent& a, const NoteEvent& b) { return a.position < b.position; });
+        return events;
+    }
+    
+    juce::String getBandName (const OnsetMeter::Histogram& histogram)
+    {
+        return histogram.maximumBlockSize > 0 ? "<= " + juce::String (histogram.maximumBlockSize)
+                                              : "> " + juce::String (32 << (OnsetMeter::numBlockSizeBands - 2));
+    }
+    
+    void printHistogram (const OnsetMeter::Histogram& histogram, const double msPerSample)
+    {
+        const auto first = juce::jlimit (0, OnsetMeter::numBins - 1, histogram.minimum);
+        const auto last = juce::jlimit (0, OnsetMeter::numBins - 1, histogram.maximum);
+        juce::uint32 tallest = 1;
+        
+        for (int bin = first; bin <= last; ++bin)
+            tallest = juce::jmax (tallest, histogram.counts[(size_t) bin]);
+        
+        for (int bin = first; bin <= last; ++bin)
+        {
+            const auto count = histogram.counts[(size_t) bin];
+            const auto label = bin == OnsetMeter::numBins - 1 ? juce::String (bin) + "+" : juce::String (bin);
+            
+            std::cout << "      " << label.paddedLeft (' ', 5)
+                      << juce::String (bin * msPerSample, 3).paddedLeft (' ', 9) << " ms  "
+                      << juce::String::repeatedString ("#", (int) (50 * (juce::uint64) count / tallest)).paddedRight (' ', 50)
+                      << juce::String ((int) count).paddedLeft (' ', 8) << std::endl;
+        }
+    }
+    
+    void runOnset (const juce::ArgumentList& args)
+    {
+        const auto seed = (juce::int64) ToolHelpers::getIntOption (args, "--seed", 1);
+        const auto sampleRate = ToolHelpers::getDoubleOption (args, "--rate", 44100.0);
+        const auto seconds = juce::jmax (1.0, ToolHelpers::getDoubleOption (args, "--seconds", 60.0));
+        const auto shouldSplit = args.containsOption ("--split");
+        const auto totalSamples = (juce::int64) (seconds * sampleRate);
+        const auto msPerSample = 1000.0 / sampleRate;
+        
+        juce::Array<int> blockSizes;
+        
+        for (const auto& token : juce::StringArray::fromTokens (ToolHelpers::getStringOption (args, "--blocks", "32,64,128,256,512,1024"), ",", {}))
+            if (token.getIntValue() > 0)
+                blockSizes.add (token.getIntValue());
+        
+        if (blockSizes.isEmpty())
+            juce::ConsoleApplication::fail ("--blocks needs at least one size, e.g. --blocks 64,256,1024");
+        
+        juce::Random noteRandom (seed);
+        const auto notes = makeNotes (noteRandom, sampleRate, totalSamples);
+        
+        std::cout << "Playing " << notes.size() / 2 << " notes over " << seconds << " s at " << sampleRate << " Hz"
+                  << (shouldSplit ? ", each block split in two" : "") << std::endl;
+        
+        juce::ScopedNoDenormals noDenormals;
+        juce::StringArray summary;
+        
+        for (const auto blockSize : blockSizes)
+        {
+            TapSynthAudioProcessor instance (true);
+            instance.setRateAndBufferSizeDetails (sampleRate, blockSize);
+            instance.prepareToPlay (sampleRate, blockSize);
+            
+            juce::AudioBuffer<float> buffer (juce::jmax (1, instance.getTotalNumOutputChannels()), blockSize);
+            juce::MidiBuffer midi;
+            midi.ensureSize (2048);
+            
+            // Split points come from the seed too, and are the same for every run at this size
+            juce::Random splitRandom (seed + blockSize);
+            size_t nextNote = 0;
+            
+            for (juce::int64 position = 0; position < totalSamples;)
+            {
+                auto numSamples = (int) juce::jmin ((juce::int64) blockSize - position % blockSize, totalSamples - position);
+                
+                // Every other block comes in two pieces; the rest of it follows in the next one
+                if (shouldSplit && position % blockSize == 0 && (position / blockSize) % 2 == 0 && numSamples > 1)
+                    numSamples = 1 + splitRandom.nextInt (numSamples - 1);
+                
+                midi.clear();
+                
+                for (; nextNote < notes.size() && notes[nextNote].position < position + numSamples; ++nextNote)
+                    midi.addEvent (notes[nextNote].message, (int) (notes[nextNote].position - position));
+                
+                buffer.setSize (buffer.getNumChannels(), numSamples, false, false, true);
+                buffer.clear();
+                instance.processBlock (buffer, midi);
+                position += numSamples;
+            }
+            
+            const auto& onsets = instance.getOnsetMeter();
+            std::cout << std::endl << "Block size " << blockSize << ", reported latency " << instance.getLatencySamples()
+                      << " samples, " << onsets.getNumMissed() << " notes never heard" << std::endl;
+            
+            for (int band = 0; band < OnsetMeter::numBlockSizeBands; ++band)
+            {
+                OnsetMeter::Histogram histogram;
+                
+                if (! onsets.getHistogram (band, histogram))
+                    continue;
+                
+                std::cout << "  blocks " << getBandName (histogram) << ": " << histogram.numOnsets << " onsets, latency mean "
+                          << juce::String (histogram.mean, 2) << " samples (" << juce::String (histogram.mean * msPerSample, 3)
+                          << " ms), jitter " << juce::String (histogram.deviation, 2) << " samples ("
+                          << juce::String (histogram.deviation * msPerSample, 3) << " ms), min " << histogram.minimum
+                          << ", p50 " << histogram.getPercentile (0.5) << ", p99 " << histogram.getPercentile (0.99)
+                          << ", max " << histogram.maximum << std::endl;
+                
+                printHistogram (histogram, msPerSample);
+                
+                summary.add (juce::String (blockSize).paddedLeft (' ', 7) + getBandName (histogram).paddedLeft (' ', 10)
+                             + juce::String (histogram.numOnsets).paddedLeft (' ', 9)
+                             + juce::String (histogram.mean * msPerSample, 3).paddedLeft (' ', 10)
+                             + juce::String (histogram.deviation * msPerSample, 3).paddedLeft (' ', 10)
+                             + juce::String (histogram.getPercentile (0.99) * msPerSample, 3).paddedLeft (' ', 10)
+                             + juce::String (histogram.maximum * msPerSample, 3).paddedLeft (' ', 10)
+                             + juce::String (onsets.getNumMissed()).paddedLeft (' ', 8));
+            }
+        }
+        
+        std::cout << std::endl << juce::String ("block").paddedLeft (' ', 7) << juce::String ("band").paddedLeft (' ', 10)
+                  << juce::String ("onsets").paddedLeft (' ', 9) << juce::String ("mean ms").paddedLeft (' ', 10)
+                  << juce::String ("jitter").paddedLeft (' ', 10) << juce::String ("p99 ms").paddedLeft (' ', 10)
+                  << juce::String ("max ms").paddedLeft (' ', 10) << juce::String ("missed").paddedLeft (' ', 8) << std::endl;
+        
+        for (const auto& row : summary)
+            std::cout << row << std::endl;
+    }
+}
+
+juce::ConsoleApplication::Command createOnsetCommand()
+{
+    return { "onset",
+             "onset [--blocks 32,64,...] [--split] [--seconds N] [--rate Hz] [--seed N]",
+             "Measures how long notes take from their note-on to being heard, and how much that varies, per block size",
+             "Plays the same seeded run of notes and chords, some past the polyphony so they steal voices, "
+             "through a headless instance with the default patch once for each of --blocks. Every note-on is "
+             "timed from its sample in the host block it arrived in to the first output sample its voice "
+             "rose above -120 dB at; the latency includes the plugin's reported latency. Prints the mean, "
+             "jitter (standard deviation), percentiles and a histogram for each band of block sizes the "
+             "notes came in, then a summary. --split cuts every other block in two at a seeded point, as "
+             "hosts do around automation, so the notes arrive in uneven blocks.",
+             runOnset };
+}
@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    ReplayCommand.cpp
+    Created: 19 Oct 2026 3:58:20am
+
+  ==============================================================================
+*/
+
+#include "ToolCommands.h"
+#include "ToolHelpers.h"
+
+namespace
+{
+    // Through the listeners, as the host's changes reached the live instance, so the raw values processBlock reads follow
+    void applyValues (TapSynthAudioProcessor& instance, const SessionRecorder::Values& values)
+    {
+        for (const auto& [index, value] : values)
+            if (auto* param = instance.apvts.getParameter (PatchData::parameterIds[(size_t) index]))
+                param->setValueNotifyingHost (param->convertTo0to1 (value));
+    }
+    
+    double getPercentile (const std::vector<double>& sorted, const double fraction)
+    {
+        if (sorted.empty())
+            return 0.0;
+        
+        return sorted[(size_t) juce::jlimit (0, (int) sorted.size() - 1, (int) std::ceil (fraction * (double) sorted.size()) - 1)];
+    }
+    
+    void runReplay (const juce::ArgumentList& args)
+    {
+        if (! args.containsOption ("--in"))
+            juce::ConsoleApplication::fail ("Missing --in <capture>");
+        
+        const auto captureFile = juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--in").unquoted());
+        const auto numRepeats = juce::jmax (1, ToolHelpers::getIntOption (args, "--repeat", 1));
+        
+        std::vector<SessionRecorder::Segment> segments;
+        juce::String error;
+        
+        if (! SessionRecorder::read (captureFile, segments, error))
+            juce::ConsoleApplication::fail (error);
+        
+        size_t numBlocks = 0;
+        int totalSamples = 0;
+        double seconds = 0.0;
+        
+        for (const auto& segment : segments)
+        {
+            numBlocks += segment.blocks.size();
+            
+            for (const auto& block : segment.blocks)
+            {
+                totalSamples += block.numSamples;
+                seconds += block.numSamples / segment.sampleRate;
+            }
+        }
+        
+        std::cout << "Replaying " << numBlocks << " blocks, " << juce::String (seconds, 1) << " s in "
+                  << segments.size() << " segments, " << numRepeats << " times" << std::endl;
+        
+        const auto writeAudio = args.containsOption ("--out");
+        juce::AudioBuffer<float> rendered (2, writeAudio ? totalSamples : 0);
+        rendered.clear();
+        std::vector<double> micros, loads;
+        juce::ScopedNoDenormals noDenormals;
+        
+        for (int repeat = 0; repeat < numRepeats; ++repeat)
+        {
+            // A fresh instance per repeat, so each one starts from the same silence
+            TapSynthAudioProcessor instance (true);
+            juce::AudioBuffer<float> buffer;
+            juce::MidiBuffer midi;
+            int renderedSamples = 0;
+            
+            for (const auto& segment : segments)
+            {
+                applyValues (instance, segment.initialValues);
+                instance.setRateAndBufferSizeDetails (segment.sampleRate, segment.maximumBlockSize);
+                instance.prepareToPlay (segment.sampleRate, segment.maximumBlockSize);
+                buffer.setSize (juce::jmax (1, instance.getTotalNumOutputChannels()), juce::jmax (1, segment.maximumBlockSize));
+                
+                for (const auto& block : segment.blocks)
+                {
+                    applyValues (instance, block.changes);
+                    instance.setQualityTierOverride (block.qualityTier);
+                    midi = block.midi;
+                    
+                    // The live instance pulled this patch at the top of the block, before rendering any of it
+                    if (block.startsMorph)
+                    {
+                        auto patch = instance.getLatestPatch();
+                        
+                        for (const auto& [index, value] : block.morphTarget)
+                            patch.setValue (index, value);
+                        
+                        instance.applyPatch (patch, block.morphSeconds);
+                    }
+                    
+                    buffer.setSize (buffer.getNumChannels(), block.numSamples, false, false, true);
+                    buffer.clear();
+                    
+                    const auto start = juce::Time::getHighResolutionTicks();
+                    instance.processBlock (buffer, midi);
+                    const auto taken = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+                    
+                    micros.push_back (taken * 1.0e6);
+                    loads.push_back (taken * segment.sampleRate / juce::jmax (1, block.numSamples));
+                    
+                    if (repeat == 0 && writeAudio)
+                    {
+                        for (int ch = 0; ch < juce::jmin (buffer.getNumChannels(), rendered.getNumChannels()); ++ch)
+                            rendered.copyFrom (ch, renderedSamples, buffer, ch, 0, block.numSamples);
+                        
+                        renderedSamples += block.numSamples;
+                    }
+                }
+            }
+            
+            std::cout << "\r" << repeat + 1 << " / " << numRepeats << std::flush;
+        }
+        
+        std::cout << std::endl << std::endl;
+        std::sort (micros.begin(), micros.end());
+        std::sort (loads.begin(), loads.end());
+        
+        std::cout << juce::String ("").paddedRight (' ', 8)
+                  << juce::String ("p50").paddedLeft (' ', 10) << juce::String ("p99").paddedLeft (' ', 10)
+                  << juce::String ("p99.9").paddedLeft (' ', 10) << juce::String ("max").paddedLeft (' ', 10) << std::endl;
+        
+        const auto printRow = [] (const juce::String& name, const std::vector<double>& sorted, const int decimals)
+        {
+            std::cout << name.paddedRight (' ', 8);
+            
+            for (const auto fraction : { 0.5, 0.99, 0.999, 1.0 })
+                std::cout << juce::String (getPercentile (sorted, fraction), decimals).paddedLeft (' ', 10);
+            
+            std::cout << std::endl;
+        };
+        
+        printRow ("us", micros, 1);
+        printRow ("load", loads, 3);
+        
+        if (writeAudio)
+        {
+            const auto outFile = juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--out").unquoted());
+            
+            if (! ToolHelpers::writeWav (outFile, rendered, segments.front().sampleRate))
+                juce::ConsoleApplication::fail ("Could not write " + outFile.getFullPathName());
+        }
+    }
+}
+
+juce::ConsoleApplication::Command createReplayCommand()
+{
+    return { "replay",
+             "replay --in <capture> [--out <file.wav>] [--repeat N]",
+             "Plays a session captured with TAPSYNTH_CAPTURE_FILE back through a headless instance",
+             "Feeds the captured block sizes, sample rates, MIDI, parameter changes, patch morphs and quality "
+             "tiers into a headless instance exactly as the live one received them, and prints the per-block "
+             "render time distribution. --repeat plays the capture several times over, for a profiler to "
+             "sample; --out writes the audio of the first pass. Preview auditions mixed into the live output "
+             "are not part of a capture.",
+             runReplay };
+}
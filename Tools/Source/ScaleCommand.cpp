@@ -0,0 +1,312 @@
+/*
+  ==============================================================================
+
+    ScaleCommand.cpp
+    Created: 19 Oct 2026 1:21:37am
+
+  ==============================================================================
+*/
+
+#include "ToolCommands.h"
+#include "ToolHelpers.h"
+#include "../../Source/Data/JobThreads.h"
+
+#if JUCE_LINUX
+ #include <unistd.h>
+#elif JUCE_MAC
+ #include <mach/mach.h>
+#endif
+
+namespace
+{
+    struct ScaleSettings
+    {
+        double sampleRate { 0.0 };
+        int blockSize { 0 };
+        int numThreads { 0 };
+        double seconds { 0.0 };
+        juce::int64 seed { 0 };
+        
+        int getNumCycles() const { return juce::jmax (1, juce::roundToInt (seconds * sampleRate / blockSize)); }
+        double getCycleDeadline() const { return blockSize / sampleRate; }
+    };
+    
+    // Resident memory of this process in bytes, or -1 where we can't tell
+    juce::int64 getResidentBytes()
+    {
+       #if JUCE_LINUX
+        const auto fields = juce::StringArray::fromTokens (juce::File ("/proc/self/statm").loadFileAsString(), true);
+        
+        if (fields.size() > 1)
+            return fields[1].getLargeIntValue() * (juce::int64) sysconf (_SC_PAGESIZE);
+       #elif JUCE_MAC
+        mach_task_basic_info info;
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+        
+        if (task_info (mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) == KERN_SUCCESS)
+            return (juce::int64) info.resident_size;
+       #endif
+        
+        return -1;
+    }
+    
+    // One plugin instance as a host drives it: its own buffers, and a player that
+    // keeps swapping chords so the voices, filters and reverb all have work to do
+    struct HostedInstance
+    {
+        HostedInstance (const ScaleSettings& settings, const int index)
+        : random (settings.seed * 1000003 + index)
+        {
+            // A full instance, as a host would load, so its memory and processing cost
+            // include everything headless ones leave out. Isolated, though: the user's
+            // bank, similarity index updates and telemetry slots would skew the timings
+            processor = std::make_unique<TapSynthAudioProcessor> (false, true);
+            
+            PatchData patch;
+            patch.captureFrom (processor->apvts);
+            
+            if (! processor->createPatchFromJson (ToolHelpers::sampleRandomParams (random), patch))
+            {
+                processor.reset();
+                return;
+            }
+            
+            patch.applyTo (processor->apvts);
+            processor->setRateAndBufferSizeDetails (settings.sampleRate, settings.blockSize);
+            processor->prepareToPlay (settings.sampleRate, settings.blockSize);
+            buffer.setSize (juce::jmax (1, processor->getTotalNumOutputChannels()), settings.blockSize);
+            midi.ensureSize (64);
+        }
+        
+        void processBlock (const ScaleSettings& settings)
+        {
+            midi.clear();
+            samplesUntilChange -= settings.blockSize;
+            
+            if (samplesUntilChange <= 0)
+            {
+                for (const auto note : heldNotes)
+                    midi.addEvent (juce::MidiMessage::noteOff (1, note), 0);
+                
+                heldNotes.clear();
+                const auto root = 36 + random.nextInt (36);
+                const auto offset = random.nextInt (settings.blockSize);
+                
+                for (const auto interval : { 0, 4, 7, 11 })
+                {
+                    heldNotes.push_back (root + interval);
+                    midi.addEvent (juce::MidiMessage::noteOn (1, root + interval, 0.8f), offset);
+                }
+                
+                samplesUntilChange = juce::roundToInt (settings.sampleRate * (0.25 + 0.75 * random.nextDouble()));
+            }
+            
+            buffer.clear();
+            const auto start = juce::Time::getHighResolutionTicks();
+            processor->processBlock (buffer, midi);
+            ticks += juce::Time::getHighResolutionTicks() - start;
+            ++numBlocks;
+        }
+        
+        std::unique_ptr<TapSynthAudioProcessor> processor;
+        juce::AudioBuffer<float> buffer;
+        juce::MidiBuffer midi;
+        juce::Random random;
+        std::vector<int> heldNotes;
+        int samplesUntilChange { 0 };
+        juce::int64 ticks { 0 };
+        int numBlocks { 0 };
+    };
+    
+    // Audio threads the way a host runs them: every cycle, each instance's next
+    // block goes to whichever thread takes it first, and the cycle ends when the
+    // last of them is done. The calling thread works too.
+    class HostThreads
+    {
+    public:
+        HostThreads (std::vector<std::unique_ptr<HostedInstance>>& instances, const ScaleSettings& settings)
+        : numInstances ((int) instances.size())
+        , threads ("Host audio", [&instances, &settings] (const int index) { instances[(size_t) index]->processBlock (settings); })
+        {
+            threads.start (juce::jmin (settings.numThreads, numInstances) - 1);
+        }
+        
+        void runCycle() { threads.run (numInstances); }
+        
+        int getNumThreads() const { return threads.getNumWorkers() + 1; }
+        
+    private:
+        const int numInstances;
+        JobThreads threads;
+    };
+    
+    struct StepResult
+    {
+        int numInstances { 0 };
+        int numThreads { 0 };
+        double realtimeFactor { 0.0 };  // seconds of audio from all instances together, per second of wall time
+        double microsPerBlock { 0.0 };  // processBlock alone, averaged over every instance
+        double bytesPerInstance { -1.0 };
+        int numLateCycles { 0 };
+    };
+    
+    StepResult runStep (const ScaleSettings& settings, const int numInstances)
+    {
+        StepResult result;
+        result.numInstances = numInstances;
+        
+        const auto bytesBefore = getResidentBytes();
+        std::vector<std::unique_ptr<HostedInstance>> instances;
+        
+        for (int i = 0; i < numInstances; ++i)
+        {
+            instances.push_back (std::make_unique<HostedInstance> (settings, i));
+            
+            if (instances.back()->processor == nullptr)
+                juce::ConsoleApplication::fail ("Could not create a plugin instance");
+        }
+        
+        HostThreads host (instances, settings);
+        result.numThreads = host.getNumThreads();
+        
+        // Untimed, so the first notes' allocations and cold caches don't count
+        const auto numWarmUpCycles = juce::jmax (1, juce::roundToInt (0.5 * settings.sampleRate / settings.blockSize));
+        
+        for (int cycle = 0; cycle < numWarmUpCycles; ++cycle)
+            host.runCycle();
+        
+        if (bytesBefore >= 0)
+            result.bytesPerInstance = (double) (getResidentBytes() - bytesBefore) / numInstances;
+        
+        for (auto& instance : instances)
+        {
+            instance->ticks = 0;
+            instance->numBlocks = 0;
+        }
+        
+        const auto numCycles = settings.getNumCycles();
+        const auto start = juce::Time::getHighResolutionTicks();
+        
+        for (int cycle = 0; cycle < numCycles; ++cycle)
+        {
+            const auto cycleStart = juce::Time::getHighResolutionTicks();
+            host.runCycle();
+            
+            if (juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - cycleStart) > settings.getCycleDeadline())
+                ++result.numLateCycles;
+        }
+        
+        const auto wallSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+        result.realtimeFactor = numInstances * numCycles * settings.getCycleDeadline() / juce::jmax (1.0e-9, wallSeconds);
+        
+        juce::int64 totalTicks = 0;
+        int totalBlocks = 0;
+        
+        for (auto& instance : instances)
+        {
+            totalTicks += instance->ticks;
+            totalBlocks += instance->numBlocks;
+        }
+        
+        result.microsPerBlock = 1.0e6 * juce::Time::highResolutionTicksToSeconds (totalTicks) / juce::jmax (1, totalBlocks);
+        return result;
+    }
+    
+    void runScale (const juce::ArgumentList& args)
+    {
+        ScaleSettings settings;
+        settings.sampleRate = ToolHelpers::getDoubleOption (args, "--rate", 44100.0);
+        settings.blockSize = juce::jmax (1, ToolHelpers::getIntOption (args, "--block", 256));
+        settings.numThreads = juce::jmax (1, ToolHelpers::getIntOption (args, "--threads", ToolHelpers::getDefaultNumThreads()));
+        settings.seconds = juce::jmax (0.1, ToolHelpers::getDoubleOption (args, "--seconds", 5.0));
+        settings.seed = ToolHelpers::getIntOption (args, "--seed", 1);
+        const auto maxInstances = juce::jmax (1, ToolHelpers::getIntOption (args, "--max", 128));
+        const auto linearThreshold = ToolHelpers::getDoubleOption (args, "--linear-threshold", 0.8);
+        
+        // Doubling from 1, and the maximum itself when it isn't a power of two
+        std::vector<int> steps;
+        
+        for (int n = 1; n < maxInstances; n *= 2)
+            steps.push_back (n);
+        
+        steps.push_back (maxInstances);
+        
+        std::cout << "Scaling to " << maxInstances << " instances on up to " << settings.numThreads << " host threads, "
+                  << settings.blockSize << " sample blocks at " << settings.sampleRate << " Hz, "
+                  << settings.seconds << " s of audio per step" << std::endl << std::endl;
+        
+        std::cout << juce::String ("instances").paddedLeft (' ', 10)
+                  << juce::String ("threads").paddedLeft (' ', 9)
+                  << juce::String ("realtime x").paddedLeft (' ', 12)
+                  << juce::String ("us/block").paddedLeft (' ', 10)
+                  << juce::String ("slowdown").paddedLeft (' ', 10)
+                  << juce::String ("efficiency").paddedLeft (' ', 12)
+                  << juce::String ("MB/instance").paddedLeft (' ', 13)
+                  << juce::String ("late").paddedLeft (' ', 7) << std::endl;
+        
+        std::vector<StepResult> results;
+        int firstSublinear = 0;
+        
+        for (const auto numInstances : steps)
+        {
+            const auto result = runStep (settings, numInstances);
+            results.push_back (result);
+            const auto& single = results.front();
+            
+            // Per-block cost against one instance alone shows the cache and memory bandwidth
+            // pressure; efficiency also takes in the threads running out
+            const auto slowdown = result.microsPerBlock / juce::jmax (1.0e-9, single.microsPerBlock);
+            const auto efficiency = result.realtimeFactor / juce::jmax (1.0e-9, single.realtimeFactor * juce::jmin (numInstances, settings.numThreads));
+            
+            if (firstSublinear == 0 && efficiency < linearThreshold)
+                firstSublinear = numInstances;
+            
+            std::cout << juce::String (numInstances).paddedLeft (' ', 10)
+                      << juce::String (result.numThreads).paddedLeft (' ', 9)
+                      << juce::String (result.realtimeFactor, 1).paddedLeft (' ', 12)
+                      << juce::String (result.microsPerBlock, 1).paddedLeft (' ', 10)
+                      << juce::String (slowdown, 2).paddedLeft (' ', 10)
+                      << juce::String (100.0 * efficiency, 0).paddedLeft (' ', 11) << "%"
+                      << (result.bytesPerInstance >= 0.0 ? juce::String (result.bytesPerInstance / (1024.0 * 1024.0), 2)
+                                                         : juce::String ("n/a")).paddedLeft (' ', 13)
+                      << juce::String (result.numLateCycles).paddedLeft (' ', 7) << std::endl;
+        }
+        
+        std::cout << std::endl;
+        
+        if (firstSublinear > 0)
+            std::cout << "Scaling stops being linear at " << firstSublinear << " instances (efficiency below "
+                      << juce::roundToInt (100.0 * linearThreshold) << "%)" << std::endl;
+        else
+            std::cout << "Scaling stayed linear up to " << maxInstances << " instances" << std::endl;
+        
+        if (args.containsOption ("--csv"))
+        {
+            const auto csvFile = juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--csv").unquoted());
+            juce::String csv ("instances,threads,realtimeFactor,microsPerBlock,bytesPerInstance,lateCycles\n");
+            
+            for (const auto& result : results)
+                csv << result.numInstances << "," << result.numThreads << "," << result.realtimeFactor << ","
+                    << result.microsPerBlock << "," << result.bytesPerInstance << "," << result.numLateCycles << "\n";
+            
+            if (! csvFile.replaceWithText (csv))
+                juce::ConsoleApplication::fail ("Could not write " + csvFile.getFullPathName());
+        }
+    }
+}
+
+juce::ConsoleApplication::Command createScaleCommand()
+{
+    return { "scale",
+             "scale [--max N] [--threads N] [--block N] [--rate Hz] [--seconds S] [--seed N] [--linear-threshold X] [--csv <file>]",
+             "Measures how throughput, per-block cost and memory grow with the number of instances",
+             "Runs 1, 2, 4 ... up to --max (128) plugin instances in one process, each playing its own random "
+             "patch and chords, with their blocks shared out over host-like audio threads cycle by cycle. "
+             "For each count it reports the aggregate realtime factor, the average cost of one processBlock, "
+             "that cost relative to a single instance, the efficiency against perfect scaling over the "
+             "available threads, resident memory per instance and the cycles that missed their deadline. "
+             "The first count whose efficiency falls below --linear-threshold (0.8) is where scaling stops "
+             "being linear. The instances don't open the preset bank, update the similarity index or publish "
+             "telemetry, so none of that background work lands in the timings.",
+             runScale };
+}
@@ -0,0 +1,152 @@
+/*
+  ==============================================================================
+
+    StandInCommand.cpp
+    Created: 19 Oct 2026 6:12:44am
+
+  ==============================================================================
+*/
+
+#include "ToolCommands.h"
+#include "ToolHelpers.h"
+
+namespace
+{
+    constexpr int requestTimeoutMs { 10000 };
+    constexpr int maxRequestHeadSize { 65536 };
+    
+    struct Recording
+    {
+        juce::File file;
+        int statusCode;
+        juce::String contentType;
+    };
+    
+    // "429-busy.json" answers with that status, anything else with 200. .sse files go out as an event stream
+    Recording makeRecording (const juce::File& file)
+    {
+        const auto prefix = file.getFileName().upToFirstOccurrenceOf ("-", false, false);
+        const auto statusCode = prefix.length() == 3 && prefix.containsOnly ("0123456789") ? prefix.getIntValue() : 200;
+        
+        return { file, statusCode, file.hasFileExtension ("sse") ? "text/event-stream" : "application/json" };
+    }
+    
+    // Takes the whole request, body included, so the client has finished sending before the answer starts
+    bool readRequest (juce::StreamingSocket& socket, juce::String& requestLine)
+    {
+        juce::MemoryOutputStream head;
+        
+        for (;;)
+        {
+            char c = 0;
+            
+            if (socket.waitUntilReady (true, requestTimeoutMs) != 1 || socket.read (&c, 1, true) != 1)
+                return false;
+            
+            head.writeByte (c);
+            const auto size = head.getDataSize();
+            
+            if (size >= 4 && std::memcmp (static_cast<const char*> (head.getData()) + size - 4, "\r\n\r\n", 4) == 0)
+                break;
+            
+            if (size > (size_t) maxRequestHeadSize)
+                return false;
+        }
+        
+        const auto lines = juce::StringArray::fromLines (head.toString());
+        int contentLength = 0;
+        requestLine = lines[0];
+        
+        for (const auto& line : lines)
+            if (line.startsWithIgnoreCase ("Content-Length:"))
+                contentLength = line.fromFirstOccurrenceOf (":", false, false).trim().getIntValue();
+        
+        juce::HeapBlock<char> body ((size_t) juce::jmax (1, contentLength));
+        return contentLength <= 0 || socket.read (body, contentLength, true) == contentLength;
+    }
+    
+    // No length up front: the client reads until the connection closes, one piece at a time as they come
+    void serve (juce::StreamingSocket& socket, const Recording& recording, const int chunkSize, const int chunkDelayMs)
+    {
+        juce::MemoryBlock body;
+        recording.file.loadFileAsData (body);
+        
+        juce::String head;
+        head << "HTTP/1.1 " << recording.statusCode << (recording.statusCode == 200 ? " OK" : " Recorded") << "\r\n"
+             << "Content-Type: " << recording.contentType << "\r\n"
+             << "Connection: close\r\n\r\n";
+        
+        if (socket.write (head.toRawUTF8(), (int) head.getNumBytesAsUTF8()) < 0)
+            return;
+        
+        for (size_t offset = 0; offset < body.getSize(); offset += (size_t) chunkSize)
+        {
+            if (offset > 0)
+                juce::Thread::sleep (chunkDelayMs);
+            
+            const auto numBytes = (int) juce::jmin ((size_t) chunkSize, body.getSize() - offset);
+            
+            if (socket.write (static_cast<const char*> (body.getData()) + offset, numBytes) != numBytes)
+                return;
+        }
+    }
+    
+    void runStandIn (const juce::ArgumentList& args)
+    {
+        if (! args.containsOption ("--responses"))
+            juce::ConsoleApplication::fail ("Missing --responses <folder>");
+        
+        const auto folder = juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--responses").unquoted());
+        const auto port = ToolHelpers::getIntOption (args, "--port", 8089);
+        const auto chunkSize = juce::jmax (1, ToolHelpers::getIntOption (args, "--chunk", 64));
+        const auto chunkDelayMs = juce::jmax (0, ToolHelpers::getIntOption (args, "--delay", 50));
+        const auto shouldLoop = args.containsOption ("--loop");
+        
+        auto files = folder.findChildFiles (juce::File::findFiles, false, "*.sse;*.json");
+        std::sort (files.begin(), files.end(), [] (const juce::File& a, const juce::File& b) { return a.getFileName() < b.getFileName(); });
+        
+        std::vector<Recording> recordings;
+        
+        for (const auto& file : files)
+            recordings.push_back (makeRecording (file));
+        
+        if (recordings.empty())
+            juce::ConsoleApplication::fail ("No .sse or .json responses in " + folder.getFullPathName());
+        
+        juce::StreamingSocket listener;
+        
+        if (! listener.createListener (port, "127.0.0.1"))
+            juce::ConsoleApplication::fail ("Could not listen on port " + juce::String (port));
+        
+        std::cout << "Serving " << recordings.size() << " recorded responses; run the plugin with" << std::endl
+                  << "  TAPSYNTH_API_BASE_URL=http://127.0.0.1:" << port << std::endl;
+        
+        for (size_t next = 0; next < recordings.size() || shouldLoop;)
+        {
+            std::unique_ptr<juce::StreamingSocket> client (listener.waitForNextConnection());
+            juce::String requestLine;
+            
+            if (client == nullptr || ! readRequest (*client, requestLine))
+                continue;
+            
+            const auto& recording = recordings[next++ % recordings.size()];
+            std::cout << requestLine << " -> " << recording.file.getFileName() << " (" << recording.statusCode << ")" << std::endl;
+            serve (*client, recording, chunkSize, chunkDelayMs);
+        }
+    }
+}
+
+juce::ConsoleApplication::Command createStandInCommand()
+{
+    return { "stand-in",
+             "stand-in --responses <folder> [--port N] [--chunk bytes] [--delay ms] [--loop]",
+             "Serves recorded model responses on localhost, in pieces, in place of the real API",
+             "Answers each request on 127.0.0.1 with the next file from --responses, in file name order, "
+             "then stops once every file has been served, or starts over with --loop. Files ending .sse are "
+             "sent as an event stream, as a recorded streamGenerateContent?alt=sse answer; .json files as a "
+             "plain generateContent answer. A name starting with a status code, such as 429-busy.json or "
+             "503-down.json, is answered with that status. Each answer is written --chunk bytes at a time, "
+             "--delay ms apart, so streamed answers arrive as they would from the network. Point the plugin "
+             "at it by setting TAPSYNTH_API_BASE_URL to the address it prints.",
+             runStandIn };
+}
@@ -0,0 +1,316 @@
+/*
+  ==============================================================================
+
+    StressCommand.cpp
+    Created: 19 Oct 2026 1:48:52am
+
+  ==============================================================================
+*/
+
+#include "ToolCommands.h"
+#include "ToolHelpers.h"
+
+namespace
+{
+    // What was thrown at one block. Everything here comes from the seeded generator,
+    // so the same seed replays the same blocks with the same events.
+    struct BlockRecord
+    {
+        int index { 0 };
+        int numSamples { 0 };
+        int numNoteOns { 0 };
+        int numNoteOffs { 0 };
+        int numParameterChanges { 0 };
+        bool oscillatorSwitch { false };
+        bool filterSwitch { false };
+        bool storm { false };
+        bool chord { false };
+        double micros { 0.0 };
+        
+        // Render time over the time the block's audio lasts
+        double getLoad (const double sampleRate) const { return micros * 1.0e-6 * sampleRate / numSamples; }
+        
+        juce::String describe() const
+        {
+            juce::StringArray events;
+            
+            if (storm)
+                events.add ("note storm of " + juce::String (numNoteOns) + " note-ons");
+            else if (chord)
+                events.add ("chord of " + juce::String (numNoteOns) + " notes");
+            else if (numNoteOns > 0)
+                events.add (juce::String (numNoteOns) + " note-ons");
+            
+            if (numNoteOffs > 0)
+                events.add (juce::String (numNoteOffs) + " note-offs");
+            
+            if (oscillatorSwitch)
+                events.add ("OSC1 switch");
+            
+            if (filterSwitch)
+                events.add ("FILTERTYPE switch");
+            
+            const auto numOtherChanges = numParameterChanges - (oscillatorSwitch ? 1 : 0) - (filterSwitch ? 1 : 0);
+            
+            if (numOtherChanges > 0)
+                events.add (juce::String (numOtherChanges) + " other parameter changes");
+            
+            return events.isEmpty() ? juce::String ("no events") : events.joinIntoString (", ");
+        }
+    };
+    
+    // Makes up each block's size, MIDI and automation from one seeded generator
+    class StressGenerator
+    {
+    public:
+        StressGenerator (TapSynthAudioProcessor& p, const juce::int64 seed, const int maxBlock)
+        : processor (p), random (seed), maximumBlockSize (maxBlock)
+        {
+            for (const auto& range : ToolHelpers::getParameterRanges())
+                if (auto* param = processor.apvts.getParameter (range.paramId))
+                    parameters.push_back (param);
+            
+            oscillator = processor.apvts.getParameter ("OSC1");
+            filterType = processor.apvts.getParameter ("FILTERTYPE");
+        }
+        
+        void nextBlock (BlockRecord& record, juce::MidiBuffer& midi)
+        {
+            midi.clear();
+            
+            // Half the time a size hosts really use, otherwise anything up to the maximum
+            static constexpr int hostSizes[] { 32, 64, 128, 256, 512, 1024, 2048 };
+            const auto hostSize = hostSizes[random.nextInt ((int) std::size (hostSizes))];
+            record.numSamples = random.nextBool() && hostSize <= maximumBlockSize ? hostSize : 1 + random.nextInt (maximumBlockSize);
+            
+            if (switchBurstBlocks == 0 && random.nextInt (100) == 0)
+                switchBurstBlocks = 8 + random.nextInt (56);
+            
+            // A burst flips the oscillator and filter type every block
+            const auto inBurst = switchBurstBlocks > 0;
+            
+            if (inBurst)
+                --switchBurstBlocks;
+            
+            if (inBurst || random.nextInt (10) == 0)
+                record.oscillatorSwitch = switchChoice (oscillator, record);
+            
+            if (inBurst || random.nextInt (10) == 0)
+                record.filterSwitch = switchChoice (filterType, record);
+            
+            // As a host's automation does: through the listeners, into the values the render reads
+            if (random.nextInt (3) == 0)
+            {
+                for (int i = 1 + random.nextInt (6); --i >= 0;)
+                {
+                    parameters[(size_t) random.nextInt ((int) parameters.size())]->setValueNotifyingHost (random.nextFloat());
+                    ++record.numParameterChanges;
+                }
+            }
+            
+            const auto roll = random.nextInt (100);
+            
+            if (roll < 2)
+            {
+                // Far beyond the polyphony, so most of these steal a voice
+                record.storm = true;
+                
+                for (int i = 16 + random.nextInt (48); --i >= 0;)
+                    addNoteOn (midi, record);
+            }
+            else if (roll < 10)
+            {
+                record.chord = true;
+                
+                for (int i = 6 + random.nextInt (5); --i >= 0;)
+                    addNoteOn (midi, record);
+            }
+            else if (roll < 30)
+            {
+                addNoteOn (midi, record);
+            }
+            
+            if (random.nextInt (6) == 0)
+            {
+                for (int note = 0; note < 128; ++note)
+                {
+                    if (heldNotes[(size_t) note] && random.nextBool())
+                    {
+                        midi.addEvent (juce::MidiMessage::noteOff (1, note), random.nextInt (record.numSamples));
+                        heldNotes[(size_t) note] = false;
+                        ++record.numNoteOffs;
+                    }
+                }
+            }
+        }
+        
+    private:
+        bool switchChoice (juce::RangedAudioParameter* param, BlockRecord& record)
+        {
+            if (param == nullptr)
+                return false;
+            
+            const auto numChoices = param->getNumSteps();
+            const auto current = juce::roundToInt (param->getValue() * (numChoices - 1));
+            const auto next = (current + 1 + random.nextInt (numChoices - 1)) % numChoices;
+            param->setValueNotifyingHost ((float) next / (float) (numChoices - 1));
+            ++record.numParameterChanges;
+            return true;
+        }
+        
+        void addNoteOn (juce::MidiBuffer& midi, BlockRecord& record)
+        {
+            const auto note = 24 + random.nextInt (84);
+            midi.addEvent (juce::MidiMessage::noteOn (1, note, 0.2f + 0.8f * random.nextFloat()), random.nextInt (record.numSamples));
+            heldNotes[(size_t) note] = true;
+            ++record.numNoteOns;
+        }
+        
+        TapSynthAudioProcessor& processor;
+        juce::Random random;
+        const int maximumBlockSize;
+        std::vector<juce::RangedAudioParameter*> parameters;
+        juce::RangedAudioParameter* oscillator { nullptr };
+        juce::RangedAudioParameter* filterType { nullptr };
+        std::array<bool, 128> heldNotes {};
+        int switchBurstBlocks { 0 };
+    };
+    
+    double getPercentile (const std::vector<double>& sorted, const double fraction)
+    {
+        if (sorted.empty())
+            return 0.0;
+        
+        return sorted[(size_t) juce::jlimit (0, (int) sorted.size() - 1, (int) std::ceil (fraction * (double) sorted.size()) - 1)];
+    }
+    
+    void runStress (const juce::ArgumentList& args)
+    {
+        const auto seed = (juce::int64) ToolHelpers::getIntOption (args, "--seed", 1);
+        const auto numBlocks = juce::jmax (1, ToolHelpers::getIntOption (args, "--blocks", 100000));
+        const auto sampleRate = ToolHelpers::getDoubleOption (args, "--rate", 44100.0);
+        const auto maxBlock = juce::jmax (1, ToolHelpers::getIntOption (args, "--max-block", 1024));
+        const auto numOutliers = juce::jmax (0, ToolHelpers::getIntOption (args, "--outliers", 20));
+        
+        // The patch comes from the seed too
+        juce::Random patchRandom (seed);
+        auto instance = TapSynthAudioProcessor::createHeadlessInstance (ToolHelpers::sampleRandomParams (patchRandom));
+        
+        if (instance == nullptr)
+            juce::ConsoleApplication::fail ("Could not create a plugin instance");
+        
+        instance->setRateAndBufferSizeDetails (sampleRate, maxBlock);
+        instance->prepareToPlay (sampleRate, maxBlock);
+        
+        StressGenerator generator (*instance, seed, maxBlock);
+        juce::AudioBuffer<float> buffer (juce::jmax (1, instance->getTotalNumOutputChannels()), maxBlock);
+        juce::MidiBuffer midi;
+        midi.ensureSize (2048);
+        
+        std::vector<BlockRecord> records ((size_t) numBlocks);
+        juce::ScopedNoDenormals noDenormals;
+        
+        std::cout << "Stressing seed " << seed << " for " << numBlocks << " blocks of up to " << maxBlock
+                  << " samples at " << sampleRate << " Hz" << std::endl;
+        
+        for (int index = 0; index < numBlocks; ++index)
+        {
+            auto& record = records[(size_t) index];
+            record.index = index;
+            generator.nextBlock (record, midi);
+            
+            buffer.setSize (buffer.getNumChannels(), record.numSamples, false, false, true);
+            buffer.clear();
+            
+            const auto start = juce::Time::getHighResolutionTicks();
+            instance->processBlock (buffer, midi);
+            record.micros = 1.0e6 * juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+            
+            if (index % 1000 == 0)
+                std::cout << "\r" << index << " / " << numBlocks << " blocks" << std::flush;
+        }
+        
+        std::cout << "\r" << numBlocks << " / " << numBlocks << " blocks" << std::endl << std::endl;
+        
+        std::vector<double> micros, loads;
+        
+        for (const auto& record : records)
+        {
+            micros.push_back (record.micros);
+            loads.push_back (record.getLoad (sampleRate));
+        }
+        
+        std::sort (micros.begin(), micros.end());
+        std::sort (loads.begin(), loads.end());
+        
+        std::cout << juce::String ("").paddedRight (' ', 8)
+                  << juce::String ("p50").paddedLeft (' ', 10) << juce::String ("p99").paddedLeft (' ', 10)
+                  << juce::String ("p99.9").paddedLeft (' ', 10) << juce::String ("max").paddedLeft (' ', 10) << std::endl;
+        
+        const auto printRow = [] (const juce::String& name, const std::vector<double>& sorted, const int decimals)
+        {
+            std::cout << name.paddedRight (' ', 8);
+            
+            for (const auto fraction : { 0.5, 0.99, 0.999, 1.0 })
+                std::cout << juce::String (getPercentile (sorted, fraction), decimals).paddedLeft (' ', 10);
+            
+            std::cout << std::endl;
+        };
+        
+        printRow ("us", micros, 1);
+        printRow ("load", loads, 3);
+        
+        const auto numOverruns = std::count_if (loads.begin(), loads.end(), [] (const double load) { return load > 1.0; });
+        std::cout << std::endl << numOverruns << " blocks took longer than the audio they rendered" << std::endl;
+        
+        // Load rather than raw time, so a short block that pays for a whole quantum shows up
+        std::sort (records.begin(), records.end(), [sampleRate] (const BlockRecord& a, const BlockRecord& b)
+        {
+            return a.getLoad (sampleRate) > b.getLoad (sampleRate);
+        });
+        
+        if (numOutliers > 0)
+            std::cout << std::endl << "Worst " << juce::jmin (numOutliers, numBlocks) << " blocks (replay with --seed " << seed << "):" << std::endl;
+        
+        for (int i = 0; i < juce::jmin (numOutliers, numBlocks); ++i)
+        {
+            const auto& record = records[(size_t) i];
+            std::cout << "  block " << juce::String (record.index).paddedLeft (' ', 8)
+                      << juce::String (record.numSamples).paddedLeft (' ', 6) << " samples"
+                      << juce::String (record.micros, 1).paddedLeft (' ', 10) << " us"
+                      << juce::String (record.getLoad (sampleRate), 3).paddedLeft (' ', 8) << " load   "
+                      << record.describe() << std::endl;
+        }
+        
+        if (args.containsOption ("--csv"))
+        {
+            std::sort (records.begin(), records.end(), [] (const BlockRecord& a, const BlockRecord& b) { return a.index < b.index; });
+            
+            const auto csvFile = juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--csv").unquoted());
+            juce::String csv ("block,samples,micros,noteOns,noteOffs,parameterChanges,oscillatorSwitch,filterSwitch,storm,chord\n");
+            
+            for (const auto& record : records)
+                csv << record.index << "," << record.numSamples << "," << record.micros << ","
+                    << record.numNoteOns << "," << record.numNoteOffs << "," << record.numParameterChanges << ","
+                    << (int) record.oscillatorSwitch << "," << (int) record.filterSwitch << ","
+                    << (int) record.storm << "," << (int) record.chord << "\n";
+            
+            if (! csvFile.replaceWithText (csv))
+                juce::ConsoleApplication::fail ("Could not write " + csvFile.getFullPathName());
+        }
+    }
+}
+
+juce::ConsoleApplication::Command createStressCommand()
+{
+    return { "stress",
+             "stress [--seed N] [--blocks N] [--rate Hz] [--max-block N] [--outliers N] [--csv <file>]",
+             "Renders a seeded storm of automation and MIDI and reports the worst-case block times",
+             "Plays one headless instance with a random patch through --blocks (100000) blocks of random "
+             "sizes up to --max-block, with random parameter automation, bursts of OSC1 and FILTERTYPE "
+             "switching every block, dense chords and note-on storms well past the polyphony. Prints the "
+             "p50, p99, p99.9 and max of the per-block render time and load, then the --outliers (20) worst "
+             "blocks with what happened in each. The patch, block sizes and events all come from --seed, so "
+             "a spike can be reproduced by running the same seed again.",
+             runStress };
+}
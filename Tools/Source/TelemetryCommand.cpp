@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    TelemetryCommand.cpp
+    Created: 19 Oct 2026 3:05:12am
+
+  ==============================================================================
+*/
+
+#include "ToolCommands.h"
+#include "ToolHelpers.h"
+#include "../../Source/Data/TelemetrySegment.h"
+
+namespace
+{
+    void printInstances (const Telemetry::Segment& segment)
+    {
+        const auto now = juce::Time::currentTimeMillis();
+        int numListed = 0;
+        
+        std::cout << juce::String ("pid").paddedLeft (' ', 8)
+                  << juce::String ("id").paddedLeft (' ', 5)
+                  << juce::String ("age ms").paddedLeft (' ', 9)
+                  << juce::String ("load").paddedLeft (' ', 8)
+                  << juce::String ("voices").paddedLeft (' ', 8)
+                  << juce::String ("overruns").paddedLeft (' ', 10)
+                  << juce::String ("tier").paddedLeft (' ', 6)
+                  << juce::String ("rms dB").paddedLeft (' ', 9)
+                  << juce::String ("peak dB").paddedLeft (' ', 9)
+                  << juce::String ("rate").paddedLeft (' ', 8)
+                  << juce::String ("block").paddedLeft (' ', 7)
+                  << juce::String ("blocks").paddedLeft (' ', 12) << std::endl;
+        
+        for (const auto& slot : segment.slots)
+        {
+            const auto owner = slot.owner.load();
+            
+            if (! Telemetry::isOwnerAlive (owner))
+                continue;
+            
+            Telemetry::Stats stats;
+            
+            if (! slot.read (stats))
+                continue;
+            
+            // Never written means the instance hasn't processed a block yet
+            const auto age = stats.updateTime > 0 ? juce::String (now - stats.updateTime) : juce::String ("-");
+            
+            std::cout << juce::String (Telemetry::getOwnerProcessId (owner)).paddedLeft (' ', 8)
+                      << juce::String ((int) slot.instanceId.load()).paddedLeft (' ', 5)
+                      << age.paddedLeft (' ', 9)
+                      << juce::String (stats.load, 3).paddedLeft (' ', 8)
+                      << juce::String (stats.activeVoices).paddedLeft (' ', 8)
+                      << juce::String (stats.numOverruns).paddedLeft (' ', 10)
+                      << juce::String (stats.qualityTier).paddedLeft (' ', 6)
+                      << juce::String (juce::Decibels::gainToDecibels (stats.rms), 1).paddedLeft (' ', 9)
+                      << juce::String (juce::Decibels::gainToDecibels (stats.peak), 1).paddedLeft (' ', 9)
+                      << juce::String (juce::roundToInt (stats.sampleRate)).paddedLeft (' ', 8)
+                      << juce::String (stats.blockSize).paddedLeft (' ', 7)
+                      << juce::String (stats.numBlocks).paddedLeft (' ', 12) << std::endl;
+            
+            ++numListed;
+        }
+        
+        if (numListed == 0)
+            std::cout << "No live instances" << std::endl;
+    }
+    
+    void runTelemetry (const juce::ArgumentList& args)
+    {
+        const Telemetry::Mapping mapping (false);
+        
+        if (mapping.getSegment() == nullptr)
+            juce::ConsoleApplication::fail ("No telemetry segment: no instance has run since boot, or this platform has no POSIX shared memory");
+        
+        const auto watchInterval = ToolHelpers::getIntOption (args, "--watch", 0);
+        
+        for (;;)
+        {
+            printInstances (*mapping.getSegment());
+            
+            if (watchInterval <= 0)
+                return;
+            
+            juce::Thread::sleep (watchInterval);
+            std::cout << std::endl;
+        }
+    }
+}
+
+juce::ConsoleApplication::Command createTelemetryCommand()
+{
+    return { "telemetry",
+             "telemetry [--watch <ms>]",
+             "Lists every live plugin instance on this machine with its load, voices, overruns and levels",
+             "Reads the shared-memory segment that plugin instances publish their stats into after every "
+             "block. Instances whose process has gone are skipped. With --watch the listing repeats at that "
+             "interval until interrupted.",
+             runTelemetry };
+}
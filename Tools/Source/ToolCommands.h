@@ -0,0 +1,22 @@
+/*
+  ==============================================================================
+
+    ToolCommands.h
+    Created: 18 Oct 2026 8:55:02pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Each subcommand of tapSynthTools lives in its own file and registers through one of these
+juce::ConsoleApplication::Command createDatasetCommand();
+juce::ConsoleApplication::Command createMatchCommand();
+juce::ConsoleApplication::Command createScaleCommand();
+juce::ConsoleApplication::Command createStressCommand();
+juce::ConsoleApplication::Command createTelemetryCommand();
+juce::ConsoleApplication::Command createReplayCommand();
+juce::ConsoleApplication::Command createOnsetCommand();
+juce::ConsoleApplication::Command createStandInCommand();
@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    ToolHelpers.cpp
+    Created: 18 Oct 2026 8:55:02pm
+
+  ==============================================================================
+*/
+
+#include "ToolHelpers.h"
+
+namespace ToolHelpers
+{
+    const std::vector<ParameterRange>& getParameterRanges()
+    {
+        static const std::vector<ParameterRange> ranges = []
+        {
+            std::vector<ParameterRange> result;
+            TapSynthAudioProcessor prototype (true);
+            
+            for (const auto* paramId : PatchData::parameterIds)
+                if (auto* param = prototype.apvts.getParameter (paramId))
+                    result.push_back ({ paramId, param->getNormalisableRange() });
+            
+            return result;
+        }();
+        
+        return ranges;
+    }
+    
+    const std::vector<AuditionPhrase>& getDatasetPhrases()
+    {
+        static const std::vector<AuditionPhrase> phrases
+        {
+            { "note", 2.0, { { 60, 0.8f, 0.0, 1.0 } } },
+            { "chord", 2.5, { { 48, 0.8f, 0.0, 1.5 }, { 55, 0.8f, 0.0, 1.5 }, { 64, 0.8f, 0.0, 1.5 } } },
+            { "arpeggio", 2.5, { { 48, 0.9f, 0.0, 0.2 }, { 55, 0.7f, 0.25, 0.2 }, { 60, 0.8f, 0.5, 0.2 },
+                                 { 64, 0.7f, 0.75, 0.2 }, { 67, 0.8f, 1.0, 0.2 }, { 72, 0.9f, 1.25, 0.5 } } }
+        };
+        
+        return phrases;
+    }
+    
+    juce::var sampleRandomParams (juce::Random& random)
+    {
+        std::vector<float> normalised (getParameterRanges().size());
+        
+        for (auto& value : normalised)
+            value = random.nextFloat();
+        
+        return denormaliseParams (normalised);
+    }
+    
+    juce::var denormaliseParams (const std::vector<float>& normalised)
+    {
+        const auto& ranges = getParameterRanges();
+        jassert (normalised.size() == ranges.size());
+        
+        auto* obj = new juce::DynamicObject();
+        juce::var params (obj);
+        
+        for (size_t i = 0; i < ranges.size(); ++i)
+        {
+            const auto& range = ranges[i].range;
+            obj->setProperty (ranges[i].paramId, range.snapToLegalValue (range.convertFrom0to1 (juce::jlimit (0.0f, 1.0f, normalised[i]))));
+        }
+        
+        return params;
+    }
+    
+    bool writeWav (const juce::File& file, const juce::AudioBuffer<float>& audio, const double sampleRate)
+    {
+        file.deleteFile();
+        std::unique_ptr<juce::OutputStream> stream = file.createOutputStream();
+        
+        if (stream == nullptr)
+            return false;
+        
+        juce::WavAudioFormat format;
+        std::unique_ptr<juce::AudioFormatWriter> writer (format.createWriterFor (stream.get(), sampleRate, (unsigned int) audio.getNumChannels(), 32, {}, 0));
+        
+        if (writer == nullptr)
+            return false;
+        
+        stream.release(); // the writer owns it now
+        return writer->writeFromAudioSampleBuffer (audio, 0, audio.getNumSamples());
+    }
+    
+    bool readAudioFile (const juce::File& file, juce::AudioBuffer<float>& audio, double& sampleRate)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+        
+        std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (file));
+        
+        if (reader == nullptr || reader->lengthInSamples <= 0)
+            return false;
+        
+        audio.setSize ((int) reader->numChannels, (int) reader->lengthInSamples);
+        sampleRate = reader->sampleRate;
+        return reader->read (&audio, 0, audio.getNumSamples(), 0, true, true);
+    }
+    
+    int getIntOption (const juce::ArgumentList& args, const juce::String& option, const int defaultValue)
+    {
+        return args.containsOption (option) ? args.getValueForOption (option).getIntValue() : defaultValue;
+    }
+    
+    double getDoubleOption (const juce::ArgumentList& args, const juce::String& option, const double defaultValue)
+    {
+        return args.containsOption (option) ? args.getValueForOption (option).getDoubleValue() : defaultValue;
+    }
+    
+    juce::String getStringOption (const juce::ArgumentList& args, const juce::String& option, const juce::String& defaultValue)
+    {
+        return args.containsOption (option) ? args.getValueForOption (option) : defaultValue;
+    }
+    
+    int getDefaultNumThreads()
+    {
+        return juce::jmax (1, juce::SystemStats::getNumCpus());
+    }
+}
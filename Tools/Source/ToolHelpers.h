@@ -0,0 +1,43 @@
+/*
+  ==============================================================================
+
+    ToolHelpers.h
+    Created: 18 Oct 2026 8:55:02pm
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+namespace ToolHelpers
+{
+    struct ParameterRange
+    {
+        juce::String paramId;
+        juce::NormalisableRange<float> range;
+    };
+
+    // The createParams ranges, in PatchData order
+    const std::vector<ParameterRange>& getParameterRanges();
+
+    // Single note, chord and arpeggio, the phrases datasets are rendered and matched with
+    const std::vector<AuditionPhrase>& getDatasetPhrases();
+
+    // Uniform in each parameter's normalised (skewed) range, snapped like the parameter would
+    juce::var sampleRandomParams (juce::Random& random);
+
+    // One value in [0, 1] per parameter range, mapped and snapped to the parameter's own units
+    juce::var denormaliseParams (const std::vector<float>& normalised);
+
+    bool writeWav (const juce::File& file, const juce::AudioBuffer<float>& audio, const double sampleRate);
+    bool readAudioFile (const juce::File& file, juce::AudioBuffer<float>& audio, double& sampleRate);
+
+    int getIntOption (const juce::ArgumentList& args, const juce::String& option, const int defaultValue);
+    double getDoubleOption (const juce::ArgumentList& args, const juce::String& option, const double defaultValue);
+    juce::String getStringOption (const juce::ArgumentList& args, const juce::String& option, const juce::String& defaultValue);
+
+    int getDefaultNumThreads();
+}